@@ -51,6 +51,73 @@ using namespace dcpomatic;
 
 static auto constexpr num_points = 1024;
 
+/* We may struggle to serialise and recover inf or -inf, so we never let a sample's
+ * absolute value go below this (140dB down).
+ */
+static float constexpr minimum_sample = 10e-7;
+
+
+namespace {
+
+struct Block
+{
+	double sum_of_squares = 0;
+	float peak = 0;
+};
+
+}
+
+
+/** @return sum of squares and peak of the absolute values of some samples, each clamped to
+ *  be at least minimum_sample.  Written with several independent accumulators so that the
+ *  compiler can vectorise it.
+ */
+static Block
+reduce_block(float const* data, int frames)
+{
+	int constexpr lanes = 8;
+
+	double sum[lanes] = { 0 };
+	float peak[lanes] = { 0 };
+
+	int i = 0;
+	for (; i <= frames - lanes; i += lanes) {
+		for (int k = 0; k < lanes; ++k) {
+			float const s = std::max(fabsf(data[i + k]), minimum_sample);
+			sum[k] += static_cast<double>(s) * s;
+			peak[k] = std::max(peak[k], s);
+		}
+	}
+
+	for (; i < frames; ++i) {
+		float const s = std::max(fabsf(data[i]), minimum_sample);
+		sum[0] += static_cast<double>(s) * s;
+		peak[0] = std::max(peak[0], s);
+	}
+
+	Block block;
+	for (int k = 0; k < lanes; ++k) {
+		block.sum_of_squares += sum[k];
+		block.peak = std::max(block.peak, peak[k]);
+	}
+	return block;
+}
+
+
+/** @return index of the first sample whose (clamped) absolute value is at least threshold */
+static int
+first_at_or_above(float const* data, int frames, float threshold)
+{
+	for (int i = 0; i < frames; ++i) {
+		if (std::max(fabsf(data[i]), minimum_sample) >= threshold) {
+			return i;
+		}
+	}
+
+	DCPOMATIC_ASSERT(false);
+	return 0;
+}
+
 
 AudioAnalyser::AudioAnalyser(shared_ptr<const Film> film, shared_ptr<const Playlist> playlist, bool whole_film, std::function<void (float)> set_progress)
 	: _film (film)
@@ -150,38 +217,46 @@ AudioAnalyser::analyse (shared_ptr<AudioBuffers> b, DCPTime time)
 #endif
 
 	int const frames = b->frames ();
-	vector<double> interleaved(frames * _leqm_channels);
+	/* Re-use the same buffer each time; resize() won't reallocate once it is big enough */
+	_interleaved.resize(frames * _leqm_channels);
 
 	for (int j = 0; j < _leqm_channels; ++j) {
 		float const* data = b->data(j);
-		for (int i = 0; i < frames; ++i) {
-			float s = data[i];
-
-			interleaved[i * _leqm_channels + j] = s;
 
-			float as = fabsf (s);
-			if (as < 10e-7) {
-				/* We may struggle to serialise and recover inf or -inf, so prevent such
-				   values by replacing with this (140dB down) */
-				s = as = 10e-7;
-			}
-			_current[j][AudioPoint::RMS] += pow (s, 2);
-			_current[j][AudioPoint::PEAK] = max (_current[j][AudioPoint::PEAK], as);
+		auto out = _interleaved.data() + j;
+		for (int i = 0; i < frames; ++i) {
+			*out = data[i];
+			out += _leqm_channels;
+		}
 
-			if (as > _sample_peak[j]) {
-				_sample_peak[j] = as;
-				_sample_peak_frame[j] = _done + i;
+		/* Work through the data in blocks which end at the frames where we finish a point,
+		 * i.e. those whose index is a multiple of _samples_per_point.
+		 */
+		int i = 0;
+		while (i < frames) {
+			auto const next_point = ((_done + i + _samples_per_point - 1) / _samples_per_point) * _samples_per_point;
+			int const end = std::min(static_cast<Frame>(frames), next_point - _done + 1);
+
+			auto const block = reduce_block(data + i, end - i);
+			_current[j][AudioPoint::RMS] += block.sum_of_squares;
+			_current[j][AudioPoint::PEAK] = max(_current[j][AudioPoint::PEAK], block.peak);
+
+			if (block.peak > _sample_peak[j]) {
+				_sample_peak[j] = block.peak;
+				_sample_peak_frame[j] = _done + i + first_at_or_above(data + i, end - i, block.peak);
 			}
 
-			if (((_done + i) % _samples_per_point) == 0) {
+			if (_done + end - 1 == next_point) {
 				_current[j][AudioPoint::RMS] = sqrt (_current[j][AudioPoint::RMS] / _samples_per_point);
 				_analysis.add_point (j, _current[j]);
 				_current[j] = AudioPoint ();
 			}
+
+			i = end;
 		}
 	}
 
-	_leqm->add(interleaved);
+	_leqm->add(_interleaved);
 
 	_done += frames;
 
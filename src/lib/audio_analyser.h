@@ -75,6 +75,8 @@ private:
 	std::vector<float> _sample_peak;
 	std::vector<Frame> _sample_peak_frame;
 	std::vector<AudioPoint> _current;
+	/** Buffer for the interleaved samples that we give to _leqm */
+	std::vector<double> _interleaved;
 
 	AudioAnalysis _analysis;
 };
@@ -0,0 +1,142 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "audio_buffer_pool.h"
+#include "memory_util.h"
+#include <dcp/warnings.h>
+LIBDCP_DISABLE_WARNINGS
+extern "C" {
+#include <libavutil/mem.h>
+}
+LIBDCP_ENABLE_WARNINGS
+
+
+AudioBufferPool::~AudioBufferPool()
+{
+	clear();
+}
+
+
+/** @return a block of memory for the given number of samples, which should be given back with put() */
+float*
+AudioBufferPool::get(size_t samples)
+{
+	{
+		boost::mutex::scoped_lock lm(_mutex);
+		auto i = _index.find(samples);
+		if (i != _index.end()) {
+			auto data = i->second->second;
+			_idle.erase(i->second);
+			_index.erase(i);
+			_idle_size -= samples * sizeof(float);
+			++_hits;
+			return data;
+		}
+		++_misses;
+	}
+
+	return static_cast<float*>(wrapped_av_malloc(samples * sizeof(float)));
+}
+
+
+void
+AudioBufferPool::put(float* data, size_t samples)
+{
+	if (!data) {
+		return;
+	}
+
+	boost::mutex::scoped_lock lm(_mutex);
+
+	_idle.push_front(std::make_pair(samples, data));
+	_index.insert(std::make_pair(samples, _idle.begin()));
+	_idle_size += samples * sizeof(float);
+
+	evict();
+}
+
+
+/** Free least-recently-used blocks until we are within our size limit.
+ *  Must be called with a lock held on _mutex.
+ */
+void
+AudioBufferPool::evict()
+{
+	while (_idle_size > _maximum_size && !_idle.empty()) {
+		auto last = std::prev(_idle.end());
+		auto range = _index.equal_range(last->first);
+		for (auto i = range.first; i != range.second; ++i) {
+			if (i->second == last) {
+				_index.erase(i);
+				break;
+			}
+		}
+		_idle_size -= last->first * sizeof(float);
+		av_free(last->second);
+		_idle.erase(last);
+	}
+}
+
+
+void
+AudioBufferPool::clear()
+{
+	boost::mutex::scoped_lock lm(_mutex);
+
+	for (auto const& i: _idle) {
+		av_free(i.second);
+	}
+	_idle.clear();
+	_index.clear();
+	_idle_size = 0;
+}
+
+
+void
+AudioBufferPool::set_maximum_size(size_t bytes)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	_maximum_size = bytes;
+	evict();
+}
+
+
+AudioBufferPool::Statistics
+AudioBufferPool::statistics() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+
+	Statistics s;
+	s.idle = _idle_size;
+	s.hits = _hits;
+	s.misses = _misses;
+	return s;
+}
+
+
+AudioBufferPool*
+AudioBufferPool::instance()
+{
+	/* Never destroyed, as AudioBuffers may be destroyed by other static destructors
+	 * after this would have been.
+	 */
+	static auto pool = new AudioBufferPool();
+	return pool;
+}
@@ -0,0 +1,88 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DCPOMATIC_AUDIO_BUFFER_POOL_H
+#define DCPOMATIC_AUDIO_BUFFER_POOL_H
+
+
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <map>
+
+
+/** @class AudioBufferPool
+ *  @brief A pool of memory for AudioBuffers.
+ *
+ *  Each block of audio passing through the player, butler and encoders lives in a new AudioBuffers,
+ *  and for many-channel, high-sample-rate material the cost of allocating and freeing all those
+ *  buffers adds up.  AudioBuffers gets its (single, channel-planar) block of sample memory from
+ *  here and gives it back when it is destroyed or resized.
+ *
+ *  Blocks are keyed by their size in samples and the pool holds up to a maximum total size of
+ *  unused blocks, freeing the least-recently-used ones when it is full.
+ */
+class AudioBufferPool
+{
+public:
+	AudioBufferPool() = default;
+	~AudioBufferPool();
+
+	AudioBufferPool(AudioBufferPool const&) = delete;
+	AudioBufferPool& operator=(AudioBufferPool const&) = delete;
+
+	float* get(size_t samples);
+	void put(float* data, size_t samples);
+	void clear();
+
+	void set_maximum_size(size_t bytes);
+
+	struct Statistics
+	{
+		/** total size of the unused blocks in the pool, in bytes */
+		size_t idle = 0;
+		/** number of calls to get() which re-used a block */
+		int hits = 0;
+		/** number of calls to get() which had to allocate */
+		int misses = 0;
+	};
+
+	Statistics statistics() const;
+
+	static AudioBufferPool* instance();
+
+private:
+	void evict();
+
+	using List = std::list<std::pair<size_t, float*>>;
+
+	mutable boost::mutex _mutex;
+	/** unused blocks with the most recently used at the front */
+	List _idle;
+	/** index into _idle by size in samples */
+	std::multimap<size_t, List::iterator> _index;
+	/** total size of the blocks in _idle, in bytes */
+	size_t _idle_size = 0;
+	size_t _maximum_size = 64 * 1024 * 1024;
+	int _hits = 0;
+	int _misses = 0;
+};
+
+
+#endif
@@ -19,10 +19,13 @@
 */
 
 
+#include "audio_buffer_pool.h"
 #include "audio_buffers.h"
+#include "audio_mix.h"
 #include "dcpomatic_assert.h"
 #include "maths_util.h"
 #include <dcp/scope_guard.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <cmath>
@@ -32,10 +35,34 @@ using std::shared_ptr;
 using std::make_shared;
 
 
-/** Construct a silent AudioBuffers */
-AudioBuffers::AudioBuffers (int channels, int frames)
+/** Number of samples that the start of each channel is aligned to */
+static int const stride_alignment = 16;
+
+
+/** @return Number of samples to allocate for a given number of channels and frames.
+ *  This is rounded up to a power of two so that the pool only sees a few different sizes,
+ *  and so that buffers which grow a little at a time (with append()) don't need a new block
+ *  every time.
+ */
+static size_t
+block_size (int channels, int frames)
 {
-	allocate (channels, frames);
+	auto const needed = static_cast<size_t>(channels) * ((frames + stride_alignment - 1) / stride_alignment * stride_alignment);
+	size_t size = 1024;
+	while (size < needed) {
+		size *= 2;
+	}
+	return size;
+}
+
+
+/** Construct an AudioBuffers.
+ *  @param contents SILENT to fill the buffers with silence, UNDEFINED to leave them uninitialised
+ *  (which is quicker if the caller is about to write all the samples).
+ */
+AudioBuffers::AudioBuffers (int channels, int frames, Contents contents)
+{
+	allocate (channels, frames, contents);
 }
 
 
@@ -44,25 +71,31 @@ AudioBuffers::AudioBuffers (int channels, int frames)
  */
 AudioBuffers::AudioBuffers (AudioBuffers const & other)
 {
-	allocate (other.channels(), other.frames());
+	allocate (other.channels(), other.frames(), Contents::UNDEFINED);
 	copy_from (&other, other.frames(), 0, 0);
 }
 
 
 AudioBuffers::AudioBuffers (std::shared_ptr<const AudioBuffers> other)
 {
-	allocate (other->channels(), other->frames());
+	allocate (other->channels(), other->frames(), Contents::UNDEFINED);
 	copy_from (other.get(), other->frames(), 0, 0);
 }
 
 
 AudioBuffers::AudioBuffers (std::shared_ptr<const AudioBuffers> other, int frames_to_copy, int read_offset)
 {
-	allocate (other->channels(), frames_to_copy);
+	allocate (other->channels(), frames_to_copy, Contents::UNDEFINED);
 	copy_from (other.get(), frames_to_copy, read_offset, 0);
 }
 
 
+AudioBuffers::~AudioBuffers ()
+{
+	AudioBufferPool::instance()->put(_storage, _capacity);
+}
+
+
 AudioBuffers &
 AudioBuffers::operator= (AudioBuffers const & other)
 {
@@ -70,24 +103,53 @@ AudioBuffers::operator= (AudioBuffers const & other)
 		return *this;
 	}
 
-	allocate (other.channels(), other.frames());
+	allocate (other.channels(), other.frames(), Contents::UNDEFINED);
 	copy_from (&other, other.frames(), 0, 0);
 
 	return *this;
 }
 
 
+/** Set the size of these buffers, keeping any existing samples which fit in the new size.
+ *  @param contents What any new samples should contain.
+ */
 void
-AudioBuffers::allocate (int channels, int frames)
+AudioBuffers::allocate (int channels, int frames, Contents contents)
 {
 	DCPOMATIC_ASSERT (frames >= 0);
 	DCPOMATIC_ASSERT(frames == 0 || channels > 0);
 
 	dcp::ScopeGuard sg = [this]() { update_data_pointers(); };
 
-	_data.resize(channels);
-	for (int channel = 0; channel < channels; ++channel) {
-		_data[channel].resize(frames);
+	int const old_channels = _channels;
+	int const old_frames = _frames;
+
+	if (frames > _stride || static_cast<size_t>(channels) * _stride > _capacity) {
+		/* We need a new block, so copy what we are keeping into it */
+		auto const capacity = block_size(channels, frames);
+		auto storage = AudioBufferPool::instance()->get(capacity);
+		int const stride = capacity / channels / stride_alignment * stride_alignment;
+		int const keep = std::min(old_frames, frames);
+		for (int channel = 0; keep > 0 && channel < std::min(old_channels, channels); ++channel) {
+			memcpy (storage + channel * stride, _storage + channel * _stride, keep * sizeof(float));
+		}
+		AudioBufferPool::instance()->put(_storage, _capacity);
+		_storage = storage;
+		_capacity = capacity;
+		_stride = stride;
+	}
+
+	_channels = channels;
+	_frames = frames;
+
+	if (contents == Contents::SILENT) {
+		for (int channel = 0; channel < channels; ++channel) {
+			int const keep = channel < old_channels ? std::min(old_frames, frames) : 0;
+			if (frames > keep) {
+				/* See the comment in make_silent() about this */
+				memset (data(channel) + keep, 0, (frames - keep) * sizeof(float));
+			}
+		}
 	}
 }
 
@@ -99,7 +161,7 @@ float*
 AudioBuffers::data (int channel)
 {
 	DCPOMATIC_ASSERT (channel >= 0 && channel < channels());
-	return _data[channel].data();
+	return _storage + channel * _stride;
 }
 
 
@@ -110,7 +172,7 @@ float const*
 AudioBuffers::data (int channel) const
 {
 	DCPOMATIC_ASSERT (channel >= 0 && channel < channels());
-	return _data[channel].data();
+	return _storage + channel * _stride;
 }
 
 
@@ -118,7 +180,7 @@ AudioBuffers::data (int channel) const
 void
 AudioBuffers::set_frames (int frames)
 {
-	allocate(_data.size(), frames);
+	allocate(_channels, frames);
 }
 
 
@@ -223,16 +285,12 @@ AudioBuffers::move (int frames_to_move, int from, int to)
 void
 AudioBuffers::accumulate_channel (AudioBuffers const * from, int from_channel, int to_channel, float gain)
 {
-	int const N = frames ();
-	DCPOMATIC_ASSERT (from->frames() == N);
+	DCPOMATIC_ASSERT (from->frames() == frames());
 	DCPOMATIC_ASSERT (to_channel <= channels());
 
-	auto s = from->data (from_channel);
 	auto d = data(to_channel);
-
-	for (int i = 0; i < N; ++i) {
-		*d++ += (*s++) * gain;
-	}
+	dcpomatic::MixInput const inputs[] = { { d, 1 }, { from->data(from_channel), gain } };
+	dcpomatic::mix(inputs, 2, 0, d, frames());
 }
 
 
@@ -249,11 +307,10 @@ AudioBuffers::accumulate_frames (AudioBuffers const * from, int frames, int read
 	DCPOMATIC_ASSERT (read_offset >= 0);
 	DCPOMATIC_ASSERT (write_offset >= 0);
 
-	auto from_data = from->data ();
 	for (int i = 0; i < channels(); ++i) {
-		for (int j = 0; j < frames; ++j) {
-			_data[i][j + write_offset] += from_data[i][j + read_offset];
-		}
+		auto d = data(i) + write_offset;
+		dcpomatic::MixInput const inputs[] = { { d, 1 }, { from->data(i) + read_offset, 1 } };
+		dcpomatic::mix(inputs, 2, 0, d, frames);
 	}
 }
 
@@ -265,9 +322,7 @@ AudioBuffers::apply_gain (float dB)
 	auto const linear = db_to_linear (dB);
 
 	for (int i = 0; i < channels(); ++i) {
-		for (int j = 0; j < frames(); ++j) {
-			_data[i][j] *= linear;
-		}
+		dcpomatic::apply_gain(data(i), frames(), linear);
 	}
 }
 
@@ -276,7 +331,7 @@ AudioBuffers::apply_gain (float dB)
 shared_ptr<AudioBuffers>
 AudioBuffers::channel (int channel) const
 {
-	auto output = make_shared<AudioBuffers>(1, frames());
+	auto output = make_shared<AudioBuffers>(1, frames(), Contents::UNDEFINED);
 	output->copy_channel_from (this, channel, 0);
 	return output;
 }
@@ -295,11 +350,28 @@ AudioBuffers::copy_channel_from (AudioBuffers const * from, int from_channel, in
 }
 
 
+/** Copy all the samples from a channel on another AudioBuffers to a channel on this one,
+ *  applying a gain as we go.
+ *  @param from AudioBuffers to copy from.
+ *  @param from_channel Channel index in `from' to copy from.
+ *  @param to_channel Channel index in this to copy into, overwriting what's already there.
+ *  @param gain Linear gain to apply.
+ */
+void
+AudioBuffers::copy_channel_from (AudioBuffers const * from, int from_channel, int to_channel, float gain)
+{
+	DCPOMATIC_ASSERT (from->frames() == frames());
+
+	dcpomatic::MixInput const input = { from->data(from_channel), gain };
+	dcpomatic::mix(&input, 1, 0, data(to_channel), frames());
+}
+
+
 /** Make a copy of these AudioBuffers */
 shared_ptr<AudioBuffers>
 AudioBuffers::clone () const
 {
-	auto b = make_shared<AudioBuffers>(channels(), frames());
+	auto b = make_shared<AudioBuffers>(channels(), frames(), Contents::UNDEFINED);
 	b->copy_from (this, frames(), 0, 0);
 	return b;
 }
@@ -329,10 +401,10 @@ AudioBuffers::trim_start (int frames_to_trim)
 void
 AudioBuffers::update_data_pointers ()
 {
-        _data_pointers.resize (channels());
-        for (int i = 0; i < channels(); ++i) {
-                _data_pointers[i] = _data[i].data();
-        }
+	_data_pointers.resize (channels());
+	for (int i = 0; i < channels(); ++i) {
+		_data_pointers[i] = _storage + i * _stride;
+	}
 }
 
 
@@ -343,14 +415,6 @@ void
 AudioBuffers::set_channels(int new_channels)
 {
 	DCPOMATIC_ASSERT(new_channels > 0);
-
-	dcp::ScopeGuard sg = [this]() { update_data_pointers(); };
-
-	int const old_channels = channels();
-	_data.resize(new_channels);
-
-	for (int channel = old_channels; channel < new_channels; ++channel) {
-		_data[channel].resize(frames());
-	}
+	allocate(new_channels, _frames);
 }
 
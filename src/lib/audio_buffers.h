@@ -34,15 +34,28 @@
 
 /** @class AudioBuffers
  *  @brief A class to hold multi-channel audio data in float format.
+ *
+ *  The samples are held channel-by-channel in a single block of memory which comes from
+ *  AudioBufferPool.
  */
 class AudioBuffers
 {
 public:
-	AudioBuffers (int channels, int frames);
+	/** What newly-allocated samples should contain */
+	enum class Contents {
+		/** silence */
+		SILENT,
+		/** anything; the caller is going to overwrite them all */
+		UNDEFINED
+	};
+
+	AudioBuffers (int channels, int frames, Contents contents = Contents::SILENT);
 	AudioBuffers (AudioBuffers const &);
 	explicit AudioBuffers (std::shared_ptr<const AudioBuffers>);
 	AudioBuffers (std::shared_ptr<const AudioBuffers> other, int frames_to_copy, int read_offset);
 
+	~AudioBuffers ();
+
 	AudioBuffers & operator= (AudioBuffers const &);
 
 	std::shared_ptr<AudioBuffers> clone () const;
@@ -56,11 +69,11 @@ public:
 	float* data (int);
 
 	int channels () const {
-		return _data.size();
+		return _channels;
 	}
 
 	int frames () const {
-		return _data.empty() ? 0 : _data[0].size();
+		return _frames;
 	}
 
 	void set_frames (int f);
@@ -75,6 +88,7 @@ public:
 
 	void copy_from (AudioBuffers const * from, int frames_to_copy, int read_offset, int write_offset);
 	void copy_channel_from (AudioBuffers const * from, int from_channel, int to_channel);
+	void copy_channel_from (AudioBuffers const * from, int from_channel, int to_channel, float gain);
 	void move (int frames, int from, int to);
 	void accumulate_channel (AudioBuffers const * from, int from_channel, int to_channel, float gain = 1);
 	void accumulate_frames (AudioBuffers const * from, int frames, int read_offset, int write_offset);
@@ -82,12 +96,18 @@ public:
 	void trim_start (int frames);
 
 private:
-	void allocate (int channels, int frames);
+	void allocate (int channels, int frames, Contents contents = Contents::SILENT);
 	void update_data_pointers ();
 
-	/** Audio data (so that, e.g. _data[2][6] is channel 2, sample 6) */
-	std::vector<std::vector<float>> _data;
-	/** Pointers to the data of each vector in _data */
+	/** Audio data from AudioBufferPool; channel c starts at _storage + c * _stride */
+	float* _storage = nullptr;
+	/** Number of samples allocated at _storage */
+	size_t _capacity = 0;
+	/** Number of samples between the start of one channel and the next */
+	int _stride = 0;
+	int _channels = 0;
+	int _frames = 0;
+	/** Pointers to the start of each channel in _storage */
 	std::vector<float*> _data_pointers;
 };
 
@@ -43,7 +43,7 @@ AudioDelay::run (shared_ptr<const AudioBuffers> in)
 	/* You can't call this with varying channel counts */
 	DCPOMATIC_ASSERT (!_tail || in->channels() == _tail->channels());
 
-	auto out = make_shared<AudioBuffers>(in->channels(), in->frames());
+	auto out = make_shared<AudioBuffers>(in->channels(), in->frames(), AudioBuffers::Contents::UNDEFINED);
 
 	if (in->frames() > _samples) {
 
@@ -60,7 +60,7 @@ AudioDelay::run (shared_ptr<const AudioBuffers> in)
 
 		/* Keep tail */
 		if (!_tail) {
-			_tail = make_shared<AudioBuffers>(in->channels(), _samples);
+			_tail = make_shared<AudioBuffers>(in->channels(), _samples, AudioBuffers::Contents::UNDEFINED);
 		}
 		_tail->copy_from (in.get(), _samples, in->frames() - _samples, 0);
 
@@ -77,7 +77,7 @@ AudioFilter::sinc_blackman (float cutoff, bool invert) const
 shared_ptr<AudioBuffers>
 AudioFilter::run (shared_ptr<const AudioBuffers> in)
 {
-	auto out = make_shared<AudioBuffers>(in->channels(), in->frames());
+	auto out = make_shared<AudioBuffers>(in->channels(), in->frames(), AudioBuffers::Contents::UNDEFINED);
 
 	if (!_tail) {
 		_tail = make_shared<AudioBuffers>(in->channels(), _M + 1);
@@ -0,0 +1,202 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "audio_mix.h"
+#include <cstring>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DCPOMATIC_X86_SIMD
+#include <immintrin.h>
+#endif
+
+
+using namespace dcpomatic;
+
+
+void
+dcpomatic::mix_scalar(MixInput const* inputs, int count, int offset, float* out, int frames)
+{
+	out += offset;
+
+	if (count == 0) {
+		memset(out, 0, frames * sizeof(float));
+		return;
+	}
+
+	for (int i = 0; i < frames; ++i) {
+		float s = inputs[0].data[offset + i] * inputs[0].gain;
+		for (int j = 1; j < count; ++j) {
+			s += inputs[j].data[offset + i] * inputs[j].gain;
+		}
+		out[i] = s;
+	}
+}
+
+
+void
+dcpomatic::apply_gain_scalar(float* data, int frames, double gain)
+{
+	for (int i = 0; i < frames; ++i) {
+		data[i] *= gain;
+	}
+}
+
+
+#ifdef DCPOMATIC_X86_SIMD
+
+/* These use separate multiplies and adds (never fused multiply-adds) so that they give exactly
+ * the same results as the scalar versions.
+ */
+
+__attribute__((target("sse2")))
+static void
+mix_sse2(MixInput const* inputs, int count, int offset, float* out, int frames)
+{
+	if (count == 0) {
+		mix_scalar(inputs, count, offset, out, frames);
+		return;
+	}
+
+	auto const gain0 = _mm_set1_ps(inputs[0].gain);
+	auto const in0 = inputs[0].data + offset;
+	auto const o = out + offset;
+
+	int i = 0;
+	for (; i <= frames - 4; i += 4) {
+		auto s = _mm_mul_ps(_mm_loadu_ps(in0 + i), gain0);
+		for (int j = 1; j < count; ++j) {
+			s = _mm_add_ps(s, _mm_mul_ps(_mm_loadu_ps(inputs[j].data + offset + i), _mm_set1_ps(inputs[j].gain)));
+		}
+		_mm_storeu_ps(o + i, s);
+	}
+
+	mix_scalar(inputs, count, offset + i, out, frames - i);
+}
+
+
+__attribute__((target("sse2")))
+static void
+apply_gain_sse2(float* data, int frames, double gain)
+{
+	auto const g = _mm_set1_pd(gain);
+
+	int i = 0;
+	for (; i <= frames - 4; i += 4) {
+		auto const v = _mm_loadu_ps(data + i);
+		auto const lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(v), g));
+		auto const hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), g));
+		_mm_storeu_ps(data + i, _mm_movelh_ps(lo, hi));
+	}
+
+	apply_gain_scalar(data + i, frames - i, gain);
+}
+
+
+__attribute__((target("avx")))
+static void
+mix_avx(MixInput const* inputs, int count, int offset, float* out, int frames)
+{
+	if (count == 0) {
+		mix_scalar(inputs, count, offset, out, frames);
+		return;
+	}
+
+	auto const gain0 = _mm256_set1_ps(inputs[0].gain);
+	auto const in0 = inputs[0].data + offset;
+	auto const o = out + offset;
+
+	int i = 0;
+	for (; i <= frames - 8; i += 8) {
+		auto s = _mm256_mul_ps(_mm256_loadu_ps(in0 + i), gain0);
+		for (int j = 1; j < count; ++j) {
+			s = _mm256_add_ps(s, _mm256_mul_ps(_mm256_loadu_ps(inputs[j].data + offset + i), _mm256_set1_ps(inputs[j].gain)));
+		}
+		_mm256_storeu_ps(o + i, s);
+	}
+
+	mix_scalar(inputs, count, offset + i, out, frames - i);
+}
+
+
+__attribute__((target("avx")))
+static void
+apply_gain_avx(float* data, int frames, double gain)
+{
+	auto const g = _mm256_set1_pd(gain);
+
+	int i = 0;
+	for (; i <= frames - 8; i += 8) {
+		auto const lo = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(data + i)), g));
+		auto const hi = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(data + i + 4)), g));
+		_mm256_storeu_ps(data + i, _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1));
+	}
+
+	apply_gain_scalar(data + i, frames - i, gain);
+}
+
+#endif
+
+
+void
+dcpomatic::mix(MixInput const* inputs, int count, int offset, float* out, int frames)
+{
+	using Function = void (*)(MixInput const*, int, int, float*, int);
+
+	static Function const function = []() -> Function {
+#ifdef DCPOMATIC_X86_SIMD
+		if (__builtin_cpu_supports("avx")) {
+			return &mix_avx;
+		} else if (__builtin_cpu_supports("sse2")) {
+			return &mix_sse2;
+		}
+#endif
+		return &mix_scalar;
+	}();
+
+	if (count == 1 && inputs[0].gain == 1) {
+		/* A common case (e.g. for a 1:1 mapping) which we can just copy */
+		if (inputs[0].data != out) {
+			memcpy(out + offset, inputs[0].data + offset, frames * sizeof(float));
+		}
+		return;
+	}
+
+	function(inputs, count, offset, out, frames);
+}
+
+
+void
+dcpomatic::apply_gain(float* data, int frames, double gain)
+{
+	using Function = void (*)(float*, int, double);
+
+	static Function const function = []() -> Function {
+#ifdef DCPOMATIC_X86_SIMD
+		if (__builtin_cpu_supports("avx")) {
+			return &apply_gain_avx;
+		} else if (__builtin_cpu_supports("sse2")) {
+			return &apply_gain_sse2;
+		}
+#endif
+		return &apply_gain_scalar;
+	}();
+
+	function(data, frames, gain);
+}
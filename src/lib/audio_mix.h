@@ -0,0 +1,71 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  src/lib/audio_mix.h
+ *  @brief Functions to mix and scale planar float audio, with SIMD versions where available.
+ */
+
+
+#ifndef DCPOMATIC_AUDIO_MIX_H
+#define DCPOMATIC_AUDIO_MIX_H
+
+
+namespace dcpomatic {
+
+
+/** One input to mix(): a channel of samples and the linear gain to apply to it */
+struct MixInput
+{
+	float const* data;
+	float gain;
+};
+
+
+/** Write the sum of some inputs, each multiplied by its gain, to out.  The inputs are added in order,
+ *  so the result is the same as setting out to the first input times its gain then accumulating
+ *  each of the others in turn.  If there are no inputs out is filled with silence.
+ *  out may be the same as the data of any of the inputs.
+ *  @param inputs Inputs.
+ *  @param count Number of inputs.
+ *  @param offset Offset (in samples) into each input's data and into out to start at.
+ *  @param out Output.
+ *  @param frames Number of samples to write.
+ */
+extern void mix(MixInput const* inputs, int count, int offset, float* out, int frames);
+
+/** Multiply some samples by a gain.  The multiplication is done in double precision.
+ *  @param data Samples.
+ *  @param frames Number of samples.
+ *  @param gain Linear gain.
+ */
+extern void apply_gain(float* data, int frames, double gain);
+
+/** Plain C++ version of mix(), for testing */
+extern void mix_scalar(MixInput const* inputs, int count, int offset, float* out, int frames);
+
+/** Plain C++ version of apply_gain(), for testing */
+extern void apply_gain_scalar(float* data, int frames, double gain);
+
+
+}
+
+
+#endif
@@ -19,13 +19,16 @@
 */
 
 
+#include "audio_buffer_pool.h"
 #include "butler.h"
 #include "compose.hpp"
 #include "cross.h"
 #include "dcpomatic_log.h"
 #include "exceptions.h"
+#include "image_pool.h"
 #include "log.h"
 #include "player.h"
+#include "trace.h"
 #include "util.h"
 #include "video_content.h"
 
@@ -326,6 +329,7 @@ try
 	/* If the weak_ptr cannot be locked the video obviously no longer requires any work */
 	if (video) {
 		LOG_TIMING("start-prepare in %1", thread_id());
+		TraceSpan span("Butler::prepare");
 		video->prepare (_pixel_format, _video_range, _alignment, _fast, _prepare_only_proxy);
 		LOG_TIMING("finish-prepare in %1", thread_id());
 	}
@@ -399,7 +403,12 @@ pair<size_t, string>
 Butler::memory_used () const
 {
 	/* XXX: should also look at _audio.memory_used() */
-	return _video.memory_used();
+	auto used = _video.memory_used();
+	auto const pool = ImagePool::instance()->statistics();
+	used.second += String::compose("; image pool %1MB idle, %2 hits, %3 misses", pool.idle / 1048576, pool.hits, pool.misses);
+	auto const audio_pool = AudioBufferPool::instance()->statistics();
+	used.second += String::compose("; audio pool %1MB idle, %2 hits, %3 misses", audio_pool.idle / 1048576, audio_pool.hits, audio_pool.misses);
+	return used;
 }
 
 
@@ -93,6 +93,7 @@ public:
 	boost::optional<dcpomatic::DCPTime> get_audio (Behaviour behaviour, float* out, Frame frames);
 	boost::optional<TextRingBuffers::Data> get_closed_caption ();
 
+	/** @return memory used by buffered video, and a description of it (including statistics of the ImagePool) */
 	std::pair<size_t, std::string> memory_used () const;
 
 private:
@@ -33,4 +33,7 @@ public:
 	std::string name () const override;
 	std::string json_name () const override;
 	void run () override;
+	ResourceClass resource_class () const override {
+		return ResourceClass::LIGHT;
+	}
 };
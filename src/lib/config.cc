@@ -94,10 +94,13 @@ Config::set_defaults ()
 {
 	_master_encoding_threads = max (2U, boost::thread::hardware_concurrency ());
 	_server_encoding_threads = max (2U, boost::thread::hardware_concurrency ());
+	_server_reel_encoding = false;
 	_server_port_base = 6192;
 	_use_any_servers = true;
 	_servers.clear ();
 	_only_servers_encode = false;
+	_compress_images_to_servers = false;
+	_encode_reels_on_servers = false;
 	_tms_protocol = FileTransferProtocol::SCP;
 	_tms_passive = true;
 	_tms_ip = "";
@@ -173,6 +176,13 @@ Config::set_defaults ()
 	   use about 240Mb with 72 encoding threads.
 	*/
 	_frames_in_memory_multiplier = 3;
+	_maximum_cpu_jobs = 1;
+	_maximum_io_jobs = 2;
+	_maximum_light_jobs = 4;
+	_dcp_decode_threads = 1;
+	_j2k_decode_cache_size = 512;
+	_disk_writer_buffers = 4;
+	_decode_ahead = false;
 	_decode_reduction = optional<int>();
 	_default_notify = false;
 	for (int i = 0; i < NOTIFICATION_COUNT; ++i) {
@@ -324,6 +334,8 @@ try
 		_server_encoding_threads = f.number_child<int>("ServerEncodingThreads");
 	}
 
+	_server_reel_encoding = f.optional_bool_child("ServerReelEncoding").get_value_or(false);
+
 	_default_directory = f.optional_string_child ("DefaultDirectory");
 	if (_default_directory && _default_directory->empty ()) {
 		/* We used to store an empty value for this to mean "none set" */
@@ -348,6 +360,8 @@ try
 	}
 
 	_only_servers_encode = f.optional_bool_child ("OnlyServersEncode").get_value_or (false);
+	_compress_images_to_servers = f.optional_bool_child("CompressImagesToServers").get_value_or(false);
+	_encode_reels_on_servers = f.optional_bool_child("EncodeReelsOnServers").get_value_or(false);
 	_tms_protocol = static_cast<FileTransferProtocol>(f.optional_number_child<int>("TMSProtocol").get_value_or(static_cast<int>(FileTransferProtocol::SCP)));
 	_tms_passive = f.optional_bool_child("TMSPassive").get_value_or(true);
 	_tms_ip = f.string_child ("TMSIP");
@@ -578,6 +592,13 @@ try
 		}
 	}
 	_frames_in_memory_multiplier = f.optional_number_child<int>("FramesInMemoryMultiplier").get_value_or(3);
+	_maximum_cpu_jobs = f.optional_number_child<int>("MaximumCPUJobs").get_value_or(1);
+	_maximum_io_jobs = f.optional_number_child<int>("MaximumIOJobs").get_value_or(2);
+	_maximum_light_jobs = f.optional_number_child<int>("MaximumLightJobs").get_value_or(4);
+	_dcp_decode_threads = f.optional_number_child<int>("DCPDecodeThreads").get_value_or(1);
+	_j2k_decode_cache_size = f.optional_number_child<int>("J2KDecodeCacheSize").get_value_or(512);
+	_disk_writer_buffers = f.optional_number_child<int>("DiskWriterBuffers").get_value_or(4);
+	_decode_ahead = f.optional_bool_child("DecodeAhead").get_value_or(false);
 	_decode_reduction = f.optional_number_child<int>("DecodeReduction");
 	_default_notify = f.optional_bool_child("DefaultNotify").get_value_or(false);
 
@@ -745,6 +766,10 @@ Config::write_config () const
 	cxml::add_text_child(root, "MasterEncodingThreads", fmt::to_string(_master_encoding_threads));
 	/* [XML] ServerEncodingThreads Number of encoding threads to use when running as server. */
 	cxml::add_text_child(root, "ServerEncodingThreads", fmt::to_string(_server_encoding_threads));
+	/* [XML] ServerReelEncoding 1 to accept requests from masters to encode whole reels when running as server;
+	   the server then reads content from, and writes picture assets into, the master's film directory.
+	*/
+	cxml::add_text_child(root, "ServerReelEncoding", _server_reel_encoding ? "1" : "0");
 	if (_default_directory) {
 		/* [XML:opt] DefaultDirectory Default directory when creating a new film in the GUI. */
 		cxml::add_text_child(root, "DefaultDirectory", _default_directory->string());
@@ -768,6 +793,15 @@ Config::write_config () const
 	   is done by the encoding servers.  0 to set the master to do some encoding as well as coordinating the job.
 	*/
 	cxml::add_text_child(root, "OnlyServersEncode", _only_servers_encode ? "1" : "0");
+	/* [XML] CompressImagesToServers 1 to losslessly compress images before sending them to encoding servers
+	   which support it; this uses more CPU on the master but less network bandwidth.
+	*/
+	cxml::add_text_child(root, "CompressImagesToServers", _compress_images_to_servers ? "1" : "0");
+	/* [XML] EncodeReelsOnServers 1 to ask encoding servers which support it to make the picture assets for whole reels
+	   of a DCP, reading the content and writing the assets themselves; this needs the film and its content to be
+	   on storage that the servers can see at the same paths as the master.
+	*/
+	cxml::add_text_child(root, "EncodeReelsOnServers", _encode_reels_on_servers ? "1" : "0");
 	/* [XML] TMSProtocol Protocol to use to copy files to a TMS; 0 to use SCP, 1 for FTP. */
 	cxml::add_text_child(root, "TMSProtocol", fmt::to_string(static_cast<int>(_tms_protocol)));
 	/* [XML] TMSPassive True to use PASV mode with TMS FTP connections. */
@@ -1007,6 +1041,24 @@ Config::write_config () const
 	   frames to be held in memory at once.
 	*/
 	cxml::add_text_child(root, "FramesInMemoryMultiplier", fmt::to_string(_frames_in_memory_multiplier));
+	/* [XML] MaximumCPUJobs maximum number of CPU-heavy jobs (e.g. transcodes) to run at the same time. */
+	cxml::add_text_child(root, "MaximumCPUJobs", fmt::to_string(_maximum_cpu_jobs));
+	/* [XML] MaximumIOJobs maximum number of I/O-heavy jobs (e.g. content examination, verification) to run at the same time. */
+	cxml::add_text_child(root, "MaximumIOJobs", fmt::to_string(_maximum_io_jobs));
+	/* [XML] MaximumLightJobs maximum number of light jobs (e.g. sending emails) to run at the same time. */
+	cxml::add_text_child(root, "MaximumLightJobs", fmt::to_string(_maximum_light_jobs));
+	/* [XML] DCPDecodeThreads number of threads, each decoding its own part of the timeline, to use when making
+	   a DCP; 1 to decode everything on one thread.
+	*/
+	cxml::add_text_child(root, "DCPDecodeThreads", fmt::to_string(_dcp_decode_threads));
+	/* [XML] J2KDecodeCacheSize maximum size in MB of the cache of decoded JPEG2000 frames used when playing DCPs. */
+	cxml::add_text_child(root, "J2KDecodeCacheSize", fmt::to_string(_j2k_decode_cache_size));
+	/* [XML] DiskWriterBuffers number of 16MB blocks of data that can be between being read and being written
+	   at once when writing DCPs to drives.
+	*/
+	cxml::add_text_child(root, "DiskWriterBuffers", fmt::to_string(_disk_writer_buffers));
+	/* [XML] DecodeAhead 1 to read and decode video files on a separate thread, ahead of where they are needed. */
+	cxml::add_text_child(root, "DecodeAhead", _decode_ahead ? "1" : "0");
 
 	/* [XML] DecodeReduction power of 2 to reduce DCP images by before decoding in the player. */
 	if (_decode_reduction) {
@@ -72,6 +72,11 @@ public:
 		return _server_encoding_threads;
 	}
 
+	/** @return true if, when running as a server, we should accept requests to encode whole reels */
+	bool server_reel_encoding () const {
+		return _server_reel_encoding;
+	}
+
 	boost::optional<boost::filesystem::path> default_directory () const {
 		return _default_directory;
 	}
@@ -117,6 +122,7 @@ public:
 		ALLOW_SMPTE_BV20,
 		ISDCF_NAME_PART_LENGTH,
 		ALLOW_ANY_CONTAINER,
+		J2K_DECODE_CACHE_SIZE,
 #ifdef DCPOMATIC_GROK
 		GROK,
 #endif
@@ -152,6 +158,16 @@ public:
 		return _only_servers_encode;
 	}
 
+	/** @return true to losslessly compress images before sending them to encoding servers which support it */
+	bool compress_images_to_servers () const {
+		return _compress_images_to_servers;
+	}
+
+	/** @return true to ask encoding servers which support it to encode whole reels of DCPs */
+	bool encode_reels_on_servers () const {
+		return _encode_reels_on_servers;
+	}
+
 	FileTransferProtocol tms_protocol () const {
 		return _tms_protocol;
 	}
@@ -494,6 +510,40 @@ public:
 		return _frames_in_memory_multiplier;
 	}
 
+	int maximum_cpu_jobs () const {
+		return _maximum_cpu_jobs;
+	}
+
+	int maximum_io_jobs () const {
+		return _maximum_io_jobs;
+	}
+
+	int maximum_light_jobs () const {
+		return _maximum_light_jobs;
+	}
+
+	/** @return number of threads, each with its own Player, to decode content with when making a DCP */
+	int dcp_decode_threads () const {
+		return _dcp_decode_threads;
+	}
+
+	/** @return maximum size of J2KDecodeCache in MB */
+	int j2k_decode_cache_size () const {
+		return _j2k_decode_cache_size;
+	}
+
+	/** @return number of blocks of data that can be between being read and being written at once
+	 *  when writing DCPs to drives.
+	 */
+	int disk_writer_buffers () const {
+		return _disk_writer_buffers;
+	}
+
+	/** @return true to read and decode video files on a separate thread, ahead of where they are needed */
+	bool decode_ahead () const {
+		return _decode_ahead;
+	}
+
 	boost::optional<int> decode_reduction () const {
 		return _decode_reduction;
 	}
@@ -695,6 +745,10 @@ public:
 		maybe_set (_server_encoding_threads, n);
 	}
 
+	void set_server_reel_encoding (bool s) {
+		maybe_set (_server_reel_encoding, s);
+	}
+
 	void set_default_directory (boost::filesystem::path d) {
 		if (_default_directory && *_default_directory == d) {
 			return;
@@ -712,6 +766,14 @@ public:
 		maybe_set (_only_servers_encode, o);
 	}
 
+	void set_compress_images_to_servers (bool c) {
+		maybe_set (_compress_images_to_servers, c);
+	}
+
+	void set_encode_reels_on_servers (bool e) {
+		maybe_set (_encode_reels_on_servers, e);
+	}
+
 	void set_tms_protocol (FileTransferProtocol p) {
 		maybe_set (_tms_protocol, p);
 	}
@@ -1004,6 +1066,34 @@ public:
 		maybe_set (_frames_in_memory_multiplier, m);
 	}
 
+	void set_maximum_cpu_jobs (int m) {
+		maybe_set (_maximum_cpu_jobs, m);
+	}
+
+	void set_maximum_io_jobs (int m) {
+		maybe_set (_maximum_io_jobs, m);
+	}
+
+	void set_maximum_light_jobs (int m) {
+		maybe_set (_maximum_light_jobs, m);
+	}
+
+	void set_dcp_decode_threads (int t) {
+		maybe_set (_dcp_decode_threads, t);
+	}
+
+	void set_j2k_decode_cache_size (int s) {
+		maybe_set (_j2k_decode_cache_size, s, J2K_DECODE_CACHE_SIZE);
+	}
+
+	void set_disk_writer_buffers (int b) {
+		maybe_set (_disk_writer_buffers, b);
+	}
+
+	void set_decode_ahead (bool d) {
+		maybe_set (_decode_ahead, d);
+	}
+
 	void set_decode_reduction (boost::optional<int> r) {
 		maybe_set (_decode_reduction, r);
 	}
@@ -1329,6 +1419,8 @@ private:
 	int _master_encoding_threads;
 	/** number of threads which a server should use for J2K encoding on the local machine */
 	int _server_encoding_threads;
+	/** true if, when running as a server, we should accept requests to encode whole reels */
+	bool _server_reel_encoding;
 	/** default directory to put new films in */
 	boost::optional<boost::filesystem::path> _default_directory;
 	/** base port number to use for J2K encoding servers;
@@ -1340,6 +1432,8 @@ private:
 	/** J2K encoding servers that should definitely be used */
 	std::vector<std::string> _servers;
 	bool _only_servers_encode;
+	bool _compress_images_to_servers;
+	bool _encode_reels_on_servers;
 	FileTransferProtocol _tms_protocol;
 	bool _tms_passive;
 	/** The IP address of a TMS that we can copy DCPs to */
@@ -1439,6 +1533,14 @@ private:
 	boost::optional<KDMWriteType> _last_kdm_write_type;
 	boost::optional<DKDMWriteType> _last_dkdm_write_type;
 	int _frames_in_memory_multiplier;
+	/** Maximum number of jobs of each Job::ResourceClass that JobManager will run at once */
+	int _maximum_cpu_jobs;
+	int _maximum_io_jobs;
+	int _maximum_light_jobs;
+	int _dcp_decode_threads;
+	int _j2k_decode_cache_size;
+	int _disk_writer_buffers;
+	bool _decode_ahead;
 	boost::optional<int> _decode_reduction;
 	bool _default_notify;
 	bool _notification[NOTIFICATION_COUNT];
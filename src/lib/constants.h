@@ -47,6 +47,12 @@
 #define MAX_CLOSED_CAPTION_XML_SIZE_TEXT "256KB"
 #define CERTIFICATE_VALIDITY_PERIOD (10 * 365)
 #define SNAP_SUBDIVISION 64
+/** Largest request (in bytes) to encode a frame that an encoding server will accept */
+#define MAX_ENCODE_REQUEST_SIZE 65536
+/** Largest request (in bytes) to encode a reel that an encoding server will accept; these contain a film's metadata */
+#define MAX_REEL_ENCODE_REQUEST_SIZE (16 * 1024 * 1024)
+/** Sent by an encoding server, in place of a frame count, when it has finished encoding a reel */
+#define REEL_ENCODING_FINISHED 0xffffffff
 
 
 #endif
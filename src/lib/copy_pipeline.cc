@@ -0,0 +1,208 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "copy_pipeline.h"
+#include "dcpomatic_assert.h"
+#include "digester.h"
+#include <boost/bind/bind.hpp>
+#include <algorithm>
+
+
+using std::function;
+using std::min;
+using std::string;
+
+
+CopyPipeline::CopyPipeline(uint64_t length, int buffers, uint64_t block_size, function<void (uint8_t*, size_t)> read)
+	: _length(length)
+	, _buffers(std::max(2, buffers))
+	, _block_size(block_size)
+	, _read(read)
+{
+	DCPOMATIC_ASSERT(_block_size > 0);
+}
+
+
+CopyPipeline::~CopyPipeline()
+{
+	stop();
+}
+
+
+/** Move all the data, passing each block in order to consume (in the caller's thread).
+ *  Any exception thrown by read or consume is re-thrown here.
+ *  @return digest of all the data.
+ */
+string
+CopyPipeline::run(function<void (uint8_t const*, size_t)> consume)
+{
+	if (_length <= _block_size) {
+		return run_directly(consume);
+	}
+
+	/* Don't allocate more blocks than we could ever fill at once */
+	auto const blocks = std::min(static_cast<uint64_t>(_buffers), (_length + _block_size - 1) / _block_size);
+	_blocks.resize(blocks);
+	for (auto& block: _blocks) {
+		block.data.resize(_block_size);
+		_free.push_back(&block);
+	}
+
+	_reader = boost::thread(boost::bind(&CopyPipeline::reader, this));
+	_digester = boost::thread(boost::bind(&CopyPipeline::digester, this));
+
+	try {
+		for (uint64_t done = 0; done < _length; ) {
+			auto block = pop(_digested);
+			if (!block) {
+				break;
+			}
+			consume(block->data.data(), block->size);
+			done += block->size;
+			push(_free, block);
+		}
+	} catch (...) {
+		stop();
+		throw;
+	}
+
+	stop();
+
+	boost::mutex::scoped_lock lm(_mutex);
+	if (_error) {
+		std::rethrow_exception(_error);
+	}
+
+	return _digest;
+}
+
+
+string
+CopyPipeline::run_directly(function<void (uint8_t const*, size_t)> consume)
+{
+	std::vector<uint8_t> data(_length);
+	Digester digester;
+
+	if (_length > 0) {
+		_read(data.data(), _length);
+		digester.add(data.data(), _length);
+		consume(data.data(), _length);
+	}
+
+	return digester.get();
+}
+
+
+void
+CopyPipeline::reader()
+try
+{
+	for (uint64_t remaining = _length; remaining > 0; ) {
+		auto block = pop(_free);
+		if (!block) {
+			return;
+		}
+		block->size = min(remaining, _block_size);
+		_read(block->data.data(), block->size);
+		push(_filled, block);
+		remaining -= block->size;
+	}
+} catch (...) {
+	fail(std::current_exception());
+}
+
+
+void
+CopyPipeline::digester()
+try
+{
+	Digester digester;
+	for (uint64_t remaining = _length; remaining > 0; ) {
+		auto block = pop(_filled);
+		if (!block) {
+			return;
+		}
+		digester.add(block->data.data(), block->size);
+		push(_digested, block);
+		remaining -= block->size;
+	}
+
+	boost::mutex::scoped_lock lm(_mutex);
+	_digest = digester.get();
+} catch (...) {
+	fail(std::current_exception());
+}
+
+
+/** @return the next block from a queue, or nullptr if the pipeline has been stopped */
+CopyPipeline::Block*
+CopyPipeline::pop(std::list<Block*>& queue)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	while (queue.empty() && !_stop) {
+		_condition.wait(lm);
+	}
+	if (_stop) {
+		return nullptr;
+	}
+	auto block = queue.front();
+	queue.pop_front();
+	return block;
+}
+
+
+void
+CopyPipeline::push(std::list<Block*>& queue, Block* block)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	queue.push_back(block);
+	_condition.notify_all();
+}
+
+
+void
+CopyPipeline::fail(std::exception_ptr error)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	if (!_error) {
+		_error = error;
+	}
+	_stop = true;
+	_condition.notify_all();
+}
+
+
+void
+CopyPipeline::stop()
+{
+	{
+		boost::mutex::scoped_lock lm(_mutex);
+		_stop = true;
+		_condition.notify_all();
+	}
+
+	if (_reader.joinable()) {
+		_reader.join();
+	}
+	if (_digester.joinable()) {
+		_digester.join();
+	}
+}
@@ -0,0 +1,99 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef DCPOMATIC_COPY_PIPELINE_H
+#define DCPOMATIC_COPY_PIPELINE_H
+
+
+#include <boost/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <exception>
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+
+/** @class CopyPipeline
+ *  @brief A pipeline to move data in blocks from some source to some destination.
+ *
+ *  Blocks are read in one thread, digested in another and then given to the caller's thread,
+ *  so that reading, digesting and writing can all happen at the same time.  Data which fits
+ *  into a single block is moved directly in the caller's thread, since there would be nothing
+ *  to overlap.
+ */
+class CopyPipeline
+{
+public:
+	/** @param length Total number of bytes to move.
+	 *  @param buffers Maximum number of blocks that can be in the pipeline at once.
+	 *  @param block_size Size of each block in bytes.
+	 *  @param read Function to read some data; called from a separate thread.  It should throw an exception on error.
+	 */
+	CopyPipeline(uint64_t length, int buffers, uint64_t block_size, std::function<void (uint8_t*, size_t)> read);
+	~CopyPipeline();
+
+	CopyPipeline(CopyPipeline const&) = delete;
+	CopyPipeline& operator=(CopyPipeline const&) = delete;
+
+	std::string run(std::function<void (uint8_t const*, size_t)> consume);
+
+private:
+	struct Block
+	{
+		std::vector<uint8_t> data;
+		size_t size = 0;
+	};
+
+	std::string run_directly(std::function<void (uint8_t const*, size_t)> consume);
+	void reader();
+	void digester();
+	Block* pop(std::list<Block*>& queue);
+	void push(std::list<Block*>& queue, Block* block);
+	void fail(std::exception_ptr error);
+	void stop();
+
+	uint64_t const _length;
+	int const _buffers;
+	uint64_t const _block_size;
+	std::function<void (uint8_t*, size_t)> _read;
+	std::vector<Block> _blocks;
+
+	boost::thread _reader;
+	boost::thread _digester;
+
+	/** mutex to protect everything below */
+	boost::mutex _mutex;
+	boost::condition_variable _condition;
+	/** blocks waiting to be read into */
+	std::list<Block*> _free;
+	/** blocks waiting to be digested */
+	std::list<Block*> _filled;
+	/** blocks waiting to be consumed */
+	std::list<Block*> _digested;
+	bool _stop = false;
+	std::exception_ptr _error;
+	std::string _digest;
+};
+
+
+#endif
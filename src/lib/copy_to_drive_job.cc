@@ -20,6 +20,7 @@
 
 
 #include "compose.hpp"
+#include "config.h"
 #include "copy_to_drive_job.h"
 #include "dcpomatic_log.h"
 #include "disk_writer_messages.h"
@@ -77,7 +78,7 @@ CopyToDriveJob::run ()
 		LOG_DISK("%1", dcp.string());
 	}
 
-	string request = String::compose(DISK_WRITER_WRITE "\n%1\n", _drive.device());
+	string request = String::compose(DISK_WRITER_WRITE "\n%1\n%2\n", _drive.device(), Config::instance()->disk_writer_buffers());
 	for (auto dcp: _dcps) {
 		request += String::compose("%1\n", dcp.string());
 	}
@@ -30,6 +30,9 @@ public:
 	std::string name () const override;
 	std::string json_name () const override;
 	void run () override;
+	ResourceClass resource_class () const override {
+		return ResourceClass::IO;
+	}
 	bool enable_notify () const override {
 		return true;
 	}
@@ -175,40 +175,26 @@ DCPDecoder::pass ()
 	if ((_j2k_mono_reader || _j2k_stereo_reader || _mpeg2_mono_reader) && (_decode_referenced || !_dcp_content->reference_video())) {
 		auto const entry_point = (*_reel)->main_picture()->entry_point().get_value_or(0);
 		if (_j2k_mono_reader) {
-			video->emit (
-				film(),
-				std::make_shared<J2KImageProxy>(
-					_j2k_mono_reader->get_frame(entry_point + frame),
-					picture_asset->size(),
-					AV_PIX_FMT_XYZ12LE,
-					_forced_reduction
-					),
-				ContentTime::from_frames(_offset + frame, vfr)
+			auto proxy = std::make_shared<J2KImageProxy>(
+				_j2k_mono_reader->get_frame(entry_point + frame),
+				picture_asset->size(),
+				AV_PIX_FMT_XYZ12LE,
+				_forced_reduction
 				);
+			proxy->set_source(picture_asset->id(), entry_point + frame);
+			video->emit(film(), proxy, ContentTime::from_frames(_offset + frame, vfr));
 		} else if (_j2k_stereo_reader) {
-			video->emit (
-				film(),
-				std::make_shared<J2KImageProxy>(
-					_j2k_stereo_reader->get_frame (entry_point + frame),
-					picture_asset->size(),
-					dcp::Eye::LEFT,
-					AV_PIX_FMT_XYZ12LE,
-					_forced_reduction
-					),
-				ContentTime::from_frames(_offset + frame, vfr)
-				);
-
-			video->emit (
-				film(),
-				std::make_shared<J2KImageProxy>(
-					_j2k_stereo_reader->get_frame (entry_point + frame),
+			for (auto eye: { dcp::Eye::LEFT, dcp::Eye::RIGHT }) {
+				auto proxy = std::make_shared<J2KImageProxy>(
+					_j2k_stereo_reader->get_frame(entry_point + frame),
 					picture_asset->size(),
-					dcp::Eye::RIGHT,
+					eye,
 					AV_PIX_FMT_XYZ12LE,
 					_forced_reduction
-					),
-				ContentTime::from_frames(_offset + frame, vfr)
-				);
+					);
+				proxy->set_source(picture_asset->id(), entry_point + frame);
+				video->emit(film(), proxy, ContentTime::from_frames(_offset + frame, vfr));
+			}
 		} else if (_mpeg2_mono_reader) {
 			/* XXX: got to flush this at some point */
 			try {
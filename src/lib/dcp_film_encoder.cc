@@ -29,19 +29,23 @@
 
 #include "audio_decoder.h"
 #include "compose.hpp"
+#include "config.h"
 #include "dcp_film_encoder.h"
 #include "film.h"
 #include "j2k_encoder.h"
 #include "job.h"
 #include "mpeg2_encoder.h"
+#include "parallel_video_player.h"
 #include "player.h"
 #include "player_video.h"
 #include "referenced_reel_asset.h"
+#include "remote_reel_encoder.h"
 #include "text_content.h"
 #include "video_decoder.h"
 #include "writer.h"
 #include <boost/signals2.hpp>
 #include <iostream>
+#include <set>
 
 #include "i18n.h"
 
@@ -50,6 +54,7 @@ using std::cout;
 using std::dynamic_pointer_cast;
 using std::list;
 using std::make_shared;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -70,6 +75,8 @@ DCPFilmEncoder::DCPFilmEncoder(shared_ptr<const Film> film, weak_ptr<Job> job)
 	, _writer(film, job, film->dir(film->dcp_name()))
 	, _finishing (false)
 	, _non_burnt_subtitles (false)
+	, _parallel(false)
+	, _parallel_frames_done(0)
 {
 	switch (_film->video_encoding()) {
 	case VideoEncoding::JPEG2000:
@@ -124,12 +131,20 @@ DCPFilmEncoder::go()
 		_writer.write(_player.get_subtitle_fonts());
 	}
 
-	int passes = 0;
-	while (!_player.pass()) {
-		if ((++passes % 8) == 0) {
-			auto job = _job.lock();
-			DCPOMATIC_ASSERT(job);
-			job->set_progress(_player.progress());
+	auto const decode_threads = Config::instance()->dcp_decode_threads();
+	auto const reel_servers = RemoteReelEncoder::servers(_film);
+	if (!reel_servers.empty()) {
+		go_distributed(reel_servers);
+	} else if (decode_threads > 1 && ParallelVideoPlayer::suitable(_film)) {
+		go_parallel(decode_threads);
+	} else {
+		int passes = 0;
+		while (!_player.pass()) {
+			if ((++passes % 8) == 0) {
+				auto job = _job.lock();
+				DCPOMATIC_ASSERT(job);
+				job->set_progress(_player.progress());
+			}
 		}
 	}
 
@@ -143,6 +158,135 @@ DCPFilmEncoder::go()
 }
 
 
+/** Make the video using a ParallelVideoPlayer, with our own _player only
+ *  giving audio, text and Atmos data.
+ */
+void
+DCPFilmEncoder::go_parallel(int threads)
+{
+	_parallel = true;
+	_player.set_ignore_video();
+
+	/* Chunks should be long enough that seeking (which may mean decoding from an earlier key frame)
+	 * does not take much of each thread's time.  Each thread holds no more than 24 frames in memory
+	 * however long its chunk is.
+	 */
+	ParallelVideoPlayer video(_film, threads, DCPTime::from_seconds(2), 24);
+
+	auto const frames = std::max(_film->length().frames_round(_film->video_frame_rate()), static_cast<Frame>(1));
+
+	bool others_done = false;
+	while (true) {
+		if (!others_done) {
+			others_done = _player.pass();
+		}
+
+		/* Encode whatever video is ready, waiting for it if there is nothing else to do */
+		while (auto v = video.get(others_done)) {
+			_encoder->encode(v->first, v->second);
+			if (v->first->eyes() != Eyes::RIGHT && (++_parallel_frames_done % 8) == 0) {
+				auto job = _job.lock();
+				DCPOMATIC_ASSERT(job);
+				job->set_progress(static_cast<float>(_parallel_frames_done) / frames);
+			}
+		}
+
+		if (others_done && video.finished()) {
+			break;
+		}
+	}
+}
+
+
+/** Ask some encoding servers to make the picture assets for reels of the film, making the video for any
+ *  other reels with a Player of our own; our own _player only gives audio, text and Atmos data.
+ */
+void
+DCPFilmEncoder::go_distributed(list<EncodeServerDescription> servers)
+{
+	_parallel = true;
+	_player.set_ignore_video();
+
+	auto const reels = _film->reels();
+	auto const frames = std::max(_film->length().frames_round(_film->video_frame_rate()), static_cast<Frame>(1));
+
+	auto set_progress = [this, frames]() {
+		auto job = _job.lock();
+		DCPOMATIC_ASSERT(job);
+		job->set_progress(static_cast<float>(_parallel_frames_done) / frames);
+	};
+
+	/* Reels which can re-use what we made last time are quicker to finish here than to re-make on a server */
+	set<int> local_only;
+	for (auto i = 0U; i < reels.size(); ++i) {
+		if (_writer.has_existing_picture_asset(i)) {
+			local_only.insert(i);
+		}
+	}
+
+	RemoteReelEncoder remote(_film, servers, local_only, [this](Frame frames) {
+		_parallel_frames_done += frames;
+	});
+
+	Player video_player(_film, Image::Alignment::PADDED);
+	video_player.set_ignore_audio();
+	video_player.set_ignore_text();
+
+	/* The reel that we are making ourselves */
+	optional<int> reel;
+	bool reel_finished = false;
+
+	boost::signals2::scoped_connection connection = video_player.Video.connect(
+		[this, &reels, &reel, &reel_finished, &set_progress](shared_ptr<PlayerVideo> video, DCPTime time) {
+			auto const& period = reels[*reel];
+			if (time >= period.to) {
+				reel_finished = true;
+			} else if (time >= period.from) {
+				_encoder->encode(video, time);
+				if (video->eyes() != Eyes::RIGHT && (++_parallel_frames_done % 8) == 0) {
+					set_progress();
+				}
+			}
+		});
+
+	auto next_reel = [&remote, &reels, &reel, &reel_finished, &video_player](bool wait) {
+		reel = remote.claim(wait);
+		if (reel) {
+			video_player.seek(reels[*reel].from, true);
+			reel_finished = false;
+		}
+	};
+
+	next_reel(false);
+
+	bool others_done = false;
+	while (true) {
+		if (!others_done) {
+			others_done = _player.pass();
+		}
+
+		if (reel) {
+			if (reel_finished || video_player.pass()) {
+				next_reel(false);
+			}
+		} else if (others_done) {
+			/* Wait for the servers to finish, making any reels that they fail to */
+			next_reel(true);
+			set_progress();
+			if (!reel) {
+				break;
+			}
+		}
+	}
+
+	remote.rethrow();
+
+	for (auto const& asset: remote.assets()) {
+		_writer.use_picture_asset(asset.reel, asset.asset, asset.info);
+	}
+}
+
+
 void
 DCPFilmEncoder::pause()
 {
@@ -190,8 +334,19 @@ DCPFilmEncoder::current_rate() const
 	return _encoder->current_encoding_rate();
 }
 
+std::vector<EncodeServerStatistics>
+DCPFilmEncoder::server_statistics() const
+{
+	return _encoder->server_statistics();
+}
+
+
 Frame
 DCPFilmEncoder::frames_done() const
 {
+	if (_parallel) {
+		return _parallel_frames_done;
+	}
+
 	return _player.frames_done();
 }
@@ -22,11 +22,14 @@
 #include "atmos_metadata.h"
 #include "dcp_text_track.h"
 #include "dcpomatic_time.h"
+#include "encode_server_description.h"
 #include "film_encoder.h"
 #include "player_text.h"
 #include "j2k_encoder.h"
 #include "writer.h"
 #include <dcp/atmos_frame.h>
+#include <atomic>
+#include <list>
 
 
 class AudioBuffers;
@@ -49,6 +52,7 @@ public:
 
 	boost::optional<float> current_rate () const override;
 	Frame frames_done () const override;
+	std::vector<EncodeServerStatistics> server_statistics() const override;
 
 	/** @return true if we are in the process of calling Encoder::process_end */
 	bool finishing () const override {
@@ -62,6 +66,9 @@ private:
 
 	friend struct ::frames_not_lost_when_threads_disappear;
 
+	void go_parallel(int threads);
+	void go_distributed(std::list<EncodeServerDescription> servers);
+
 	void video (std::shared_ptr<PlayerVideo>, dcpomatic::DCPTime);
 	void audio (std::shared_ptr<AudioBuffers>, dcpomatic::DCPTime);
 	void text (PlayerText, TextType, boost::optional<DCPTextTrack>, dcpomatic::DCPTimePeriod);
@@ -71,6 +78,12 @@ private:
 	std::unique_ptr<VideoEncoder> _encoder;
 	bool _finishing;
 	bool _non_burnt_subtitles;
+	/** true if we are using go_parallel() or go_distributed() */
+	std::atomic<bool> _parallel;
+	/** number of video frames given to _encoder by go_parallel(), or made by
+	 *  _encoder or encoding servers in go_distributed()
+	 */
+	std::atomic<Frame> _parallel_frames_done;
 
 	boost::signals2::scoped_connection _player_video_connection;
 	boost::signals2::scoped_connection _player_audio_connection;
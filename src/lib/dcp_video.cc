@@ -34,6 +34,7 @@
 #include "config.h"
 #include "cross.h"
 #include "dcp_video.h"
+#include "dcpomatic_assert.h"
 #include "dcpomatic_log.h"
 #include "dcpomatic_socket.h"
 #include "encode_server_description.h"
@@ -41,7 +42,9 @@
 #include "image.h"
 #include "log.h"
 #include "player_video.h"
+#include "rgb_to_xyz.h"
 #include "rng.h"
+#include "trace.h"
 #include <libcxml/cxml.h>
 #include <dcp/openjpeg_image.h>
 #include <dcp/rgb_xyz.h>
@@ -64,6 +67,7 @@ using std::cout;
 using std::make_shared;
 using std::shared_ptr;
 using std::string;
+using boost::optional;
 using dcp::ArrayData;
 #if BOOST_VERSION >= 106100
 using namespace boost::placeholders;
@@ -103,12 +107,7 @@ DCPVideo::convert_to_xyz (shared_ptr<const PlayerVideo> frame)
 
 	auto image = frame->image (bind(&PlayerVideo::keep_xyz_or_rgb, _1), VideoRange::FULL, false);
 	if (frame->colour_conversion()) {
-		xyz = dcp::rgb_to_xyz (
-			image->data()[0],
-			image->size(),
-			image->stride()[0],
-			frame->colour_conversion().get()
-			);
+		xyz = dcpomatic::rgb_to_xyz(*image, frame->colour_conversion().get());
 	} else {
 		xyz = make_shared<dcp::OpenJPEGImage>(image->data()[0], image->size(), image->stride()[0]);
 	}
@@ -217,13 +216,12 @@ DCPVideo::encode_locally () const
 	return enc;
 }
 
-/** Send this frame to a remote server for J2K encoding, then read the result.
- *  @param serv Server to send to.
+/** Open a connection to an encode server.
+ *  @param serv Server to connect to.
  *  @param timeout timeout in seconds.
- *  @return Encoded data.
  */
-ArrayData
-DCPVideo::encode_remotely (EncodeServerDescription serv, int timeout) const
+shared_ptr<Socket>
+DCPVideo::connect_to_server(EncodeServerDescription serv, int timeout)
 {
 	boost::asio::io_service io_service;
 	boost::asio::ip::tcp::resolver resolver (io_service);
@@ -235,42 +233,120 @@ DCPVideo::encode_remotely (EncodeServerDescription serv, int timeout) const
 
 	socket->connect (*endpoint_iterator);
 
+	return socket;
+}
+
+
+/** Send this frame to a remote server for J2K encoding, then read the result.
+ *  @param serv Server to send to.
+ *  @param timeout timeout in seconds.
+ *  @return Encoded data.
+ */
+ArrayData
+DCPVideo::encode_remotely (EncodeServerDescription serv, int timeout) const
+{
+	auto socket = connect_to_server(serv, timeout);
+	send_to_server(serv, socket, {}, true);
+	return receive_from_server(socket);
+}
+
+
+/** Send this frame to a remote server for J2K encoding.
+ *  @param serv Server to send to.
+ *  @param socket Connection to the server, from connect_to_server().
+ *  @param request_id ID for the request, if the server should keep the connection open so that
+ *  it can be used for more frames.  In this case the server must support keep-alive, and the
+ *  result must be read using receive_from_server_with_id().
+ *  @param end_of_batch true if this is the last frame that we will send before reading the results;
+ *  only used if request_id is set.  The server encodes all the frames in a batch in parallel and
+ *  sends them back as they are finished.
+ */
+void
+DCPVideo::send_to_server(EncodeServerDescription serv, shared_ptr<Socket> socket, optional<int> request_id, bool end_of_batch) const
+{
+	DCPOMATIC_ASSERT(!request_id || serv.keep_alive());
+
 	/* Collect all XML metadata */
 	xmlpp::Document doc;
 	auto root = doc.create_root_node ("EncodingRequest");
 	cxml::add_text_child(root, "Version", fmt::to_string(SERVER_LINK_VERSION));
+	auto const compress = serv.image_compression() && Config::instance()->compress_images_to_servers();
+	if (compress) {
+		cxml::add_text_child(root, "ImageCompression", "FFV1");
+	}
+	socket->set_compress_images(compress);
+	if (request_id) {
+		cxml::add_text_child(root, "KeepAlive", "1");
+		cxml::add_text_child(root, "RequestID", fmt::to_string(*request_id));
+		cxml::add_text_child(root, "EndOfBatch", end_of_batch ? "1" : "0");
+	}
 	add_metadata (root);
 
 	LOG_DEBUG_ENCODE (N_("Sending frame %1 to remote"), _index);
 
-	{
-		Socket::WriteDigestScope ds (socket);
+	Socket::WriteDigestScope ds (socket);
+	TraceSpan span("DCPVideo::encode_remotely send", _index);
 
-		/* Send XML metadata */
-		auto xml = doc.write_to_string ("UTF-8");
-		socket->write(xml.bytes() + 1);
-		socket->write ((uint8_t *) xml.c_str(), xml.bytes() + 1);
+	/* Send XML metadata */
+	auto xml = doc.write_to_string ("UTF-8");
+	socket->write(xml.bytes() + 1);
+	socket->write ((uint8_t *) xml.c_str(), xml.bytes() + 1);
+
+	/* Send binary data */
+	LOG_TIMING("start-remote-send thread=%1", thread_id ());
+	_frame->write_to_socket (socket);
+}
+
+
+/** Read the response to a frame which was sent with send_to_server() without a request ID.
+ *  This blocks until the data is ready and sent back.
+ *  @return JPEG2000-encoded data.
+ */
+ArrayData
+DCPVideo::receive_from_server(shared_ptr<Socket> socket)
+{
+	return receive_from_server(socket, nullptr);
+}
 
-		/* Send binary data */
-		LOG_TIMING("start-remote-send thread=%1", thread_id ());
-		_frame->write_to_socket (socket);
-	}
 
-	/* Read the response (JPEG2000-encoded data); this blocks until the data
-	   is ready and sent back.
-	*/
+/** Read the response to one of the frames which were sent with send_to_server() with a request ID.
+ *  This blocks until some data is ready and sent back.
+ *  @return Request ID and JPEG2000-encoded data.
+ */
+std::pair<int, ArrayData>
+DCPVideo::receive_from_server_with_id(shared_ptr<Socket> socket)
+{
+	optional<int> request_id;
+	auto encoded = receive_from_server(socket, &request_id);
+	DCPOMATIC_ASSERT(request_id);
+	return { *request_id, encoded };
+}
+
+
+ArrayData
+DCPVideo::receive_from_server(shared_ptr<Socket> socket, optional<int>* request_id)
+{
 	Socket::ReadDigestScope ds (socket);
 	LOG_TIMING("start-remote-encode thread=%1", thread_id ());
-	ArrayData e (socket->read_uint32 ());
+	uint32_t size = 0;
+	{
+		TraceSpan span("DCPVideo::encode_remotely wait");
+		if (request_id) {
+			*request_id = socket->read_uint32();
+		}
+		size = socket->read_uint32 ();
+	}
+	ArrayData e (size);
 	LOG_TIMING("start-remote-receive thread=%1", thread_id ());
-	socket->read (e.data(), e.size());
+	{
+		TraceSpan span("DCPVideo::encode_remotely receive");
+		socket->read (e.data(), e.size());
+	}
 	LOG_TIMING("finish-remote-receive thread=%1", thread_id ());
 	if (!ds.check()) {
 		throw NetworkError ("Checksums do not match");
 	}
 
-	LOG_DEBUG_ENCODE (N_("Finished remotely-encoded frame %1"), _index);
-
 	return e;
 }
 
@@ -26,6 +26,8 @@
 #include <libcxml/cxml.h>
 #include <dcp/array_data.h>
 #include <dcp/openjpeg_image.h>
+#include <boost/optional.hpp>
+#include <utility>
 
 
 /** @file  src/dcp_video_frame.h
@@ -35,6 +37,7 @@
 
 class Log;
 class PlayerVideo;
+class Socket;
 
 
 /** @class DCPVideo
@@ -58,6 +61,12 @@ public:
 	dcp::ArrayData encode_locally () const;
 	dcp::ArrayData encode_remotely (EncodeServerDescription, int timeout = 30) const;
 
+	void send_to_server(EncodeServerDescription server, std::shared_ptr<Socket> socket, boost::optional<int> request_id, bool end_of_batch) const;
+	static dcp::ArrayData receive_from_server(std::shared_ptr<Socket> socket);
+	static std::pair<int, dcp::ArrayData> receive_from_server_with_id(std::shared_ptr<Socket> socket);
+
+	static std::shared_ptr<Socket> connect_to_server(EncodeServerDescription server, int timeout = 30);
+
 	int index () const {
 		return _index;
 	}
@@ -74,6 +83,7 @@ public:
 private:
 
 	void add_metadata (xmlpp::Element *) const;
+	static dcp::ArrayData receive_from_server(std::shared_ptr<Socket> socket, boost::optional<int>* request_id);
 
 	std::shared_ptr<const PlayerVideo> _frame;
 	int _index;			 ///< frame index within the DCP's intrinsic duration
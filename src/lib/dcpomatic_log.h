@@ -27,23 +27,30 @@
 extern std::shared_ptr<Log> dcpomatic_log;
 
 
-#define LOG_GENERAL(...)      dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_GENERAL);
-#define LOG_GENERAL_NC(...)   dcpomatic_log->log(__VA_ARGS__, LogEntry::TYPE_GENERAL);
-#define LOG_ERROR(...)        dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_ERROR);
-#define LOG_ERROR_NC(...)     dcpomatic_log->log(__VA_ARGS__, LogEntry::TYPE_ERROR);
-#define LOG_WARNING(...)      dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_WARNING);
-#define LOG_WARNING_NC(...)   dcpomatic_log->log(__VA_ARGS__, LogEntry::TYPE_WARNING);
-#define LOG_TIMING(...)       dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_TIMING);
-#define LOG_DEBUG_ENCODE(...) dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_DEBUG_ENCODE);
-#define LOG_DEBUG_VIDEO_VIEW(...) dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_DEBUG_VIDEO_VIEW);
-#define LOG_DEBUG_THREE_D(...) dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_DEBUG_THREE_D);
-#define LOG_DEBUG_THREE_D_NC(...) dcpomatic_log->log(__VA_ARGS__, LogEntry::TYPE_DEBUG_THREE_D);
-#define LOG_DISK(...)         dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_DISK);
-#define LOG_DISK_NC(...)      dcpomatic_log->log(__VA_ARGS__, LogEntry::TYPE_DISK);
-#define LOG_DEBUG_PLAYER(...)    dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_DEBUG_PLAYER);
-#define LOG_DEBUG_PLAYER_NC(...) dcpomatic_log->log(__VA_ARGS__, LogEntry::TYPE_DEBUG_PLAYER);
-#define LOG_DEBUG_AUDIO_ANALYSIS(...)    dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_DEBUG_AUDIO_ANALYSIS);
-#define LOG_DEBUG_AUDIO_ANALYSIS_NC(...) dcpomatic_log->log(__VA_ARGS__, LogEntry::TYPE_DEBUG_AUDIO_ANALYSIS);
-#define LOG_HTTP(...)         dcpomatic_log->log(String::compose(__VA_ARGS__), LogEntry::TYPE_HTTP);
-#define LOG_HTTP_NC(...)      dcpomatic_log->log(__VA_ARGS__, LogEntry::TYPE_HTTP);
+/* These check whether the log type is enabled before doing anything, so that
+ * disabled types do not cost a String::compose.
+ */
+#define DCPOMATIC_LOG(type, ...) do { if (dcpomatic_log->types() & (type)) { dcpomatic_log->log(String::compose(__VA_ARGS__), (type)); } } while (false)
+#define DCPOMATIC_LOG_NC(type, ...) do { if (dcpomatic_log->types() & (type)) { dcpomatic_log->log(__VA_ARGS__, (type)); } } while (false)
+
+
+#define LOG_GENERAL(...)      DCPOMATIC_LOG(LogEntry::TYPE_GENERAL, __VA_ARGS__)
+#define LOG_GENERAL_NC(...)   DCPOMATIC_LOG_NC(LogEntry::TYPE_GENERAL, __VA_ARGS__)
+#define LOG_ERROR(...)        DCPOMATIC_LOG(LogEntry::TYPE_ERROR, __VA_ARGS__)
+#define LOG_ERROR_NC(...)     DCPOMATIC_LOG_NC(LogEntry::TYPE_ERROR, __VA_ARGS__)
+#define LOG_WARNING(...)      DCPOMATIC_LOG(LogEntry::TYPE_WARNING, __VA_ARGS__)
+#define LOG_WARNING_NC(...)   DCPOMATIC_LOG_NC(LogEntry::TYPE_WARNING, __VA_ARGS__)
+#define LOG_TIMING(...)       DCPOMATIC_LOG(LogEntry::TYPE_TIMING, __VA_ARGS__)
+#define LOG_DEBUG_ENCODE(...) DCPOMATIC_LOG(LogEntry::TYPE_DEBUG_ENCODE, __VA_ARGS__)
+#define LOG_DEBUG_VIDEO_VIEW(...) DCPOMATIC_LOG(LogEntry::TYPE_DEBUG_VIDEO_VIEW, __VA_ARGS__)
+#define LOG_DEBUG_THREE_D(...) DCPOMATIC_LOG(LogEntry::TYPE_DEBUG_THREE_D, __VA_ARGS__)
+#define LOG_DEBUG_THREE_D_NC(...) DCPOMATIC_LOG_NC(LogEntry::TYPE_DEBUG_THREE_D, __VA_ARGS__)
+#define LOG_DISK(...)         DCPOMATIC_LOG(LogEntry::TYPE_DISK, __VA_ARGS__)
+#define LOG_DISK_NC(...)      DCPOMATIC_LOG_NC(LogEntry::TYPE_DISK, __VA_ARGS__)
+#define LOG_DEBUG_PLAYER(...)    DCPOMATIC_LOG(LogEntry::TYPE_DEBUG_PLAYER, __VA_ARGS__)
+#define LOG_DEBUG_PLAYER_NC(...) DCPOMATIC_LOG_NC(LogEntry::TYPE_DEBUG_PLAYER, __VA_ARGS__)
+#define LOG_DEBUG_AUDIO_ANALYSIS(...)    DCPOMATIC_LOG(LogEntry::TYPE_DEBUG_AUDIO_ANALYSIS, __VA_ARGS__)
+#define LOG_DEBUG_AUDIO_ANALYSIS_NC(...) DCPOMATIC_LOG_NC(LogEntry::TYPE_DEBUG_AUDIO_ANALYSIS, __VA_ARGS__)
+#define LOG_HTTP(...)         DCPOMATIC_LOG(LogEntry::TYPE_HTTP, __VA_ARGS__)
+#define LOG_HTTP_NC(...)      DCPOMATIC_LOG_NC(LogEntry::TYPE_HTTP, __VA_ARGS__)
 
@@ -31,7 +31,9 @@
 #include "i18n.h"
 
 
+using std::pair;
 using std::shared_ptr;
+using std::vector;
 using std::weak_ptr;
 
 
@@ -114,6 +116,41 @@ Socket::write (uint8_t const * data, int size)
 }
 
 
+/** Blocking write of a set of buffers, one after the other.  This is much quicker
+ *  than calling write() for each buffer as it avoids a trip through the io_service
+ *  (and possibly a system call) per buffer.
+ *  @param buffers Buffers to write, as pairs of (data, size).
+ */
+void
+Socket::write(vector<pair<uint8_t const*, int>> const& buffers)
+{
+	vector<boost::asio::const_buffer> asio_buffers;
+	asio_buffers.reserve(buffers.size());
+	for (auto const& buffer: buffers) {
+		asio_buffers.push_back(boost::asio::buffer(buffer.first, buffer.second));
+	}
+
+	set_deadline_from_now(_timeout);
+	boost::system::error_code ec = boost::asio::error::would_block;
+
+	boost::asio::async_write(_socket, asio_buffers, boost::lambda::var(ec) = boost::lambda::_1);
+
+	do {
+		_io_service.run_one();
+	} while (ec == boost::asio::error::would_block);
+
+	if (ec) {
+		throw NetworkError(String::compose(_("error during async_write (%1)"), ec.value()));
+	}
+
+	if (_write_digester) {
+		for (auto const& buffer: buffers) {
+			_write_digester->add(buffer.first, static_cast<size_t>(buffer.second));
+		}
+	}
+}
+
+
 void
 Socket::write(std::string const& str)
 {
@@ -155,6 +192,39 @@ Socket::read (uint8_t* data, int size)
 }
 
 
+/** Blocking read into a set of buffers, one after the other.
+ *  @param buffers Buffers to read to, as pairs of (data, size).
+ */
+void
+Socket::read(vector<pair<uint8_t*, int>> const& buffers)
+{
+	vector<boost::asio::mutable_buffer> asio_buffers;
+	asio_buffers.reserve(buffers.size());
+	for (auto const& buffer: buffers) {
+		asio_buffers.push_back(boost::asio::buffer(buffer.first, buffer.second));
+	}
+
+	set_deadline_from_now(_timeout);
+	boost::system::error_code ec = boost::asio::error::would_block;
+
+	boost::asio::async_read(_socket, asio_buffers, boost::lambda::var(ec) = boost::lambda::_1);
+
+	do {
+		_io_service.run_one();
+	} while (ec == boost::asio::error::would_block);
+
+	if (ec) {
+		throw NetworkError(String::compose(_("error during async_read (%1)"), ec.value()));
+	}
+
+	if (_read_digester) {
+		for (auto const& buffer: buffers) {
+			_read_digester->add(buffer.first, static_cast<size_t>(buffer.second));
+		}
+	}
+}
+
+
 uint32_t
 Socket::read_uint32 ()
 {
@@ -285,3 +355,13 @@ Socket::close()
 	_socket.close();
 }
 
+
+/** Close the socket from a thread other than the one which is using it; any read or
+ *  write which is in progress, or which is started later, will fail.
+ */
+void
+Socket::cancel()
+{
+	_io_service.post(boost::bind(&Socket::close, this));
+}
+
@@ -21,6 +21,8 @@
 #include "digester.h"
 #include <boost/asio.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <utility>
+#include <vector>
 
 /** @class Socket
  *  @brief A class to wrap a boost::asio::ip::tcp::socket with some things
@@ -48,18 +50,30 @@ public:
 	void write (uint32_t n);
 	void write (uint8_t const * data, int size);
 	void write(std::string const& str);
+	void write(std::vector<std::pair<uint8_t const*, int>> const& buffers);
 
 	void read (uint8_t* data, int size);
+	void read(std::vector<std::pair<uint8_t*, int>> const& buffers);
 	uint32_t read_uint32 ();
 
 	void set_deadline_from_now(int seconds);
 	void run();
 	void close();
+	void cancel();
 
 	bool is_open() const {
 		return _socket.is_open();
 	}
 
+	/** @param c true if Images sent or received on this socket should be losslessly compressed */
+	void set_compress_images(bool c) {
+		_compress_images = c;
+	}
+
+	bool compress_images() const {
+		return _compress_images;
+	}
+
 	class ReadDigestScope
 	{
 	public:
@@ -98,4 +112,5 @@ private:
 	boost::scoped_ptr<Digester> _read_digester;
 	boost::scoped_ptr<Digester> _write_digester;
 	boost::optional<int> _send_buffer_size;
+	bool _compress_images = false;
 };
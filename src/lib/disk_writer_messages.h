@@ -46,8 +46,10 @@ class Nanomsg;
 // Front-end sends:
 
 #define DISK_WRITER_WRITE "W"
-// DCP pathname
 // Internal name of the drive to write to
+// Number of 16MB buffers to use when copying (between 2 and 64)
+// DCP pathnames, one per line
+// Empty line
 
 // Back-end responds:
 
@@ -34,12 +34,17 @@
 #include "dcpomatic_socket.h"
 #include "encode_server.h"
 #include "encoded_log_entry.h"
+#include "exceptions.h"
+#include "film.h"
 #include "image.h"
 #include "log.h"
 #include "player_video.h"
+#include "reel_encoder.h"
+#include "scoped_temporary.h"
 #include "util.h"
 #include "variant.h"
 #include "version.h"
+#include <dcp/filesystem.h>
 #include <dcp/warnings.h>
 #include <libcxml/cxml.h>
 LIBDCP_DISABLE_WARNINGS
@@ -51,6 +56,7 @@ LIBDCP_ENABLE_WARNINGS
 #ifdef HAVE_VALGRIND_H
 #include <valgrind/memcheck.h>
 #endif
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -72,9 +78,15 @@ using boost::scoped_array;
 using boost::optional;
 using dcp::ArrayData;
 using dcp::Size;
+using namespace dcpomatic;
 
 
-EncodeServer::EncodeServer (bool verbose, int num_threads)
+/** @param verbose true to write information about what we are doing to stdout.
+ *  @param num_threads Number of threads to use for encoding.
+ *  @param reel_encoding true to accept requests to encode whole reels.  A master which asks for this
+ *  can make us read files from, and write assets into, any film directory that we can see.
+ */
+EncodeServer::EncodeServer (bool verbose, int num_threads, bool reel_encoding)
 #if !defined(RUNNING_ON_VALGRIND) || RUNNING_ON_VALGRIND == 0
 	: Server (ENCODE_FRAME_PORT)
 #else
@@ -82,6 +94,7 @@ EncodeServer::EncodeServer (bool verbose, int num_threads)
 #endif
 	, _verbose (verbose)
 	, _num_threads (num_threads)
+	, _reel_encoding (reel_encoding)
 	, _frames_encoded(0)
 {
 
@@ -92,17 +105,28 @@ EncodeServer::~EncodeServer ()
 {
 	boost::this_thread::disable_interruption dis;
 
+	list<shared_ptr<Connection>> connections;
+
 	{
 		boost::mutex::scoped_lock lm (_mutex);
 		_terminate = true;
 		_empty_condition.notify_all ();
 		_full_condition.notify_all ();
+		_encoded_condition.notify_all ();
+		connections = _connections;
 	}
 
 	try {
 		_worker_threads.join_all ();
 	} catch (...) {}
 
+	/* Connection threads will stop when they next wait for a worker, or when their masters close the connection */
+	for (auto connection: connections) {
+		try {
+			connection->thread.join();
+		} catch (...) {}
+	}
+
 	{
 		boost::mutex::scoped_lock lm (_broadcast.mutex);
 		if (_broadcast.socket) {
@@ -119,16 +143,23 @@ EncodeServer::~EncodeServer ()
 }
 
 
-/** @param after_read Filled in with gettimeofday() after reading the input from the network.
- *  @param after_encode Filled in with gettimeofday() after encoding the image.
+/** Read a request from a master.  A ReelEncodingRequest will be dealt with here.
+ *  @param keep_alive Filled in with true if the master wants to send more frames using this socket.
+ *  @param end_of_batch Filled in with true if the master will wait for the results of the frames that
+ *  it has sent before it sends any more.
+ *  @return Frame to encode, or nullptr if there is nothing more to do with this socket.
  */
-int
-EncodeServer::process (shared_ptr<Socket> socket, struct timeval& after_read, struct timeval& after_encode)
+shared_ptr<EncodeServer::Request>
+EncodeServer::read_request(shared_ptr<Socket> socket, bool& keep_alive, bool& end_of_batch)
 {
+	struct timeval start;
+	gettimeofday(&start, 0);
+
 	Socket::ReadDigestScope ds (socket);
 
+	/* Only a request to encode a reel can be larger than MAX_ENCODE_REQUEST_SIZE; we check that this was one below */
 	auto length = socket->read_uint32 ();
-	if (length > 65536) {
+	if (length > (_reel_encoding ? MAX_REEL_ENCODE_REQUEST_SIZE : MAX_ENCODE_REQUEST_SIZE)) {
 		throw NetworkError("Malformed encode request (too large)");
 	}
 
@@ -136,7 +167,8 @@ EncodeServer::process (shared_ptr<Socket> socket, struct timeval& after_read, st
 	socket->read (reinterpret_cast<uint8_t*>(buffer.get()), length);
 
 	string s (buffer.get());
-	auto xml = make_shared<cxml::Document>("EncodingRequest");
+	/* This will be an EncodingRequest for a single frame or a ReelEncodingRequest */
+	auto xml = make_shared<cxml::Document>();
 	xml->read_string (s);
 	/* This is a double-check; the server shouldn't even be on the candidate list
 	   if it is the wrong version, but it doesn't hurt to make sure here.
@@ -144,7 +176,32 @@ EncodeServer::process (shared_ptr<Socket> socket, struct timeval& after_read, st
 	if (xml->number_child<int> ("Version") != SERVER_LINK_VERSION) {
 		cerr << "Mismatched server/client versions\n";
 		LOG_ERROR_NC ("Mismatched server/client versions");
-		return -1;
+		return {};
+	}
+
+	if (xml->name() == "ReelEncodingRequest") {
+		if (!_reel_encoding) {
+			throw NetworkError("Reel encoding request, but reel encoding is not enabled");
+		}
+		if (!ds.check()) {
+			throw NetworkError ("Checksums do not match");
+		}
+		process_reel (socket, xml);
+		return {};
+	} else if (xml->name() != "EncodingRequest") {
+		throw NetworkError("Malformed encode request (unknown type)");
+	} else if (length > MAX_ENCODE_REQUEST_SIZE) {
+		throw NetworkError("Malformed encode request (too large)");
+	}
+
+	socket->set_compress_images(xml->optional_string_child("ImageCompression").get_value_or("") == "FFV1");
+	keep_alive = xml->optional_bool_child("KeepAlive").get_value_or(false);
+	optional<int> id;
+	if (keep_alive) {
+		id = xml->number_child<int>("RequestID");
+		end_of_batch = xml->optional_bool_child("EndOfBatch").get_value_or(true);
+	} else {
+		end_of_batch = true;
 	}
 
 	auto pvf = make_shared<PlayerVideo>(xml, socket);
@@ -153,27 +210,76 @@ EncodeServer::process (shared_ptr<Socket> socket, struct timeval& after_read, st
 		throw NetworkError ("Checksums do not match");
 	}
 
-	DCPVideo dcp_video_frame (pvf, xml);
-
-	gettimeofday (&after_read, 0);
+	auto request = make_shared<Request>(DCPVideo(pvf, xml), id);
+	request->start = start;
+	gettimeofday(&request->after_read, 0);
+	return request;
+}
 
-	auto encoded = dcp_video_frame.encode_locally ();
 
-	gettimeofday (&after_encode, 0);
+/** Encode the picture asset for a period of a film, reading the content and writing the asset on storage
+ *  which we share with the master.  While we are working we send the number of frames that have been written
+ *  after each one; then we send REEL_ENCODING_FINISHED followed by a ReelEncodingResponse.
+ *
+ *  We only write into a remote_reels directory which the master has already made in its film's directory,
+ *  and we choose the names of the files that we write there ourselves, so the master cannot make us write
+ *  anywhere else.
+ */
+void
+EncodeServer::process_reel (shared_ptr<Socket> socket, shared_ptr<const cxml::Document> request)
+{
+	optional<string> error;
 
 	try {
-		Socket::WriteDigestScope ds (socket);
-		socket->write (encoded.size());
-		socket->write (encoded.data(), encoded.size());
+		ScopedTemporary metadata;
+		dcp::write_string_to_file(request->string_child("Film"), metadata.path());
+		auto film = make_shared<Film>(optional<boost::filesystem::path>());
+		film->read_metadata(metadata.path());
+		if (film->encrypted()) {
+			throw EncodeError("Encrypted films cannot be encoded on servers");
+		}
+
+		boost::filesystem::path const directory = request->string_child("Directory");
+		auto const output = directory / "remote_reels";
+		if (!directory.is_absolute() || !dcp::filesystem::is_directory(output)) {
+			throw EncodeError(fmt::format("{} is not a film directory which is ready for reel encoding", directory.string()));
+		}
+
+		auto const reel = request->number_child<int>("Reel");
+		if (reel < 0) {
+			throw EncodeError("Malformed reel encoding request (bad reel index)");
+		}
+
+		DCPTimePeriod const period(
+			DCPTime(request->number_child<DCPTime::Type>("From")), DCPTime(request->number_child<DCPTime::Type>("To"))
+			);
+
+		if (_verbose) {
+			cout << "Encoding " << to_string(period) << " of " << film->name() << "\n";
+		}
+		LOG_GENERAL("Encoding %1 of %2", to_string(period), film->name());
+
+		ReelEncoder encoder(film, period, _num_threads);
+		encoder.encode(output / fmt::format("{}.mxf", reel), output / fmt::format("{}.info", reel), [this, socket](Frame frames) {
+			socket->write(static_cast<uint32_t>(frames));
+			++_frames_encoded;
+		});
 	} catch (std::exception& e) {
-		cerr << "Send failed; frame " << dcp_video_frame.index() << "\n";
-		LOG_ERROR ("Send failed; frame %1", dcp_video_frame.index());
-		throw;
+		cerr << "Reel encoding failed: " << e.what() << "\n";
+		LOG_ERROR("Reel encoding failed: %1", e.what());
+		error = e.what();
 	}
 
-	++_frames_encoded;
+	xmlpp::Document doc;
+	auto root = doc.create_root_node("ReelEncodingResponse");
+	if (error) {
+		cxml::add_text_child(root, "Error", *error);
+	}
 
-	return dcp_video_frame.index ();
+	auto xml = doc.write_to_string("UTF-8");
+	socket->write(static_cast<uint32_t>(REEL_ENCODING_FINISHED));
+	socket->write(xml.bytes() + 1);
+	socket->write(reinterpret_cast<uint8_t const*>(xml.c_str()), xml.bytes() + 1);
 }
 
 
@@ -190,55 +296,130 @@ EncodeServer::worker_thread ()
 			return;
 		}
 
-		auto socket = _queue.front ();
+		auto request = _queue.front ();
 		_queue.pop_front ();
+		_full_condition.notify_all ();
 
 		lock.unlock ();
 
-		int frame = -1;
-		string ip;
-
-		struct timeval start;
-		struct timeval after_read;
-		struct timeval after_encode;
-		struct timeval end;
-
-		gettimeofday (&start, 0);
-
+		optional<dcp::ArrayData> encoded;
+		optional<string> error;
 		try {
-			frame = process (socket, after_read, after_encode);
-			ip = socket->socket().remote_endpoint().address().to_string();
+			encoded = request->video.encode_locally();
 		} catch (std::exception& e) {
-			cerr << "Error: " << e.what() << "\n";
-			LOG_ERROR ("Error: %1", e.what());
+			error = e.what();
 		}
 
-		gettimeofday (&end, 0);
-
-		socket.reset ();
-
 		lock.lock ();
+		request->encoded = encoded;
+		request->error = error;
+		gettimeofday (&request->after_encode, 0);
+		_encoded_condition.notify_all ();
+	}
+}
+
 
-		if (frame >= 0) {
-			struct timeval end;
-			gettimeofday (&end, 0);
+/** Read requests from a connection, give them to the workers, and send the results back */
+void
+EncodeServer::connection_thread(shared_ptr<Connection> connection)
+{
+	start_of_thread("EncodeServerConnection");
 
-			auto e = make_shared<EncodedLogEntry>(
-				frame, ip,
-				seconds(after_read) - seconds(start),
-				seconds(after_encode) - seconds(after_read),
-				seconds(end) - seconds(after_encode)
-				);
+	auto socket = connection->socket;
 
-			if (_verbose) {
-				cout << e->get() << "\n";
+	try {
+		bool keep_alive = true;
+		while (keep_alive) {
+			/* Read a batch of requests, giving each one to the workers as soon as we have it */
+			list<shared_ptr<Request>> batch;
+			bool end_of_batch = false;
+			while (!end_of_batch) {
+				auto request = read_request(socket, keep_alive, end_of_batch);
+				if (!request) {
+					keep_alive = false;
+					break;
+				}
+
+				boost::mutex::scoped_lock lock (_mutex);
+				_waker.nudge ();
+
+				/* Wait until the queue has gone down a bit */
+				while (_queue.size() >= _worker_threads.size() * 2 && !_terminate) {
+					_full_condition.wait (lock);
+				}
+
+				if (_terminate) {
+					return;
+				}
+
+				_queue.push_back (request);
+				_empty_condition.notify_all ();
+				batch.push_back (request);
 			}
 
-			dcpomatic_log->log (e);
+			/* Send the results back as they are finished */
+			while (!batch.empty()) {
+				shared_ptr<Request> request;
+				{
+					boost::mutex::scoped_lock lock (_mutex);
+					while (!_terminate) {
+						auto iter = std::find_if(batch.begin(), batch.end(), [](shared_ptr<Request> r) { return r->encoded || r->error; });
+						if (iter != batch.end()) {
+							request = *iter;
+							batch.erase(iter);
+							break;
+						}
+						_encoded_condition.wait (lock);
+					}
+
+					if (_terminate) {
+						return;
+					}
+				}
+
+				if (request->error) {
+					throw EncodeError(*request->error);
+				}
+
+				try {
+					Socket::WriteDigestScope ds (socket);
+					if (request->id) {
+						socket->write(static_cast<uint32_t>(*request->id));
+					}
+					socket->write (request->encoded->size());
+					socket->write (request->encoded->data(), request->encoded->size());
+				} catch (std::exception& e) {
+					cerr << "Send failed; frame " << request->video.index() << "\n";
+					LOG_ERROR ("Send failed; frame %1", request->video.index());
+					throw;
+				}
+
+				++_frames_encoded;
+
+				struct timeval end;
+				gettimeofday (&end, 0);
+
+				auto e = make_shared<EncodedLogEntry>(
+					request->video.index(), connection->ip,
+					seconds(request->after_read) - seconds(request->start),
+					seconds(request->after_encode) - seconds(request->after_read),
+					seconds(end) - seconds(request->after_encode)
+					);
+
+				if (_verbose) {
+					cout << e->get() << "\n";
+				}
+
+				dcpomatic_log->log (e);
+			}
 		}
-
-		_full_condition.notify_all ();
+	} catch (std::exception& e) {
+		cerr << "Error: " << e.what() << "\n";
+		LOG_ERROR ("Error: %1", e.what());
 	}
+
+	boost::mutex::scoped_lock lock (_mutex);
+	connection->finished = true;
 }
 
 
@@ -301,6 +482,11 @@ EncodeServer::broadcast_received ()
 		auto root = doc.create_root_node ("ServerAvailable");
 		cxml::add_text_child(root, "Threads", fmt::to_string(_worker_threads.size()));
 		cxml::add_text_child(root, "Version", fmt::to_string(SERVER_LINK_VERSION));
+		cxml::add_text_child(root, "ImageCompression", "FFV1");
+		cxml::add_text_child(root, "KeepAlive", "1");
+		if (_reel_encoding) {
+			cxml::add_text_child(root, "ReelEncoding", "1");
+		}
 		auto xml = doc.write_to_string ("UTF-8");
 
 		if (_verbose) {
@@ -339,15 +525,45 @@ EncodeServer::broadcast_received ()
 void
 EncodeServer::handle (shared_ptr<Socket> socket)
 {
+	string ip;
+	try {
+		ip = socket->socket().remote_endpoint().address().to_string();
+	} catch (...) {
+		/* The master has gone away already */
+		return;
+	}
+
 	boost::mutex::scoped_lock lock (_mutex);
 
-	_waker.nudge ();
+	if (_terminate) {
+		return;
+	}
 
-	/* Wait until the queue has gone down a bit */
-	while (_queue.size() >= _worker_threads.size() * 2 && !_terminate) {
-		_full_condition.wait (lock);
+	/* Tidy up connections which have finished */
+	for (auto i = _connections.begin(); i != _connections.end(); ) {
+		if ((*i)->finished) {
+			(*i)->thread.join();
+			i = _connections.erase(i);
+		} else {
+			++i;
+		}
 	}
 
-	_queue.push_back (socket);
-	_empty_condition.notify_all ();
+	/* A master should only need one connection for each of our workers, so don't let any one
+	 * have many more than that, as each costs us a thread.
+	 */
+	auto const from_this_master = std::count_if(_connections.begin(), _connections.end(), [ip](shared_ptr<Connection> c) { return c->ip == ip; });
+	if (from_this_master >= static_cast<int>(_worker_threads.size() * 2)) {
+		LOG_WARNING("Refusing connection from %1 as it already has %2 connections", ip, from_this_master);
+		return;
+	}
+
+	auto connection = make_shared<Connection>();
+	connection->socket = socket;
+	connection->ip = ip;
+	connection->thread = boost::thread(boost::bind(&EncodeServer::connection_thread, this, connection));
+#ifdef DCPOMATIC_LINUX
+	pthread_setname_np(connection->thread.native_handle(), "encode-server-connection");
+#endif
+	_connections.push_back(connection);
 }
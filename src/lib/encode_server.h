@@ -29,27 +29,41 @@
 
 
 #include "cross.h"
+#include "dcp_video.h"
 #include "exception_store.h"
 #include "server.h"
+#include <dcp/array_data.h>
 #include <boost/asio.hpp>
 #include <boost/atomic.hpp>
+#include <boost/optional.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/condition.hpp>
+#include <list>
 #include <string>
 
 
 class Log;
 class Socket;
 
+namespace cxml {
+	class Document;
+}
+
 
 /** @class EncodeServer
  *  @brief A class to run a server which can accept requests to perform JPEG2000
  *  encoding work.
+ *
+ *  Each connection from a master has a thread which reads requests and sends back
+ *  responses, and the frames that it reads are encoded by a pool of worker threads.
+ *  This means that a connection which a master keeps open between frames does not
+ *  tie up a worker while it is idle, and that the frames in a batch (see
+ *  DCPVideo::send_to_server()) can be encoded in parallel.
  */
 class EncodeServer : public Server, public ExceptionStore
 {
 public:
-	EncodeServer (bool verbose, int num_threads);
+	EncodeServer (bool verbose, int num_threads, bool reel_encoding = false);
 	~EncodeServer ();
 
 	void run () override;
@@ -59,18 +73,53 @@ public:
 	}
 
 private:
+	/** A frame that a master has asked us to encode */
+	struct Request
+	{
+		Request(DCPVideo video_, boost::optional<int> id_)
+			: video(video_)
+			, id(id_)
+		{}
+
+		DCPVideo video;
+		/** ID to send back with the encoded data, if the master gave one */
+		boost::optional<int> id;
+		boost::optional<dcp::ArrayData> encoded;
+		boost::optional<std::string> error;
+		struct timeval start;
+		struct timeval after_read;
+		struct timeval after_encode;
+	};
+
+	struct Connection
+	{
+		std::shared_ptr<Socket> socket;
+		std::string ip;
+		boost::thread thread;
+		/** true when thread has finished */
+		bool finished = false;
+	};
+
 	void handle (std::shared_ptr<Socket>) override;
 	void worker_thread ();
-	int process (std::shared_ptr<Socket> socket, struct timeval &, struct timeval &);
+	void connection_thread(std::shared_ptr<Connection> connection);
+	std::shared_ptr<Request> read_request(std::shared_ptr<Socket> socket, bool& keep_alive, bool& end_of_batch);
+	void process_reel (std::shared_ptr<Socket> socket, std::shared_ptr<const cxml::Document> request);
 	void broadcast_thread ();
 	void broadcast_received ();
 
 	boost::thread_group _worker_threads;
-	std::list<std::shared_ptr<Socket>> _queue;
+	/** Frames waiting to be encoded by a worker */
+	std::list<std::shared_ptr<Request>> _queue;
 	boost::condition _full_condition;
 	boost::condition _empty_condition;
+	/** Condition which is signalled when a worker has finished with a Request */
+	boost::condition _encoded_condition;
+	std::list<std::shared_ptr<Connection>> _connections;
 	bool _verbose;
 	int _num_threads;
+	/** true to accept requests to encode whole reels */
+	bool _reel_encoding;
 	Waker _waker;
 	boost::atomic<int> _frames_encoded;
 
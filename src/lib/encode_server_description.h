@@ -75,6 +75,35 @@ public:
 		_threads = t;
 	}
 
+	/** @return true if the server can receive losslessly-compressed images */
+	bool image_compression () const {
+		return _image_compression;
+	}
+
+	void set_image_compression (bool c) {
+		_image_compression = c;
+	}
+
+	/** @return true if the server can use one connection for many frames, which can be sent
+	 *  in batches with request IDs and are then encoded in parallel.
+	 */
+	bool keep_alive () const {
+		return _keep_alive;
+	}
+
+	void set_keep_alive (bool k) {
+		_keep_alive = k;
+	}
+
+	/** @return true if the server can encode whole reels of a film that it can see on shared storage */
+	bool reel_encoding () const {
+		return _reel_encoding;
+	}
+
+	void set_reel_encoding (bool r) {
+		_reel_encoding = r;
+	}
+
 	void set_seen () {
 		_last_seen = boost::posix_time::second_clock::local_time();
 	}
@@ -90,6 +119,9 @@ private:
 	int _threads;
 	/** server link (i.e. protocol) version number */
 	int _link_version;
+	bool _image_compression = false;
+	bool _keep_alive = false;
+	bool _reel_encoding = false;
 	boost::posix_time::ptime _last_seen;
 };
 
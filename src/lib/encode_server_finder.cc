@@ -258,6 +258,9 @@ EncodeServerFinder::handle_accept (boost::system::error_code ec)
 			i->set_seen();
 		} else {
 			EncodeServerDescription sd (ip, xml->number_child<int>("Threads"), xml->optional_number_child<int>("Version").get_value_or(0));
+			sd.set_image_compression(xml->optional_string_child("ImageCompression").get_value_or("") == "FFV1");
+			sd.set_keep_alive(xml->optional_bool_child("KeepAlive").get_value_or(false));
+			sd.set_reel_encoding(xml->optional_bool_child("ReelEncoding").get_value_or(false));
 			_servers.push_back (sd);
 			changed = true;
 		}
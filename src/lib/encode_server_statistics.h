@@ -0,0 +1,45 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef DCPOMATIC_ENCODE_SERVER_STATISTICS_H
+#define DCPOMATIC_ENCODE_SERVER_STATISTICS_H
+
+
+#include <boost/optional.hpp>
+#include <string>
+
+
+/** @struct EncodeServerStatistics
+ *  @brief Some numbers describing how well an encode server is doing for us.
+ */
+struct EncodeServerStatistics
+{
+	std::string host_name;
+	/** number of frames that the server has encoded */
+	int frames = 0;
+	/** mean time between sending a frame and receiving its encoded data, in seconds */
+	double latency = 0;
+	/** recent rate at which the server has been returning frames, in frames per second */
+	boost::optional<float> rate;
+};
+
+
+#endif
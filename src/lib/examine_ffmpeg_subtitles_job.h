@@ -32,6 +32,9 @@ public:
 	std::string name () const override;
 	std::string json_name () const override;
 	void run () override;
+	ResourceClass resource_class () const override {
+		return ResourceClass::IO;
+	}
 
 private:
 	std::shared_ptr<FFmpegContent> _content;
@@ -20,6 +20,7 @@
 
 
 #include "compose.hpp"
+#include "copy_pipeline.h"
 #include "cross.h"
 #include "dcpomatic_log.h"
 #include "digester.h"
@@ -109,7 +110,7 @@ set_timestamps_to_now (boost::filesystem::path path)
 
 static
 string
-write (boost::filesystem::path from, boost::filesystem::path to, uint64_t& total_remaining, uint64_t total, Nanomsg* nanomsg)
+write (boost::filesystem::path from, boost::filesystem::path to, uint64_t& total_remaining, uint64_t total, int buffers, Nanomsg* nanomsg)
 {
 	ext4_file out;
 	int r = ext4_fopen(&out, to.generic_string().c_str(), "wb");
@@ -123,52 +124,49 @@ write (boost::filesystem::path from, boost::filesystem::path to, uint64_t& total
 		throw CopyError(String::compose("Failed to open file %1", from.string()), 0);
 	}
 
-	std::vector<uint8_t> buffer(block_size);
-	Digester digester;
-
-	int progress_frequency = 1;
-	int progress_count = 0;
-	uint64_t remaining = file_size (from);
-	while (remaining > 0) {
-		uint64_t const this_time = min(remaining, block_size);
-		size_t read = in.read(buffer.data(), 1, this_time);
-		if (read != this_time) {
-			ext4_fclose (&out);
-			throw CopyError(String::compose("Short read; expected %1 but read %2", this_time, read), 0, ext4_blockdev_errno);
+	auto read = [&in](uint8_t* data, size_t size) {
+		size_t read = in.read(data, 1, size);
+		if (read != size) {
+			throw CopyError(String::compose("Short read; expected %1 but read %2", size, read), 0, ext4_blockdev_errno);
 		}
+	};
 
-		digester.add (buffer.data(), this_time);
-
+	auto write = [&out, &total_remaining, total, nanomsg](uint8_t const* data, size_t size) {
 		size_t written;
-		r = ext4_fwrite (&out, buffer.data(), this_time, &written);
+		int r = ext4_fwrite (&out, data, size, &written);
 		if (r != EOK) {
-			ext4_fclose (&out);
 			throw CopyError("Write failed", r, ext4_blockdev_errno);
 		}
-		if (written != this_time) {
-			ext4_fclose (&out);
-			throw CopyError(String::compose("Short write; expected %1 but wrote %2", this_time, written), 0, ext4_blockdev_errno);
+		if (written != size) {
+			throw CopyError(String::compose("Short write; expected %1 but wrote %2", size, written), 0, ext4_blockdev_errno);
 		}
-		remaining -= this_time;
-		total_remaining -= this_time;
+		total_remaining -= size;
 
-		++progress_count;
-		if ((progress_count % progress_frequency) == 0 && nanomsg) {
+		if (nanomsg) {
 			DiskWriterBackEndResponse::copy_progress(1 - float(total_remaining) / total).write_to_nanomsg(*nanomsg, SHORT_TIMEOUT);
 		}
+	};
+
+	string digest;
+	try {
+		CopyPipeline pipeline(file_size(from), buffers, block_size, read);
+		digest = pipeline.run(write);
+	} catch (...) {
+		ext4_fclose (&out);
+		throw;
 	}
 
 	ext4_fclose (&out);
 
 	set_timestamps_to_now (to);
 
-	return digester.get ();
+	return digest;
 }
 
 
 static
 string
-read (boost::filesystem::path from, boost::filesystem::path to, uint64_t& total_remaining, uint64_t total, Nanomsg* nanomsg)
+read (boost::filesystem::path from, boost::filesystem::path to, uint64_t& total_remaining, uint64_t total, int buffers, Nanomsg* nanomsg)
 {
 	ext4_file in;
 	LOG_DISK("Opening %1 for read", to.generic_string());
@@ -178,30 +176,33 @@ read (boost::filesystem::path from, boost::filesystem::path to, uint64_t& total_
 	}
 	LOG_DISK("Opened %1 for read", to.generic_string());
 
-	std::vector<uint8_t> buffer(block_size);
-	Digester digester;
-
-	uint64_t remaining = file_size (from);
-	while (remaining > 0) {
-		uint64_t const this_time = min(remaining, block_size);
+	auto read = [&in](uint8_t* data, size_t size) {
 		size_t read;
-		r = ext4_fread (&in, buffer.data(), this_time, &read);
-		if (read != this_time) {
-			ext4_fclose (&in);
-			throw VerifyError (String::compose("Short read; expected %1 but read %2", this_time, read), 0);
+		ext4_fread (&in, data, size, &read);
+		if (read != size) {
+			throw VerifyError (String::compose("Short read; expected %1 but read %2", size, read), 0);
 		}
+	};
 
-		digester.add (buffer.data(), this_time);
-		remaining -= this_time;
-		total_remaining -= this_time;
+	auto progress = [&total_remaining, total, nanomsg](uint8_t const*, size_t size) {
+		total_remaining -= size;
 		if (nanomsg) {
 			DiskWriterBackEndResponse::verify_progress(1 - float(total_remaining) / total).write_to_nanomsg(*nanomsg, SHORT_TIMEOUT);
 		}
+	};
+
+	string digest;
+	try {
+		CopyPipeline pipeline(file_size(from), buffers, block_size, read);
+		digest = pipeline.run(progress);
+	} catch (...) {
+		ext4_fclose (&in);
+		throw;
 	}
 
 	ext4_fclose (&in);
 
-	return digester.get ();
+	return digest;
 }
 
 
@@ -226,7 +227,7 @@ public:
  */
 static
 void
-copy (boost::filesystem::path from, boost::filesystem::path to, uint64_t& total_remaining, uint64_t total, vector<CopiedFile>& copied_files, Nanomsg* nanomsg)
+copy (boost::filesystem::path from, boost::filesystem::path to, uint64_t& total_remaining, uint64_t total, vector<CopiedFile>& copied_files, int buffers, Nanomsg* nanomsg)
 {
 	LOG_DISK ("Copy %1 -> %2", from.string(), to.generic_string());
 	from = dcp::filesystem::fix_long_path(from);
@@ -243,10 +244,10 @@ copy (boost::filesystem::path from, boost::filesystem::path to, uint64_t& total_
 		set_timestamps_to_now (cr);
 
 		for (auto i: directory_iterator(from)) {
-			copy (i.path(), cr, total_remaining, total, copied_files, nanomsg);
+			copy (i.path(), cr, total_remaining, total, copied_files, buffers, nanomsg);
 		}
 	} else {
-		string const write_digest = write (from, cr, total_remaining, total, nanomsg);
+		string const write_digest = write (from, cr, total_remaining, total, buffers, nanomsg);
 		LOG_DISK ("Wrote %1 %2 with %3", from.string(), cr.generic_string(), write_digest);
 		copied_files.push_back (CopiedFile(from, cr, write_digest));
 	}
@@ -255,11 +256,11 @@ copy (boost::filesystem::path from, boost::filesystem::path to, uint64_t& total_
 
 static
 void
-verify (vector<CopiedFile> const& copied_files, uint64_t total, Nanomsg* nanomsg)
+verify (vector<CopiedFile> const& copied_files, uint64_t total, int buffers, Nanomsg* nanomsg)
 {
 	uint64_t total_remaining = total;
 	for (auto const& i: copied_files) {
-		string const read_digest = read (i.from, i.to, total_remaining, total, nanomsg);
+		string const read_digest = read (i.from, i.to, total_remaining, total, buffers, nanomsg);
 		LOG_DISK ("Read %1 %2 was %3 on write, now %4", i.from.string(), i.to.generic_string(), i.write_digest, read_digest);
 		if (read_digest != i.write_digest) {
 			throw VerifyError ("Hash of written data is incorrect", 0);
@@ -280,9 +281,9 @@ format_progress (void* context, float progress)
 
 void
 #ifdef DCPOMATIC_WINDOWS
-dcpomatic::write (vector<boost::filesystem::path> dcp_paths, string device, string, Nanomsg* nanomsg)
+dcpomatic::write (vector<boost::filesystem::path> dcp_paths, string device, string, int buffers, Nanomsg* nanomsg)
 #else
-dcpomatic::write (vector<boost::filesystem::path> dcp_paths, string device, string posix_partition, Nanomsg* nanomsg)
+dcpomatic::write (vector<boost::filesystem::path> dcp_paths, string device, string posix_partition, int buffers, Nanomsg* nanomsg)
 #endif
 try
 {
@@ -398,7 +399,7 @@ try
 	uint64_t total_remaining = total_bytes;
 	vector<CopiedFile> copied_files;
 	for (auto dcp_path: dcp_paths) {
-		copy (dcp_path, "/mp", total_remaining, total_bytes, copied_files, nanomsg);
+		copy (dcp_path, "/mp", total_remaining, total_bytes, copied_files, buffers, nanomsg);
 	}
 
 	/* Unmount and re-mount to make sure the write has finished */
@@ -412,7 +413,7 @@ try
 	}
 	LOG_DISK_NC ("Re-mounted device");
 
-	verify (copied_files, total_bytes, nanomsg);
+	verify (copied_files, total_bytes, buffers, nanomsg);
 
 	r = ext4_umount("/mp/");
 	if (r != EOK) {
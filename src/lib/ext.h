@@ -29,7 +29,10 @@ class Nanomsg;
 namespace dcpomatic {
 
 
-extern void write (std::vector<boost::filesystem::path> dcp_paths, std::string device, std::string posix_partition, Nanomsg* nanomsg);
+/** Format a drive and copy some DCPs to it.
+ *  @param buffers Number of blocks of data that can be between being read and being written at once.
+ */
+extern void write (std::vector<boost::filesystem::path> dcp_paths, std::string device, std::string posix_partition, int buffers, Nanomsg* nanomsg);
 
 
 }
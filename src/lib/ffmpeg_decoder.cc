@@ -28,6 +28,7 @@
 #include "audio_content.h"
 #include "audio_decoder.h"
 #include "compose.hpp"
+#include "config.h"
 #include "dcpomatic_log.h"
 #include "exceptions.h"
 #include "ffmpeg_audio_stream.h"
@@ -42,9 +43,11 @@
 #include "raw_image_proxy.h"
 #include "text_content.h"
 #include "text_decoder.h"
+#include "trace.h"
 #include "util.h"
 #include "video_decoder.h"
 #include "video_filter_graph.h"
+#include <dcp/scope_guard.h>
 #include <dcp/text_string.h>
 #include <sub/ssa_reader.h>
 #include <sub/subtitle.h>
@@ -74,10 +77,17 @@ using dcp::Size;
 using namespace dcpomatic;
 
 
+/** Maximum number of video frames that the decode-ahead thread will queue */
+static int constexpr decode_ahead_video_frames = 4;
+/** Maximum number of things (video frames, blocks of audio and subtitle packets) that the decode-ahead thread will queue */
+static size_t constexpr decode_ahead_items = 64;
+
+
 FFmpegDecoder::FFmpegDecoder (shared_ptr<const Film> film, shared_ptr<const FFmpegContent> c, bool fast)
 	: FFmpeg (c)
 	, Decoder (film)
 	, _filter_graphs(c->filters(), dcp::Fraction(lrint(_ffmpeg_content->video_frame_rate().get_value_or(24) * 1000), 1000))
+	, _decode_ahead(Config::instance()->decode_ahead())
 {
 	if (c->video && c->video->use()) {
 		video = make_shared<VideoDecoder>(this, c);
@@ -103,6 +113,23 @@ FFmpegDecoder::FFmpegDecoder (shared_ptr<const Film> film, shared_ptr<const FFmp
 	for (auto i: c->ffmpeg_audio_streams()) {
 		_next_time[i] = boost::optional<dcpomatic::ContentTime>();
 	}
+
+	_packet = av_packet_alloc ();
+	if (!_packet) {
+		throw std::bad_alloc ();
+	}
+}
+
+
+FFmpegDecoder::~FFmpegDecoder ()
+{
+	stop_decode_ahead ();
+
+	for (auto packet: _ahead.spare_packets) {
+		av_packet_free (&packet);
+	}
+
+	av_packet_free (&_packet);
 }
 
 
@@ -210,10 +237,15 @@ FFmpegDecoder::flush_fill()
 bool
 FFmpegDecoder::pass ()
 {
-	auto packet = av_packet_alloc();
-	DCPOMATIC_ASSERT (packet);
+	if (_decode_ahead) {
+		return pass_ahead ();
+	}
 
-	int r = av_read_frame (_format_context, packet);
+	int r = 0;
+	{
+		TraceSpan span("FFmpegDecoder::read");
+		r = av_read_frame (_format_context, _packet);
+	}
 
 	/* AVERROR_INVALIDDATA can apparently be returned sometimes even when av_read_frame
 	   has pretty-much succeeded (and hence generated data which should be processed).
@@ -228,19 +260,93 @@ FFmpegDecoder::pass ()
 			LOG_ERROR (N_("error on av_read_frame (%1) (%2)"), &buf[0], r);
 		}
 
-		av_packet_free (&packet);
+		av_packet_unref (_packet);
 		return flush() == FlushResult::DONE;
 	}
 
-	int const si = packet->stream_index;
+	int const si = _packet->stream_index;
 	auto fc = _ffmpeg_content;
 
 	if (_video_stream && si == _video_stream.get() && video && !video->ignore()) {
-		decode_and_process_video_packet (packet);
+		TraceSpan span("FFmpegDecoder::decode_video");
+		decode_and_process_video_packet (_packet);
 	} else if (fc->subtitle_stream() && fc->subtitle_stream()->uses_index(_format_context, si) && !only_text()->ignore()) {
-		decode_and_process_subtitle_packet (packet);
+		decode_and_process_subtitle_packet (_packet);
 	} else if (audio) {
-		decode_and_process_audio_packet (packet);
+		TraceSpan span("FFmpegDecoder::decode_audio");
+		decode_and_process_audio_packet (_packet);
+	}
+
+	if (_have_current_subtitle && _current_subtitle_to && position() > *_current_subtitle_to) {
+		only_text()->emit_stop(*_current_subtitle_to);
+		_have_current_subtitle = false;
+	}
+
+	av_packet_unref (_packet);
+	return false;
+}
+
+
+/** Version of pass() for when we are decoding ahead; emit the next thing that the
+ *  decode-ahead thread has made, starting the thread if required.
+ */
+bool
+FFmpegDecoder::pass_ahead ()
+{
+	if (_flush_state != FlushState::CODECS) {
+		/* The decode-ahead thread has reached the end and flushed the codecs, so we can do the rest */
+		return flush() == FlushResult::DONE;
+	}
+
+	if (!_ahead.thread.joinable()) {
+		start_decode_ahead ();
+	}
+
+	AheadItem item;
+
+	{
+		boost::mutex::scoped_lock lm (_ahead_mutex);
+		while (_ahead.queue.empty() && !_ahead.died) {
+			TraceSpan span("FFmpegDecoder::pass wait");
+			_ahead.condition.wait (lm);
+		}
+
+		if (_ahead.queue.empty()) {
+			lm.unlock ();
+			rethrow ();
+			/* rethrow() only throws once, so carry on throwing something if we are called again */
+			throw std::runtime_error ("FFmpegDecoder decode-ahead thread died");
+		}
+
+		item = _ahead.queue.front ();
+		_ahead.queue.pop_front ();
+		if (item.type == AheadItem::Type::VIDEO) {
+			--_ahead.video;
+		}
+		_ahead.condition.notify_all ();
+	}
+
+	switch (item.type) {
+	case AheadItem::Type::VIDEO:
+		video->emit (film(), make_shared<RawImageProxy>(item.image), item.time);
+		break;
+	case AheadItem::Type::AUDIO:
+		audio->emit (film(), item.stream, item.audio, item.time);
+		break;
+	case AheadItem::Type::SUBTITLE:
+	{
+		dcp::ScopeGuard sg = [this, &item]() {
+			av_packet_unref (item.packet);
+			boost::mutex::scoped_lock lm (_ahead_mutex);
+			_ahead.spare_packets.push_back (item.packet);
+		};
+		decode_and_process_subtitle_packet (item.packet);
+		break;
+	}
+	case AheadItem::Type::END:
+		stop_decode_ahead ();
+		_flush_state = FlushState::AUDIO_DECODER;
+		return flush() == FlushResult::DONE;
 	}
 
 	if (_have_current_subtitle && _current_subtitle_to && position() > *_current_subtitle_to) {
@@ -248,11 +354,147 @@ FFmpegDecoder::pass ()
 		_have_current_subtitle = false;
 	}
 
-	av_packet_free (&packet);
 	return false;
 }
 
 
+/** Read packets, decoding video and audio and queueing the results for pass_ahead(), until
+ *  we are asked to stop or we reach the end of the file.
+ */
+void
+FFmpegDecoder::decode_ahead_thread ()
+try
+{
+	start_of_thread ("FFmpegDecoder");
+
+	auto const decode_video = _video_stream && video && !video->ignore();
+	auto const subtitle_stream = _ffmpeg_content->subtitle_stream();
+
+	while (true) {
+		{
+			boost::mutex::scoped_lock lm (_ahead_mutex);
+			while (!_ahead.stop && (_ahead.video >= decode_ahead_video_frames || _ahead.queue.size() >= decode_ahead_items)) {
+				_ahead.condition.wait (lm);
+			}
+			if (_ahead.stop) {
+				return;
+			}
+		}
+
+		int r = 0;
+		{
+			TraceSpan span("FFmpegDecoder::read");
+			r = av_read_frame (_format_context, _packet);
+		}
+
+		/* As in pass(), AVERROR_INVALIDDATA may still have given us some data */
+		if (r < 0 && r != AVERROR_INVALIDDATA) {
+			LOG_DEBUG_PLAYER("FFmpegDecoder::decode_ahead_thread flushes because av_read_frame returned %1", r);
+			if (r != AVERROR_EOF) {
+				char buf[256];
+				av_strerror (r, buf, sizeof(buf));
+				LOG_ERROR (N_("error on av_read_frame (%1) (%2)"), &buf[0], r);
+			}
+
+			av_packet_unref (_packet);
+
+			while (flush_codecs() == FlushResult::AGAIN) {}
+
+			boost::mutex::scoped_lock lm (_ahead_mutex);
+			_ahead.queue.push_back (AheadItem());
+			_ahead.condition.notify_all ();
+			return;
+		}
+
+		int const si = _packet->stream_index;
+
+		if (decode_video && si == _video_stream.get()) {
+			TraceSpan span("FFmpegDecoder::decode_video");
+			decode_and_process_video_packet (_packet);
+		} else if (subtitle_stream && subtitle_stream->uses_index(_format_context, si) && !only_text()->ignore()) {
+			/* Subtitles are decoded by pass_ahead() as they are cheap and their state is bound up with the emission */
+			AheadItem item;
+			item.type = AheadItem::Type::SUBTITLE;
+
+			boost::mutex::scoped_lock lm (_ahead_mutex);
+			if (_ahead.spare_packets.empty()) {
+				item.packet = av_packet_alloc ();
+				if (!item.packet) {
+					throw std::bad_alloc ();
+				}
+			} else {
+				item.packet = _ahead.spare_packets.back ();
+				_ahead.spare_packets.pop_back ();
+			}
+			av_packet_move_ref (item.packet, _packet);
+			_ahead.queue.push_back (item);
+			_ahead.condition.notify_all ();
+		} else if (audio) {
+			TraceSpan span("FFmpegDecoder::decode_audio");
+			decode_and_process_audio_packet (_packet);
+		}
+
+		av_packet_unref (_packet);
+	}
+}
+catch (...)
+{
+	store_current ();
+	boost::mutex::scoped_lock lm (_ahead_mutex);
+	_ahead.died = true;
+	_ahead.condition.notify_all ();
+}
+
+
+void
+FFmpegDecoder::start_decode_ahead ()
+{
+	{
+		boost::mutex::scoped_lock lm (_ahead_mutex);
+		_ahead.stop = false;
+		_ahead.died = false;
+	}
+
+	_ahead.thread = boost::thread (boost::bind(&FFmpegDecoder::decode_ahead_thread, this));
+#ifdef DCPOMATIC_LINUX
+	pthread_setname_np (_ahead.thread.native_handle(), "ffmpeg-decode");
+#endif
+}
+
+
+/** Stop the decode-ahead thread, if it is running, and throw away anything that it has queued */
+void
+FFmpegDecoder::stop_decode_ahead ()
+{
+	if (!_ahead.thread.joinable()) {
+		return;
+	}
+
+	{
+		boost::mutex::scoped_lock lm (_ahead_mutex);
+		_ahead.stop = true;
+		_ahead.condition.notify_all ();
+	}
+
+	{
+		boost::this_thread::disable_interruption dis;
+		try {
+			_ahead.thread.join ();
+		} catch (...) {}
+	}
+
+	boost::mutex::scoped_lock lm (_ahead_mutex);
+	for (auto const& item: _ahead.queue) {
+		if (item.packet) {
+			av_packet_unref (item.packet);
+			_ahead.spare_packets.push_back (item.packet);
+		}
+	}
+	_ahead.queue.clear ();
+	_ahead.video = 0;
+}
+
+
 /** @param data pointer to array of pointers to buffers.
  *  Only the first buffer will be used for non-planar data, otherwise there will be one per channel.
  */
@@ -399,6 +641,9 @@ FFmpegDecoder::bytes_per_audio_sample (shared_ptr<FFmpegAudioStream> stream) con
 void
 FFmpegDecoder::seek (ContentTime time, bool accurate)
 {
+	/* The decode-ahead thread (if there is one) will be started again by the next pass() */
+	stop_decode_ahead ();
+
 	Decoder::seek (time, accurate);
 
 	_flush_state = FlushState::CODECS;
@@ -538,11 +783,34 @@ FFmpegDecoder::process_audio_frame (shared_ptr<FFmpegAudioStream> stream)
 
 	/* Give this data provided there is some, and its time is sane */
 	if (ct >= ContentTime() && data->frames() > 0) {
-		audio->emit (film(), stream, data, ct);
+		give_audio (stream, data, ct);
 	}
 }
 
 
+/** Emit some audio or, if we are decoding ahead (and hence being called by the
+ *  decode-ahead thread), queue it for pass_ahead() to emit.
+ */
+void
+FFmpegDecoder::give_audio (shared_ptr<FFmpegAudioStream> stream, shared_ptr<AudioBuffers> data, ContentTime time)
+{
+	if (!_decode_ahead) {
+		audio->emit (film(), stream, data, time);
+		return;
+	}
+
+	AheadItem item;
+	item.type = AheadItem::Type::AUDIO;
+	item.time = time;
+	item.stream = stream;
+	item.audio = data;
+
+	boost::mutex::scoped_lock lm (_ahead_mutex);
+	_ahead.queue.push_back (item);
+	_ahead.condition.notify_all ();
+}
+
+
 void
 FFmpegDecoder::decode_and_process_audio_packet (AVPacket* packet)
 {
@@ -624,12 +892,7 @@ FFmpegDecoder::process_video_frame ()
 
 		if (i.second != AV_NOPTS_VALUE) {
 			double const pts = i.second * av_q2d(_format_context->streams[_video_stream.get()]->time_base) + _pts_offset.seconds();
-
-			video->emit (
-				film(),
-				make_shared<RawImageProxy>(image),
-				ContentTime::from_seconds(pts)
-				);
+			give_video (image, ContentTime::from_seconds(pts));
 		} else {
 			LOG_WARNING_NC ("Dropping frame without PTS");
 		}
@@ -637,6 +900,29 @@ FFmpegDecoder::process_video_frame ()
 }
 
 
+/** Emit a video frame or, if we are decoding ahead (and hence being called by the
+ *  decode-ahead thread), queue it for pass_ahead() to emit.
+ */
+void
+FFmpegDecoder::give_video (shared_ptr<const Image> image, ContentTime time)
+{
+	if (!_decode_ahead) {
+		video->emit (film(), make_shared<RawImageProxy>(image), time);
+		return;
+	}
+
+	AheadItem item;
+	item.type = AheadItem::Type::VIDEO;
+	item.time = time;
+	item.image = image;
+
+	boost::mutex::scoped_lock lm (_ahead_mutex);
+	_ahead.queue.push_back (item);
+	++_ahead.video;
+	_ahead.condition.notify_all ();
+}
+
+
 void
 FFmpegDecoder::decode_and_process_subtitle_packet (AVPacket* packet)
 {
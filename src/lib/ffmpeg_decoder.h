@@ -26,12 +26,17 @@
 
 #include "bitmap_text.h"
 #include "decoder.h"
+#include "exception_store.h"
 #include "ffmpeg.h"
 #include "video_filter_graph_set.h"
 extern "C" {
 #include <libavcodec/avcodec.h>
 }
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
 #include <boost/thread/mutex.hpp>
+#include <list>
+#include <vector>
 #include <stdint.h>
 
 
@@ -45,11 +50,19 @@ struct ffmpeg_pts_offset_test;
 
 /** @class FFmpegDecoder
  *  @brief A decoder using FFmpeg to decode content.
+ *
+ *  If Config::decode_ahead() is set, packets are read and video and audio are decoded (and video filtered)
+ *  on a separate thread, which puts the results into a queue.  pass() then takes the next thing from that
+ *  queue and emits it, so that the caller's thread does not have to wait for reading and decoding.
  */
-class FFmpegDecoder : public FFmpeg, public Decoder
+class FFmpegDecoder : public FFmpeg, public Decoder, public ExceptionStore
 {
 public:
 	FFmpegDecoder (std::shared_ptr<const Film> film, std::shared_ptr<const FFmpegContent>, bool fast);
+	~FFmpegDecoder ();
+
+	FFmpegDecoder (FFmpegDecoder const&) = delete;
+	FFmpegDecoder& operator= (FFmpegDecoder const&) = delete;
 
 	bool pass () override;
 	void seek (dcpomatic::ContentTime time, bool) override;
@@ -72,6 +85,14 @@ private:
 
 	void process_video_frame ();
 
+	void give_video (std::shared_ptr<const Image> image, dcpomatic::ContentTime time);
+	void give_audio (std::shared_ptr<FFmpegAudioStream> stream, std::shared_ptr<AudioBuffers> data, dcpomatic::ContentTime time);
+
+	bool pass_ahead ();
+	void decode_ahead_thread ();
+	void start_decode_ahead ();
+	void stop_decode_ahead ();
+
 	bool decode_and_process_video_packet (AVPacket* packet);
 	void decode_and_process_audio_packet (AVPacket* packet);
 	void decode_and_process_subtitle_packet (AVPacket* packet);
@@ -102,4 +123,49 @@ private:
 	};
 
 	FlushState _flush_state = FlushState::CODECS;
+
+	/** Packet which is re-used for each av_read_frame() */
+	AVPacket* _packet = nullptr;
+
+	/** Something that the decode-ahead thread has made, which pass_ahead() should emit */
+	struct AheadItem
+	{
+		enum class Type {
+			VIDEO,
+			AUDIO,
+			/** a subtitle packet, which is decoded by pass_ahead() */
+			SUBTITLE,
+			/** the end of the file, after the video and audio codecs have been flushed */
+			END
+		};
+
+		Type type = Type::END;
+		dcpomatic::ContentTime time;
+		std::shared_ptr<const Image> image;
+		std::shared_ptr<FFmpegAudioStream> stream;
+		std::shared_ptr<AudioBuffers> audio;
+		AVPacket* packet = nullptr;
+	};
+
+	bool const _decode_ahead;
+
+	/** Mutex to protect everything in _ahead; the thread itself is only started and
+	 *  stopped by pass_ahead() and seek(), on the caller's thread.
+	 */
+	boost::mutex _ahead_mutex;
+	struct Ahead
+	{
+		boost::thread thread;
+		/** signalled when something is added to or taken from queue, or the thread
+		 *  should stop or has died
+		 */
+		boost::condition condition;
+		std::list<AheadItem> queue;
+		/** number of VIDEO items in queue */
+		int video = 0;
+		/** packets which can be re-used for SUBTITLE items */
+		std::vector<AVPacket*> spare_packets;
+		bool stop = false;
+		bool died = false;
+	} _ahead;
 };
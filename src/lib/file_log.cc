@@ -27,12 +27,18 @@
 #include <cstdio>
 #include <iostream>
 #include <cerrno>
+#include <memory>
 
 
 using std::cout;
 using std::string;
 using std::max;
 using std::shared_ptr;
+using std::vector;
+
+
+/** Maximum number of entries that can be waiting to be written before callers must wait */
+static std::size_t constexpr max_pending = 65536;
 
 
 /** @param file Filename to write log to */
@@ -50,22 +56,105 @@ FileLog::FileLog (boost::filesystem::path file, int types)
 }
 
 
+FileLog::~FileLog ()
+{
+	{
+		boost::mutex::scoped_lock lm (_mutex);
+		_stop = true;
+	}
+
+	_pending_condition.notify_all ();
+
+	if (_thread.joinable()) {
+		_thread.join ();
+	}
+}
+
+
+/** Called with a lock held on _mutex */
 void
 FileLog::do_log (shared_ptr<const LogEntry> entry)
 {
-	dcp::File f(_file, "a");
-	if (!f) {
-		cout << "(could not log to " << _file.string() << " error " << errno << "): " << entry->get() << "\n";
-		return;
+	if (!_thread.joinable()) {
+		_thread = boost::thread(boost::bind(&FileLog::thread, this));
 	}
 
-	fprintf(f.get(), "%s\n", entry->get().c_str());
+	/* Wait for the thread to catch up, rather than losing entries; Log::log() has locked _mutex
+	 * for us, and the wait releases it while we are waiting.
+	 */
+	while (_pending.size() >= max_pending && !_stop) {
+		_pending_condition.wait(_mutex);
+	}
+
+	_pending.push_back (entry);
+	++_queued;
+	_pending_condition.notify_all ();
+}
+
+
+void
+FileLog::thread ()
+{
+	std::unique_ptr<dcp::File> file;
+	vector<shared_ptr<const LogEntry>> entries;
+
+	while (true) {
+		{
+			boost::mutex::scoped_lock lm (_mutex);
+			_written += entries.size();
+			_written_condition.notify_all ();
+
+			while (_pending.empty() && !_stop) {
+				_pending_condition.wait (lm);
+			}
+
+			if (_pending.empty()) {
+				/* _stop is set and there is nothing left to write */
+				return;
+			}
+
+			entries.clear ();
+			std::swap (entries, _pending);
+			/* Wake anybody who is waiting for room in _pending */
+			_pending_condition.notify_all ();
+		}
+
+		if (!file || !*file) {
+			file.reset (new dcp::File(_file, "a"));
+		}
+
+		for (auto const& entry: entries) {
+			if (*file) {
+				fprintf(file->get(), "%s\n", entry->get().c_str());
+			} else {
+				cout << "(could not log to " << _file.string() << " error " << errno << "): " << entry->get() << "\n";
+			}
+		}
+
+		if (*file) {
+			fflush (file->get());
+		}
+	}
+}
+
+
+/** Wait until everything that has been logged so far has been written to the file */
+void
+FileLog::flush () const
+{
+	boost::mutex::scoped_lock lm (_mutex);
+	auto const target = _queued;
+	while (_written < target) {
+		_written_condition.wait (lm);
+	}
 }
 
 
 string
 FileLog::head_and_tail (int amount) const
 {
+	flush ();
+
 	boost::mutex::scoped_lock lm (_mutex);
 
 	uintmax_t head_amount = amount;
@@ -20,19 +20,49 @@
 
 
 #include "log.h"
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+#include <vector>
 
 
+/** @class FileLog
+ *  @brief A Log which writes to a file.
+ *
+ *  Entries are handed to a background thread which formats them and writes them
+ *  to the file (which it keeps open), so that logging does not hold up the caller.
+ *  If the thread falls a long way behind, callers wait for it to catch up rather
+ *  than using ever more memory; no entries are ever dropped.
+ */
 class FileLog : public Log
 {
 public:
 	explicit FileLog (boost::filesystem::path file);
 	FileLog (boost::filesystem::path file, int types);
+	~FileLog ();
 
 	std::string head_and_tail (int amount = 1024) const override;
 
+	void flush () const;
+
 private:
 	void do_log (std::shared_ptr<const LogEntry> entry) override;
+	void thread ();
 
 	/** filename to write to */
 	boost::filesystem::path _file;
+
+	/** entries waiting to be written by _thread; protected by _mutex */
+	std::vector<std::shared_ptr<const LogEntry>> _pending;
+	/** number of entries that have been given to do_log(); protected by _mutex */
+	uint64_t _queued = 0;
+	/** number of entries that _thread has written; protected by _mutex */
+	uint64_t _written = 0;
+	/** true to ask _thread to finish once it has written everything; protected by _mutex */
+	bool _stop = false;
+	/** signalled when there is something in _pending, when _thread has emptied _pending, or when _stop has been set */
+	boost::condition _pending_condition;
+	/** signalled when _written changes */
+	mutable boost::condition _written_condition;
+	/** thread to write to the file, started when the first entry is logged */
+	boost::thread _thread;
 };
@@ -23,6 +23,7 @@
 #define DCPOMATIC_FILM_ENCODER_H
 
 
+#include "encode_server_statistics.h"
 #include "player.h"
 #include "player_text.h"
 #include <boost/signals2.hpp>
@@ -54,6 +55,11 @@ public:
 		return {};
 	}
 
+	/** @return statistics about any encode servers that are being used */
+	virtual std::vector<EncodeServerStatistics> server_statistics() const {
+		return {};
+	}
+
 	/** @return the number of frames that are done */
 	virtual Frame frames_done () const = 0;
 	virtual bool finishing () const = 0;
@@ -26,6 +26,7 @@
 #include "grok/context.h"
 #include "grok_j2k_encoder_thread.h"
 #include "j2k_encoder.h"
+#include "trace.h"
 #include "util.h"
 #include <dcp/scope_guard.h>
 
@@ -52,7 +53,10 @@ try
 	while (true)
 	{
 		LOG_TIMING("encoder-sleep thread=%1", thread_id());
-		auto frame = _encoder.pop();
+		auto frame = [this]() {
+			TraceSpan span("J2KEncoder::pop");
+			return _encoder.pop();
+		}();
 
 		dcp::ScopeGuard frame_guard([this, &frame]() {
 			LOG_ERROR("Failed to schedule encode of %1 using grok", frame.index());
@@ -64,6 +68,7 @@ try
 
 		auto grok = Config::instance()->grok().get_value_or({});
 
+		TraceSpan span("schedule encode", frame.index());
 		if (_context->launch(frame, grok.selected) && _context->scheduleCompress(frame)) {
 			frame_guard.cancel();
 		}
@@ -27,18 +27,21 @@
 #include "compose.hpp"
 #include "dcpomatic_assert.h"
 #include "dcpomatic_socket.h"
-#include "enum_indexed_vector.h"
 #include "exceptions.h"
+#include "ffmpeg_wrapper.h"
 #include "image.h"
+#include "image_pool.h"
+#include "lossless_image_codec.h"
 #include "maths_util.h"
-#include "memory_util.h"
 #include "rect.h"
+#include "scale_context_cache.h"
 #include "timer.h"
 #include <dcp/rgb_xyz.h>
 #include <dcp/transfer_function.h>
 #include <dcp/warnings.h>
 LIBDCP_DISABLE_WARNINGS
 extern "C" {
+#include <libavcodec/avcodec.h>
 #include <libavutil/frame.h>
 #include <libavutil/pixdesc.h>
 #include <libavutil/pixfmt.h>
@@ -61,7 +64,6 @@ using std::make_shared;
 using std::max;
 using std::min;
 using std::pair;
-using std::runtime_error;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -235,45 +237,30 @@ Image::crop_scale_window (
 	DCPOMATIC_ASSERT (out_size.height >= inter_size.height);
 
 	auto out = make_shared<Image>(out_format, out_size, out_alignment);
-	out->make_black ();
 
 	vector<uint8_t*> scale_in_data;
 	dcp::Size cropped_size;
 	std::tie(scale_in_data, cropped_size) = crop_source_pointers(crop);
 
-	/* Scale context for a scale from cropped_size to inter_size */
-	auto scale_context = sws_getContext (
-			cropped_size.width, cropped_size.height, pixel_format(),
-			inter_size.width, inter_size.height, out_format,
-			fast ? SWS_FAST_BILINEAR : SWS_BICUBIC, 0, 0, 0
-		);
-
-	if (!scale_context) {
-		throw runtime_error (N_("Could not allocate SwsContext"));
-	}
-
-	DCPOMATIC_ASSERT (yuv_to_rgb < dcp::YUVToRGB::COUNT);
-	EnumIndexedVector<int, dcp::YUVToRGB> lut;
-	lut[dcp::YUVToRGB::REC601] = SWS_CS_ITU601;
-	lut[dcp::YUVToRGB::REC709] = SWS_CS_ITU709;
-	lut[dcp::YUVToRGB::REC2020] = SWS_CS_BT2020;
+	/* Scale context for a scale from cropped_size to inter_size.
 
-	/* The 3rd parameter here is:
-	   0 -> source range MPEG (i.e. "video", 16-235)
-	   1 -> source range JPEG (i.e. "full", 0-255)
-	   And the 5th:
-	   0 -> destination range MPEG (i.e. "video", 16-235)
-	   1 -> destination range JPEG (i.e. "full", 0-255)
+	   The ranges passed to sws_setColorspaceDetails are:
+	   0 -> MPEG (i.e. "video", 16-235)
+	   1 -> JPEG (i.e. "full", 0-255)
 
 	   But remember: sws_setColorspaceDetails ignores these
 	   parameters unless the both source and destination images
 	   are isYUV or isGray.  (If either is not, it uses video range).
 	*/
-	sws_setColorspaceDetails (
-		scale_context,
-		sws_getCoefficients(lut[yuv_to_rgb]), video_range == VideoRange::VIDEO ? 0 : 1,
-		sws_getCoefficients(lut[yuv_to_rgb]), out_video_range == VideoRange::VIDEO ? 0 : 1,
-		0, 1 << 16, 1 << 16
+	auto scale_context = ScaleContextCache::instance()->get(
+		ScaleContextCache::Key(
+			cropped_size, pixel_format(),
+			inter_size, out_format,
+			fast ? SWS_FAST_BILINEAR : SWS_BICUBIC,
+			yuv_to_rgb,
+			video_range == VideoRange::VIDEO ? 0 : 1,
+			out_video_range == VideoRange::VIDEO ? 0 : 1
+			)
 		);
 
 	auto out_desc = av_pix_fmt_desc_get (out_format);
@@ -287,6 +274,12 @@ Image::crop_scale_window (
 		round_height_for_subsampling((out_size.height - inter_size.height) / 2, out_desc)
 		);
 
+	/* Blacken the areas above and below the scaled image.  We don't need to touch the rest of the
+	 * image here as it will be written by sws_scale() or blackened by make_part_black() below.
+	 */
+	out->make_rows_black(0, corner.y);
+	out->make_rows_black(corner.y + inter_size.height, out_size.height - corner.y - inter_size.height);
+
 	uint8_t* scale_out_data[out->planes()];
 	for (int c = 0; c < out->planes(); ++c) {
 		int const x = lrintf(out->bytes_per_pixel(c) * corner.x);
@@ -294,14 +287,12 @@ Image::crop_scale_window (
 	}
 
 	sws_scale (
-		scale_context,
+		scale_context->get(),
 		scale_in_data.data(), stride(),
 		0, cropped_size.height,
 		scale_out_data, out->stride()
 		);
 
-	sws_freeContext (scale_context);
-
 	/* There are some cases where there will be unwanted image data left in the image at this point:
 	 *
 	 * 1. When we are cropping without any scaling or pixel format conversion.
@@ -310,9 +301,8 @@ Image::crop_scale_window (
 	 *
 	 * Clear out the sides of the image to take care of those cases.
 	 */
-	auto const pad = (out_size.width - inter_size.width) / 2;
-	out->make_part_black(0, pad);
-	out->make_part_black(corner.x + inter_size.width, pad);
+	out->make_part_black(0, corner.x);
+	out->make_part_black(corner.x + inter_size.width, out_size.width - corner.x - inter_size.width);
 
 	if (
 		video_range == VideoRange::VIDEO &&
@@ -354,47 +344,27 @@ Image::scale (dcp::Size out_size, dcp::YUVToRGB yuv_to_rgb, AVPixelFormat out_fo
 	DCPOMATIC_ASSERT(out_size.height > 0);
 
 	auto scaled = make_shared<Image>(out_format, out_size, out_alignment);
-	auto scale_context = sws_getContext (
-		size().width, size().height, pixel_format(),
-		out_size.width, out_size.height, out_format,
-		(fast ? SWS_FAST_BILINEAR : SWS_BICUBIC) | SWS_ACCURATE_RND, 0, 0, 0
-		);
 
-	DCPOMATIC_ASSERT(scale_context);
-
-	DCPOMATIC_ASSERT (yuv_to_rgb < dcp::YUVToRGB::COUNT);
-	EnumIndexedVector<int, dcp::YUVToRGB> lut;
-	lut[dcp::YUVToRGB::REC601] = SWS_CS_ITU601;
-	lut[dcp::YUVToRGB::REC709] = SWS_CS_ITU709;
-	lut[dcp::YUVToRGB::REC2020] = SWS_CS_BT2020;
-
-	/* The 3rd parameter here is:
-	   0 -> source range MPEG (i.e. "video", 16-235)
-	   1 -> source range JPEG (i.e. "full", 0-255)
-	   And the 5th:
-	   0 -> destination range MPEG (i.e. "video", 16-235)
-	   1 -> destination range JPEG (i.e. "full", 0-255)
-
-	   But remember: sws_setColorspaceDetails ignores these
-	   parameters unless the corresponding image isYUV or isGray.
-	   (If it's neither, it uses video range).
+	/* Both ranges are MPEG (i.e. "video", 16-235) here; but remember that sws_setColorspaceDetails
+	   ignores them unless the corresponding image isYUV or isGray.  (If it's neither, it uses video range).
 	*/
-	sws_setColorspaceDetails (
-		scale_context,
-		sws_getCoefficients(lut[yuv_to_rgb]), 0,
-		sws_getCoefficients(lut[yuv_to_rgb]), 0,
-		0, 1 << 16, 1 << 16
+	auto scale_context = ScaleContextCache::instance()->get(
+		ScaleContextCache::Key(
+			size(), pixel_format(),
+			out_size, out_format,
+			(fast ? SWS_FAST_BILINEAR : SWS_BICUBIC) | SWS_ACCURATE_RND,
+			yuv_to_rgb,
+			0, 0
+			)
 		);
 
 	sws_scale (
-		scale_context,
+		scale_context->get(),
 		data(), stride(),
 		0, size().height,
 		scaled->data(), scaled->stride()
 		);
 
-	sws_freeContext (scale_context);
-
 	return scaled;
 }
 
@@ -429,9 +399,29 @@ Image::swap_16 (uint16_t v)
 }
 
 
+/** Make a vertical strip of the image black.  Samples of subsampled planes which are only
+ *  partly inside the strip are left alone, since they also belong to pixels outside it.
+ *  @param start First column (in luma columns).
+ *  @param width Number of columns (in luma columns).
+ */
 void
 Image::make_part_black (int const start, int const width)
 {
+	if (width <= 0) {
+		return;
+	}
+
+	/* First and one-past-last samples of a plane that are entirely inside the strip */
+	auto first_sample = [&](int plane) {
+		int const factor = horizontal_factor(plane);
+		return (start + factor - 1) / factor;
+	};
+
+	auto last_sample = [&](int plane) {
+		int const factor = horizontal_factor(plane);
+		return std::min(sample_size(plane).width, (start + width + factor - 1) / factor);
+	};
+
 	auto y_part = [&]() {
 		int const bpp = bytes_per_pixel(0);
 		int const h = sample_size(0).height;
@@ -471,7 +461,7 @@ Image::make_part_black (int const start, int const width)
 			auto p = data()[i];
 			int const h = sample_size(i).height;
 			for (int y = 0; y < h; ++y) {
-				for (int x = start / 2; x < (start + width) / 2; ++x) {
+				for (int x = first_sample(i); x < last_sample(i); ++x) {
 					p[x] = eight_bit_uv;
 				}
 				p += stride()[i];
@@ -486,7 +476,7 @@ Image::make_part_black (int const start, int const width)
 			auto p = reinterpret_cast<int16_t*>(data()[i]);
 			int const h = sample_size(i).height;
 			for (int y = 0; y < h; ++y) {
-				for (int x = start / 2; x < (start + width) / 2; ++x) {
+				for (int x = first_sample(i); x < last_sample(i); ++x) {
 					p[x] = ten_bit_uv;
 				}
 				p += stride()[i] / 2;
@@ -515,6 +505,70 @@ Image::make_part_black (int const start, int const width)
 }
 
 
+/** Make some complete rows of the image black.  Rows of subsampled planes which are only
+ *  partly in the given range are also blackened.  If we do not know how to do this for
+ *  our pixel format the whole image is made black.
+ *  @param start First row (in luma rows).
+ *  @param height Number of rows (in luma rows).
+ */
+void
+Image::make_rows_black (int const start, int const height)
+{
+	if (height <= 0) {
+		return;
+	}
+
+	/* Fill rows of a plane with a value in every byte */
+	auto fill = [&](int plane, uint8_t value) {
+		int const factor = vertical_factor(plane);
+		int const first = start / factor;
+		int const last = std::min(sample_size(plane).height, (start + height + factor - 1) / factor);
+		memset (data()[plane] + first * stride()[plane], value, (last - first) * stride()[plane]);
+	};
+
+	/* Fill rows of a plane with a 16-bit value */
+	auto fill_16 = [&](int plane, int16_t value) {
+		int const factor = vertical_factor(plane);
+		int const first = start / factor;
+		int const last = std::min(sample_size(plane).height, (start + height + factor - 1) / factor);
+		for (int y = first; y < last; ++y) {
+			auto p = reinterpret_cast<int16_t*>(data()[plane] + y * stride()[plane]);
+			for (int x = 0; x < line_size()[plane] / 2; ++x) {
+				p[x] = value;
+			}
+		}
+	};
+
+	switch (_pixel_format) {
+	case AV_PIX_FMT_RGB24:
+	case AV_PIX_FMT_ARGB:
+	case AV_PIX_FMT_RGBA:
+	case AV_PIX_FMT_ABGR:
+	case AV_PIX_FMT_BGRA:
+	case AV_PIX_FMT_RGB555LE:
+	case AV_PIX_FMT_RGB48LE:
+	case AV_PIX_FMT_RGB48BE:
+	case AV_PIX_FMT_XYZ12LE:
+		fill(0, 0);
+		break;
+	case AV_PIX_FMT_YUV420P:
+		fill(0, 0);
+		fill(1, eight_bit_uv);
+		fill(2, eight_bit_uv);
+		break;
+	case AV_PIX_FMT_YUV422P10LE:
+	case AV_PIX_FMT_YUV444P10LE:
+		fill(0, 0);
+		fill_16(1, ten_bit_uv);
+		fill_16(2, ten_bit_uv);
+		break;
+	default:
+		/* We don't know how to do part of this format, so do all of it */
+		make_black ();
+	}
+}
+
+
 void
 Image::make_black ()
 {
@@ -665,15 +719,10 @@ struct OtherRGBParams
 	dcp::Size size;
 	uint8_t* const* data;
 	int const* stride;
-	int bpp;
 
 	uint8_t* line_pointer(int y) const {
 		return data[0] + y * stride[0];
 	}
-
-	float alpha_divisor() const {
-		return pow(2, bpp * 2) - 1;
-	}
 };
 
 
@@ -688,117 +737,166 @@ struct OtherYUVParams
 
 	uint8_t* const* alpha_data;
 	int const* alpha_stride;
-	int alpha_bpp;
 };
 
 
-template <class OtherType>
-void
-alpha_blend_onto_rgb24(TargetParams const& target, OtherRGBParams const& other, int red, int blue, std::function<float (OtherType*)> get, int value_divisor)
+/* The pixel formats that alpha_blend() accepts for the image being blended.  These are passed
+ * to the blend kernels as template parameters so that the compiler can build (and vectorise)
+ * a separate inner loop for each pair of formats rather than calling out for every sample.
+ */
+
+/** BGRA or RGBA, with 8 bits per component */
+template <int Red, int Blue>
+struct OtherRGBA8
 {
-	/* Going onto RGB24.  First byte is red, second green, third blue */
-	auto const alpha_divisor = other.alpha_divisor();
-	for (int ty = target.start_y, oy = other.start_y; ty < target.size.height && oy < other.size.height; ++ty, ++oy) {
-		auto tp = target.line_pointer(ty);
-		auto op = reinterpret_cast<OtherType*>(other.line_pointer(oy));
-		for (int tx = target.start_x, ox = other.start_x; tx < target.size.width && ox < other.size.width; ++tx, ++ox) {
-			float const alpha = get(op + 3) / alpha_divisor;
-			tp[0] = (get(op + red) / value_divisor) * alpha + tp[0] * (1 - alpha);
-			tp[1] = (get(op + 1) / value_divisor) * alpha + tp[1] * (1 - alpha);
-			tp[2] = (get(op + blue) / value_divisor) * alpha + tp[2] * (1 - alpha);
-
-			tp += target.bpp;
-			op += other.bpp / sizeof(OtherType);
-		}
+	typedef uint8_t Type;
+	static int constexpr red = Red;
+	static int constexpr blue = Blue;
+	/** Number of Type values per pixel */
+	static int constexpr step = 4;
+	static float constexpr alpha_divisor = 255;
+	/** Divisor to get an 8-bit value from one of our components */
+	static int constexpr to_8_bit_divisor = 1;
+	/** Multiplier to get a 16-bit value from one of our components */
+	static int constexpr to_16_bit_scale = 256;
+
+	static float get(uint8_t const* p) {
+		return *p;
 	}
-}
 
+	/** @param p Pointer to the start of a pixel */
+	static bool transparent(uint8_t const* p) {
+		return p[3] == 0;
+	}
 
-template <class OtherType>
-void
-alpha_blend_onto_bgra(TargetParams const& target, OtherRGBParams const& other, int red, int blue, std::function<float (OtherType*)> get, int value_divisor)
+	/** @param p Pointer to the start of a pixel */
+	static float alpha(uint8_t const* p) {
+		return get(p + 3) / alpha_divisor;
+	}
+};
+
+typedef OtherRGBA8<2, 0> OtherBGRA;
+typedef OtherRGBA8<0, 2> OtherRGBA;
+
+
+/** RGBA with 16 bits per component, big-endian */
+struct OtherRGBA64BE
 {
-	auto const alpha_divisor = other.alpha_divisor();
-	for (int ty = target.start_y, oy = other.start_y; ty < target.size.height && oy < other.size.height; ++ty, ++oy) {
-		auto tp = target.line_pointer(ty);
-		auto op = reinterpret_cast<OtherType*>(other.line_pointer(oy));
-		for (int tx = target.start_x, ox = other.start_x; tx < target.size.width && ox < other.size.width; ++tx, ++ox) {
-			float const alpha = get(op + 3) / alpha_divisor;
-			tp[0] = (get(op + blue) / value_divisor) * alpha + tp[0] * (1 - alpha);
-			tp[1] = (get(op + 1) / value_divisor) * alpha + tp[1] * (1 - alpha);
-			tp[2] = (get(op + red) / value_divisor) * alpha + tp[2] * (1 - alpha);
-			tp[3] = (get(op + 3) / value_divisor) * alpha + tp[3] * (1 - alpha);
-
-			tp += target.bpp;
-			op += other.bpp / sizeof(OtherType);
-		}
+	typedef uint16_t Type;
+	static int constexpr red = 0;
+	static int constexpr blue = 2;
+	static int constexpr step = 4;
+	static float constexpr alpha_divisor = 65535;
+	static int constexpr to_8_bit_divisor = 256;
+	static int constexpr to_16_bit_scale = 1;
+
+	static float get(uint16_t const* p) {
+		return (*p >> 8) | ((*p & 0xff) << 8);
+	}
+
+	static bool transparent(uint16_t const* p) {
+		return p[3] == 0;
 	}
+
+	static float alpha(uint16_t const* p) {
+		return get(p + 3) / alpha_divisor;
+	}
+};
+
+
+/** 8-bit RGB targets: the offsets of the red and blue components, and the number of bytes per pixel */
+template <int Red, int Blue, int Step>
+struct TargetRGB8
+{
+	static int constexpr red = Red;
+	static int constexpr blue = Blue;
+	static int constexpr step = Step;
+	static bool constexpr has_alpha = Step == 4;
+};
+
+typedef TargetRGB8<0, 2, 3> TargetRGB24;
+typedef TargetRGB8<2, 0, 4> TargetBGRA;
+typedef TargetRGB8<0, 2, 4> TargetRGBA;
+
+
+/** Number of pixels that will be blended on each line */
+static
+int
+blend_width(TargetParams const& target, int other_start_x, int other_width)
+{
+	return std::max(0, std::min(target.size.width - target.start_x, other_width - other_start_x));
 }
 
 
-template <class OtherType>
+template <class Target, class Other>
 void
-alpha_blend_onto_rgba(TargetParams const& target, OtherRGBParams const& other, int red, int blue, std::function<float (OtherType*)> get, int value_divisor)
+alpha_blend_onto_rgb8(TargetParams const& target, OtherRGBParams const& other)
 {
-	auto const alpha_divisor = other.alpha_divisor();
+	int const width = blend_width(target, other.start_x, other.size.width);
 	for (int ty = target.start_y, oy = other.start_y; ty < target.size.height && oy < other.size.height; ++ty, ++oy) {
 		auto tp = target.line_pointer(ty);
-		auto op = reinterpret_cast<OtherType*>(other.line_pointer(oy));
-		for (int tx = target.start_x, ox = other.start_x; tx < target.size.width && ox < other.size.width; ++tx, ++ox) {
-			float const alpha = get(op + 3) / alpha_divisor;
-			tp[0] = (get(op + red) / value_divisor) * alpha + tp[0] * (1 - alpha);
-			tp[1] = (get(op + 1) / value_divisor) * alpha + tp[1] * (1 - alpha);
-			tp[2] = (get(op + blue) / value_divisor) * alpha + tp[2] * (1 - alpha);
-			tp[3] = (get(op + 3) / value_divisor) * alpha + tp[3] * (1 - alpha);
-
-			tp += target.bpp;
-			op += other.bpp / sizeof(OtherType);
+		auto op = reinterpret_cast<typename Other::Type const*>(other.line_pointer(oy));
+		for (int x = 0; x < width; ++x, tp += Target::step, op += Other::step) {
+			if (Other::transparent(op)) {
+				/* Subtitles are mostly transparent, and there's nothing to do here */
+				continue;
+			}
+			float const alpha = Other::alpha(op);
+			tp[Target::red] = (Other::get(op + Other::red) / Other::to_8_bit_divisor) * alpha + tp[Target::red] * (1 - alpha);
+			tp[1] = (Other::get(op + 1) / Other::to_8_bit_divisor) * alpha + tp[1] * (1 - alpha);
+			tp[Target::blue] = (Other::get(op + Other::blue) / Other::to_8_bit_divisor) * alpha + tp[Target::blue] * (1 - alpha);
+			if (Target::has_alpha) {
+				tp[3] = (Other::get(op + 3) / Other::to_8_bit_divisor) * alpha + tp[3] * (1 - alpha);
+			}
 		}
 	}
 }
 
 
-template <class OtherType>
+template <class Other>
 void
-alpha_blend_onto_rgb48le(TargetParams const& target, OtherRGBParams const& other, int red, int blue, std::function<float (OtherType*)> get, int value_scale)
+alpha_blend_onto_rgb48le(TargetParams const& target, OtherRGBParams const& other)
 {
-	auto const alpha_divisor = other.alpha_divisor();
+	int const width = blend_width(target, other.start_x, other.size.width);
 	for (int ty = target.start_y, oy = other.start_y; ty < target.size.height && oy < other.size.height; ++ty, ++oy) {
 		auto tp = reinterpret_cast<uint16_t*>(target.line_pointer(ty));
-		auto op = reinterpret_cast<OtherType*>(other.line_pointer(oy));
-		for (int tx = target.start_x, ox = other.start_x; tx < target.size.width && ox < other.size.width; ++tx, ++ox) {
-			float const alpha = get(op + 3) / alpha_divisor;
-			tp[0] = get(op + red) * value_scale * alpha + tp[0] * (1 - alpha);
-			tp[1] = get(op + 1) * value_scale * alpha + tp[1] * (1 - alpha);
-			tp[2] = get(op + blue) * value_scale * alpha + tp[2] * (1 - alpha);
-
-			tp += target.bpp / 2;
-			op += other.bpp / sizeof(OtherType);
+		auto op = reinterpret_cast<typename Other::Type const*>(other.line_pointer(oy));
+		for (int x = 0; x < width; ++x, tp += 3, op += Other::step) {
+			if (Other::transparent(op)) {
+				continue;
+			}
+			float const alpha = Other::alpha(op);
+			tp[0] = Other::get(op + Other::red) * Other::to_16_bit_scale * alpha + tp[0] * (1 - alpha);
+			tp[1] = Other::get(op + 1) * Other::to_16_bit_scale * alpha + tp[1] * (1 - alpha);
+			tp[2] = Other::get(op + Other::blue) * Other::to_16_bit_scale * alpha + tp[2] * (1 - alpha);
 		}
 	}
 }
 
 
-template <class OtherType>
+template <class Other>
 void
-alpha_blend_onto_xyz12le(TargetParams const& target, OtherRGBParams const& other, int red, int blue, std::function<float (OtherType*)> get, int value_divisor)
+alpha_blend_onto_xyz12le(TargetParams const& target, OtherRGBParams const& other)
 {
-	auto const alpha_divisor = other.alpha_divisor();
 	auto conv = dcp::ColourConversion::srgb_to_xyz();
 	double fast_matrix[9];
 	dcp::combined_rgb_to_xyz(conv, fast_matrix);
 	auto lut_in = conv.in()->double_lut(0, 1, 8, false);
 	auto lut_out = conv.out()->int_lut(0, 1, 16, true, 65535);
+	int const width = blend_width(target, other.start_x, other.size.width);
 	for (int ty = target.start_y, oy = other.start_y; ty < target.size.height && oy < other.size.height; ++ty, ++oy) {
-		auto tp = reinterpret_cast<uint16_t*>(target.data[0] + ty * target.stride[0] + target.start_x * target.bpp);
-		auto op = reinterpret_cast<OtherType*>(other.data[0] + oy * other.stride[0]);
-		for (int tx = target.start_x, ox = other.start_x; tx < target.size.width && ox < other.size.width; ++tx, ++ox) {
-			float const alpha = get(op + 3) / alpha_divisor;
+		auto tp = reinterpret_cast<uint16_t*>(target.line_pointer(ty));
+		auto op = reinterpret_cast<typename Other::Type const*>(other.line_pointer(oy));
+		for (int x = 0; x < width; ++x, tp += 3, op += Other::step) {
+			if (Other::transparent(op)) {
+				continue;
+			}
+			float const alpha = Other::alpha(op);
 
 			/* Convert sRGB to XYZ; op is BGRA.  First, input gamma LUT */
-			double const r = lut_in[get(op + red) / value_divisor];
-			double const g = lut_in[get(op + 1) / value_divisor];
-			double const b = lut_in[get(op + blue) / value_divisor];
+			double const r = lut_in[Other::get(op + Other::red) / Other::to_8_bit_divisor];
+			double const g = lut_in[Other::get(op + 1) / Other::to_8_bit_divisor];
+			double const b = lut_in[Other::get(op + Other::blue) / Other::to_8_bit_divisor];
 
 			/* RGB to XYZ, including Bradford transform and DCI companding */
 			double const x = max(0.0, min(1.0, r * fast_matrix[0] + g * fast_matrix[1] + b * fast_matrix[2]));
@@ -809,17 +907,22 @@ alpha_blend_onto_xyz12le(TargetParams const& target, OtherRGBParams const& other
 			tp[0] = lut_out[lrint(x * 65535)] * alpha + tp[0] * (1 - alpha);
 			tp[1] = lut_out[lrint(y * 65535)] * alpha + tp[1] * (1 - alpha);
 			tp[2] = lut_out[lrint(z * 65535)] * alpha + tp[2] * (1 - alpha);
-
-			tp += target.bpp / 2;
-			op += other.bpp / sizeof(OtherType);
 		}
 	}
 }
 
 
-static
+template <class Other>
+typename Other::Type const*
+alpha_line_pointer(OtherYUVParams const& other, int y)
+{
+	return reinterpret_cast<typename Other::Type const*>(other.alpha_data[0] + y * other.alpha_stride[0]) + other.start_x * Other::step;
+}
+
+
+template <class Other>
 void
-alpha_blend_onto_yuv420p(TargetParams const& target, OtherYUVParams const& other, std::function<float (uint8_t* data)> get_alpha)
+alpha_blend_onto_yuv420p(TargetParams const& target, OtherYUVParams const& other)
 {
 	auto const ts = target.size;
 	auto const os = other.size;
@@ -832,12 +935,14 @@ alpha_blend_onto_yuv420p(TargetParams const& target, OtherYUVParams const& other
 		uint8_t* oY = other.data[0] + (oy * other.stride[0]) + other.start_x;
 		uint8_t* oU = other.data[1] + (hoy * other.stride[1]) + other.start_x / 2;
 		uint8_t* oV = other.data[2] + (hoy * other.stride[2]) + other.start_x / 2;
-		uint8_t* alpha = other.alpha_data[0] + (oy * other.alpha_stride[0]) + other.start_x * other.alpha_bpp;
+		auto alpha = alpha_line_pointer<Other>(other, oy);
 		for (int tx = target.start_x, ox = other.start_x; tx < ts.width && ox < os.width; ++tx, ++ox) {
-			float const a = get_alpha(alpha);
-			*tY = *oY * a + *tY * (1 - a);
-			*tU = *oU * a + *tU * (1 - a);
-			*tV = *oV * a + *tV * (1 - a);
+			if (!Other::transparent(alpha)) {
+				float const a = Other::alpha(alpha);
+				*tY = *oY * a + *tY * (1 - a);
+				*tU = *oU * a + *tU * (1 - a);
+				*tV = *oV * a + *tV * (1 - a);
+			}
 			++tY;
 			++oY;
 			if (tx % 2) {
@@ -848,15 +953,15 @@ alpha_blend_onto_yuv420p(TargetParams const& target, OtherYUVParams const& other
 				++oU;
 				++oV;
 			}
-			alpha += other.alpha_bpp;
+			alpha += Other::step;
 		}
 	}
 }
 
 
-static
+template <class Other>
 void
-alpha_blend_onto_yuv420p10(TargetParams const& target, OtherYUVParams const& other, std::function<float (uint8_t* data)> get_alpha)
+alpha_blend_onto_yuv420p10(TargetParams const& target, OtherYUVParams const& other)
 {
 	auto const ts = target.size;
 	auto const os = other.size;
@@ -869,12 +974,14 @@ alpha_blend_onto_yuv420p10(TargetParams const& target, OtherYUVParams const& oth
 		uint16_t* oY = reinterpret_cast<uint16_t*>(other.data[0] + (oy * other.stride[0])) + other.start_x;
 		uint16_t* oU = reinterpret_cast<uint16_t*>(other.data[1] + (hoy * other.stride[1])) + other.start_x / 2;
 		uint16_t* oV = reinterpret_cast<uint16_t*>(other.data[2] + (hoy * other.stride[2])) + other.start_x / 2;
-		uint8_t* alpha = other.alpha_data[0] + (oy * other.alpha_stride[0]) + other.start_x * other.alpha_bpp;
+		auto alpha = alpha_line_pointer<Other>(other, oy);
 		for (int tx = target.start_x, ox = other.start_x; tx < ts.width && ox < os.width; ++tx, ++ox) {
-			float const a = get_alpha(alpha);
-			*tY = *oY * a + *tY * (1 - a);
-			*tU = *oU * a + *tU * (1 - a);
-			*tV = *oV * a + *tV * (1 - a);
+			if (!Other::transparent(alpha)) {
+				float const a = Other::alpha(alpha);
+				*tY = *oY * a + *tY * (1 - a);
+				*tU = *oU * a + *tU * (1 - a);
+				*tV = *oV * a + *tV * (1 - a);
+			}
 			++tY;
 			++oY;
 			if (tx % 2) {
@@ -885,15 +992,15 @@ alpha_blend_onto_yuv420p10(TargetParams const& target, OtherYUVParams const& oth
 				++oU;
 				++oV;
 			}
-			alpha += other.alpha_bpp;
+			alpha += Other::step;
 		}
 	}
 }
 
 
-static
+template <class Other>
 void
-alpha_blend_onto_yuv422p9or10le(TargetParams const& target, OtherYUVParams const& other, std::function<float (uint8_t* data)> get_alpha)
+alpha_blend_onto_yuv422p9or10le(TargetParams const& target, OtherYUVParams const& other)
 {
 	auto const ts = target.size;
 	auto const os = other.size;
@@ -904,12 +1011,14 @@ alpha_blend_onto_yuv422p9or10le(TargetParams const& target, OtherYUVParams const
 		uint16_t* oY = reinterpret_cast<uint16_t*>(other.data[0] + (oy * other.stride[0])) + other.start_x;
 		uint16_t* oU = reinterpret_cast<uint16_t*>(other.data[1] + (oy * other.stride[1])) + other.start_x / 2;
 		uint16_t* oV = reinterpret_cast<uint16_t*>(other.data[2] + (oy * other.stride[2])) + other.start_x / 2;
-		uint8_t* alpha = other.alpha_data[0] + (oy * other.alpha_stride[0]) + other.start_x * other.alpha_bpp;
+		auto alpha = alpha_line_pointer<Other>(other, oy);
 		for (int tx = target.start_x, ox = other.start_x; tx < ts.width && ox < os.width; ++tx, ++ox) {
-			float const a = get_alpha(alpha);
-			*tY = *oY * a + *tY * (1 - a);
-			*tU = *oU * a + *tU * (1 - a);
-			*tV = *oV * a + *tV * (1 - a);
+			if (!Other::transparent(alpha)) {
+				float const a = Other::alpha(alpha);
+				*tY = *oY * a + *tY * (1 - a);
+				*tU = *oU * a + *tU * (1 - a);
+				*tV = *oV * a + *tV * (1 - a);
+			}
 			++tY;
 			++oY;
 			if (tx % 2) {
@@ -920,43 +1029,85 @@ alpha_blend_onto_yuv422p9or10le(TargetParams const& target, OtherYUVParams const
 				++oU;
 				++oV;
 			}
-			alpha += other.alpha_bpp;
+			alpha += Other::step;
 		}
 	}
 }
 
 
-static
+template <class Other>
 void
-alpha_blend_onto_yuv444p9or10le(TargetParams const& target, OtherYUVParams const& other, std::function<float (uint8_t* data)> get_alpha)
+alpha_blend_onto_yuv444p9or10le(TargetParams const& target, OtherYUVParams const& other)
 {
 	auto const ts = target.size;
 	auto const os = other.size;
+	int const width = blend_width(target, other.start_x, os.width);
 	for (int ty = target.start_y, oy = other.start_y; ty < ts.height && oy < os.height; ++ty, ++oy) {
 		uint16_t* tY = reinterpret_cast<uint16_t*>(target.data[0] + (ty * target.stride[0])) + target.start_x;
 		uint16_t* tU = reinterpret_cast<uint16_t*>(target.data[1] + (ty * target.stride[1])) + target.start_x;
 		uint16_t* tV = reinterpret_cast<uint16_t*>(target.data[2] + (ty * target.stride[2])) + target.start_x;
-		uint16_t* oY = reinterpret_cast<uint16_t*>(other.data[0] + (oy * other.stride[0])) + other.start_x;
-		uint16_t* oU = reinterpret_cast<uint16_t*>(other.data[1] + (oy * other.stride[1])) + other.start_x;
-		uint16_t* oV = reinterpret_cast<uint16_t*>(other.data[2] + (oy * other.stride[2])) + other.start_x;
-		uint8_t* alpha = other.alpha_data[0] + (oy * other.alpha_stride[0]) + other.start_x * other.alpha_bpp;
-		for (int tx = target.start_x, ox = other.start_x; tx < ts.width && ox < os.width; ++tx, ++ox) {
-			float const a = get_alpha(alpha);
-			*tY = *oY * a + *tY * (1 - a);
-			*tU = *oU * a + *tU * (1 - a);
-			*tV = *oV * a + *tV * (1 - a);
-			++tY;
-			++oY;
-			++tU;
-			++tV;
-			++oU;
-			++oV;
-			alpha += other.alpha_bpp;
+		uint16_t const* oY = reinterpret_cast<uint16_t const*>(other.data[0] + (oy * other.stride[0])) + other.start_x;
+		uint16_t const* oU = reinterpret_cast<uint16_t const*>(other.data[1] + (oy * other.stride[1])) + other.start_x;
+		uint16_t const* oV = reinterpret_cast<uint16_t const*>(other.data[2] + (oy * other.stride[2])) + other.start_x;
+		auto alpha = alpha_line_pointer<Other>(other, oy);
+		for (int x = 0; x < width; ++x) {
+			if (!Other::transparent(alpha + x * Other::step)) {
+				float const a = Other::alpha(alpha + x * Other::step);
+				tY[x] = oY[x] * a + tY[x] * (1 - a);
+				tU[x] = oU[x] * a + tU[x] * (1 - a);
+				tV[x] = oV[x] * a + tV[x] * (1 - a);
+			}
 		}
 	}
 }
 
 
+/** Blend an image whose format is described by Other onto a target of some format */
+template <class Other>
+void
+alpha_blend_from(AVPixelFormat format, TargetParams target, OtherRGBParams const& other_rgb, OtherYUVParams const& other_yuv)
+{
+	switch (format) {
+	case AV_PIX_FMT_RGB24:
+		target.bpp = 3;
+		alpha_blend_onto_rgb8<TargetRGB24, Other>(target, other_rgb);
+		break;
+	case AV_PIX_FMT_BGRA:
+		target.bpp = 4;
+		alpha_blend_onto_rgb8<TargetBGRA, Other>(target, other_rgb);
+		break;
+	case AV_PIX_FMT_RGBA:
+		target.bpp = 4;
+		alpha_blend_onto_rgb8<TargetRGBA, Other>(target, other_rgb);
+		break;
+	case AV_PIX_FMT_RGB48LE:
+		target.bpp = 6;
+		alpha_blend_onto_rgb48le<Other>(target, other_rgb);
+		break;
+	case AV_PIX_FMT_XYZ12LE:
+		target.bpp = 6;
+		alpha_blend_onto_xyz12le<Other>(target, other_rgb);
+		break;
+	case AV_PIX_FMT_YUV420P:
+		alpha_blend_onto_yuv420p<Other>(target, other_yuv);
+		break;
+	case AV_PIX_FMT_YUV420P10:
+		alpha_blend_onto_yuv420p10<Other>(target, other_yuv);
+		break;
+	case AV_PIX_FMT_YUV422P9LE:
+	case AV_PIX_FMT_YUV422P10LE:
+		alpha_blend_onto_yuv422p9or10le<Other>(target, other_yuv);
+		break;
+	case AV_PIX_FMT_YUV444P9LE:
+	case AV_PIX_FMT_YUV444P10LE:
+		alpha_blend_onto_yuv444p9or10le<Other>(target, other_yuv);
+		break;
+	default:
+		throw PixelFormatError ("alpha_blend()", format);
+	}
+}
+
+
 void
 Image::alpha_blend (shared_ptr<const Image> other, Position<int> position)
 {
@@ -966,9 +1117,6 @@ Image::alpha_blend (shared_ptr<const Image> other, Position<int> position)
 		other->pixel_format() == AV_PIX_FMT_RGBA64BE
 		);
 
-	int const blue = other->pixel_format() == AV_PIX_FMT_BGRA ? 0 : 2;
-	int const red = other->pixel_format() == AV_PIX_FMT_BGRA ? 2 : 0;
-
 	int start_tx = position.x;
 	int start_ox = 0;
 
@@ -999,138 +1147,44 @@ Image::alpha_blend (shared_ptr<const Image> other, Position<int> position)
 		start_oy,
 		other->size(),
 		other->data(),
-		other->stride(),
-		other->pixel_format() == AV_PIX_FMT_RGBA64BE ? 8 : 4
+		other->stride()
 	};
 
+	/* When blending onto YUV we blend a YUV version of other, using the alpha channel from the original */
+	shared_ptr<const Image> yuv;
+	switch (_pixel_format) {
+	case AV_PIX_FMT_YUV420P:
+	case AV_PIX_FMT_YUV420P10:
+	case AV_PIX_FMT_YUV422P9LE:
+	case AV_PIX_FMT_YUV422P10LE:
+	case AV_PIX_FMT_YUV444P9LE:
+	case AV_PIX_FMT_YUV444P10LE:
+		yuv = other->convert_pixel_format (dcp::YUVToRGB::REC709, _pixel_format, Alignment::COMPACT, false);
+		break;
+	default:
+		break;
+	}
+
 	OtherYUVParams other_yuv_params = {
 		start_ox,
 		start_oy,
 		other->size(),
+		yuv ? yuv->data() : nullptr,
+		yuv ? yuv->stride() : nullptr,
 		other->data(),
-		other->stride(),
-		nullptr,
-		nullptr,
-		other->pixel_format() == AV_PIX_FMT_RGBA64BE ? 8 : 4
+		other->stride()
 	};
 
-	auto byteswap = [](uint16_t* p) {
-		return (*p >> 8) | ((*p & 0xff) << 8);
-	};
-
-	auto pass = [](uint8_t* p) {
-		return *p;
-	};
-
-	auto get_alpha_64be = [](uint8_t* p) {
-		return ((static_cast<int16_t>(p[6]) << 8) | p[7]) / 65535.0f;
-	};
-
-	auto get_alpha_byte = [](uint8_t* p) {
-		return p[3] / 255.0f;
-	};
-
-	switch (_pixel_format) {
-	case AV_PIX_FMT_RGB24:
-		target_params.bpp = 3;
-		if (other->pixel_format() == AV_PIX_FMT_RGBA64BE) {
-			alpha_blend_onto_rgb24<uint16_t>(target_params, other_rgb_params, red, blue, byteswap, 256);
-		} else {
-			alpha_blend_onto_rgb24<uint8_t>(target_params, other_rgb_params, red, blue, pass, 1);
-		}
-		break;
+	switch (other->pixel_format()) {
 	case AV_PIX_FMT_BGRA:
-		target_params.bpp = 4;
-		if (other->pixel_format() == AV_PIX_FMT_RGBA64BE) {
-			alpha_blend_onto_bgra<uint16_t>(target_params, other_rgb_params, red, blue, byteswap, 256);
-		} else {
-			alpha_blend_onto_bgra<uint8_t>(target_params, other_rgb_params, red, blue, pass, 1);
-		}
+		alpha_blend_from<OtherBGRA>(_pixel_format, target_params, other_rgb_params, other_yuv_params);
 		break;
 	case AV_PIX_FMT_RGBA:
-		target_params.bpp = 4;
-		if (other->pixel_format() == AV_PIX_FMT_RGBA64BE) {
-			alpha_blend_onto_rgba<uint16_t>(target_params, other_rgb_params, red, blue, byteswap, 256);
-		} else {
-			alpha_blend_onto_rgba<uint8_t>(target_params, other_rgb_params, red, blue, pass, 1);
-		}
-		break;
-	case AV_PIX_FMT_RGB48LE:
-		target_params.bpp = 6;
-		if (other->pixel_format() == AV_PIX_FMT_RGBA64BE) {
-			alpha_blend_onto_rgb48le<uint16_t>(target_params, other_rgb_params, red, blue, byteswap, 1);
-		} else {
-			alpha_blend_onto_rgb48le<uint8_t>(target_params, other_rgb_params, red, blue, pass, 256);
-		}
-		break;
-	case AV_PIX_FMT_XYZ12LE:
-		target_params.bpp = 6;
-		if (other->pixel_format() == AV_PIX_FMT_RGBA64BE) {
-			alpha_blend_onto_xyz12le<uint16_t>(target_params, other_rgb_params, red, blue, byteswap, 256);
-		} else {
-			alpha_blend_onto_xyz12le<uint8_t>(target_params, other_rgb_params, red, blue, pass, 1);
-		}
-		break;
-	case AV_PIX_FMT_YUV420P:
-	{
-		auto yuv = other->convert_pixel_format (dcp::YUVToRGB::REC709, _pixel_format, Alignment::COMPACT, false);
-		other_yuv_params.data = yuv->data();
-		other_yuv_params.stride = yuv->stride();
-		other_yuv_params.alpha_data = other->data();
-		other_yuv_params.alpha_stride = other->stride();
-		if (other->pixel_format() == AV_PIX_FMT_RGBA64BE) {
-			alpha_blend_onto_yuv420p(target_params, other_yuv_params, get_alpha_64be);
-		} else {
-			alpha_blend_onto_yuv420p(target_params, other_yuv_params, get_alpha_byte);
-		}
+		alpha_blend_from<OtherRGBA>(_pixel_format, target_params, other_rgb_params, other_yuv_params);
 		break;
-	}
-	case AV_PIX_FMT_YUV420P10:
-	{
-		auto yuv = other->convert_pixel_format (dcp::YUVToRGB::REC709, _pixel_format, Alignment::COMPACT, false);
-		other_yuv_params.data = yuv->data();
-		other_yuv_params.stride = yuv->stride();
-		other_yuv_params.alpha_data = other->data();
-		other_yuv_params.alpha_stride = other->stride();
-		if (other->pixel_format() == AV_PIX_FMT_RGBA64BE) {
-			alpha_blend_onto_yuv420p10(target_params, other_yuv_params, get_alpha_64be);
-		} else {
-			alpha_blend_onto_yuv420p10(target_params, other_yuv_params, get_alpha_byte);
-		}
-		break;
-	}
-	case AV_PIX_FMT_YUV422P9LE:
-	case AV_PIX_FMT_YUV422P10LE:
-	{
-		auto yuv = other->convert_pixel_format (dcp::YUVToRGB::REC709, _pixel_format, Alignment::COMPACT, false);
-		other_yuv_params.data = yuv->data();
-		other_yuv_params.stride = yuv->stride();
-		other_yuv_params.alpha_data = other->data();
-		other_yuv_params.alpha_stride = other->stride();
-		if (other->pixel_format() == AV_PIX_FMT_RGBA64BE) {
-			alpha_blend_onto_yuv422p9or10le(target_params, other_yuv_params, get_alpha_64be);
-		} else {
-			alpha_blend_onto_yuv422p9or10le(target_params, other_yuv_params, get_alpha_byte);
-		}
-		break;
-	}
-	case AV_PIX_FMT_YUV444P9LE:
-	case AV_PIX_FMT_YUV444P10LE:
-	{
-		auto yuv = other->convert_pixel_format (dcp::YUVToRGB::REC709, _pixel_format, Alignment::COMPACT, false);
-		other_yuv_params.data = yuv->data();
-		other_yuv_params.stride = yuv->stride();
-		other_yuv_params.alpha_data = other->data();
-		other_yuv_params.alpha_stride = other->stride();
-		if (other->pixel_format() == AV_PIX_FMT_RGBA64BE) {
-			alpha_blend_onto_yuv444p9or10le(target_params, other_yuv_params, get_alpha_64be);
-		} else {
-			alpha_blend_onto_yuv444p9or10le(target_params, other_yuv_params, get_alpha_byte);
-		}
-		break;
-	}
 	default:
-		throw PixelFormatError ("alpha_blend()", _pixel_format);
+		alpha_blend_from<OtherRGBA64BE>(_pixel_format, target_params, other_rgb_params, other_yuv_params);
+		break;
 	}
 }
 
@@ -1151,31 +1205,93 @@ Image::copy (shared_ptr<const Image> other, Position<int> position)
 }
 
 
+/** Ways in which image data may be sent over a socket which has compress_images() set */
+enum class SocketImageFormat
+{
+	RAW = 0,
+	FFV1 = 1
+};
+
+
+/** Read an image which was written with write_to_socket() */
 void
 Image::read_from_socket (shared_ptr<Socket> socket)
 {
+	if (socket->compress_images() && socket->read_uint32() == static_cast<uint32_t>(SocketImageFormat::FFV1)) {
+		size_t raw_size = 0;
+		for (int i = 0; i < planes(); ++i) {
+			raw_size += line_size()[i] * sample_size(i).height;
+		}
+
+		/* FFV1 can make an image which doesn't compress a bit bigger than the raw data, but no
+		 * valid image should be anything like this big.
+		 */
+		auto const size = socket->read_uint32();
+		if (size > raw_size * 2 + 65536) {
+			throw NetworkError("Malformed compressed image (too large)");
+		}
+
+		ffmpeg::Packet packet;
+		if (av_new_packet(packet.get(), size) < 0) {
+			throw std::bad_alloc();
+		}
+		socket->read(packet->data, size);
+		lossless_decompress_image(packet, *this);
+		return;
+	}
+
+	vector<pair<uint8_t*, int>> buffers;
 	for (int i = 0; i < planes(); ++i) {
 		uint8_t* p = data()[i];
 		int const lines = sample_size(i).height;
-		for (int y = 0; y < lines; ++y) {
-			socket->read (p, line_size()[i]);
-			p += stride()[i];
+		if (stride()[i] == line_size()[i]) {
+			/* No padding, so we can read the whole plane at once */
+			buffers.push_back({p, line_size()[i] * lines});
+		} else {
+			for (int y = 0; y < lines; ++y) {
+				buffers.push_back({p, line_size()[i]});
+				p += stride()[i];
+			}
 		}
 	}
+
+	socket->read(buffers);
 }
 
 
+/** Write this image to a socket.  If the socket has compress_images() set we will try to
+ *  compress it losslessly, and otherwise the raw image data are sent.
+ */
 void
 Image::write_to_socket (shared_ptr<Socket> socket) const
 {
+	if (socket->compress_images()) {
+		auto packet = lossless_compress_image(*this);
+		if (packet) {
+			socket->write(static_cast<uint32_t>(SocketImageFormat::FFV1));
+			socket->write(static_cast<uint32_t>((*packet)->size));
+			socket->write((*packet)->data, (*packet)->size);
+			return;
+		}
+		socket->write(static_cast<uint32_t>(SocketImageFormat::RAW));
+	}
+
+	vector<pair<uint8_t const*, int>> buffers;
 	for (int i = 0; i < planes(); ++i) {
-		uint8_t* p = data()[i];
+		uint8_t const* p = data()[i];
 		int const lines = sample_size(i).height;
-		for (int y = 0; y < lines; ++y) {
-			socket->write (p, line_size()[i]);
-			p += stride()[i];
+		if (stride()[i] == line_size()[i]) {
+			/* No padding, so we can write the whole plane at once */
+			buffers.push_back({p, line_size()[i] * lines});
+		} else {
+			for (int y = 0; y < lines; ++y) {
+				buffers.push_back({p, line_size()[i]});
+				p += stride()[i];
+			}
 		}
 	}
+
+	socket->write(buffers);
 }
 
 
@@ -1245,13 +1361,8 @@ Image::Image (AVPixelFormat p, dcp::Size s, Alignment alignment)
 void
 Image::allocate ()
 {
-	_data = (uint8_t **) wrapped_av_malloc (4 * sizeof (uint8_t *));
 	_data[0] = _data[1] = _data[2] = _data[3] = 0;
-
-	_line_size = (int *) wrapped_av_malloc (4 * sizeof (int));
 	_line_size[0] = _line_size[1] = _line_size[2] = _line_size[3] = 0;
-
-	_stride = (int *) wrapped_av_malloc (4 * sizeof (int));
 	_stride[0] = _stride[1] = _stride[2] = _stride[3] = 0;
 
 	auto stride_round_up = [](int stride, int t) {
@@ -1300,17 +1411,25 @@ Image::allocate ()
 		   |XXXwrittenXXX|<------line-size------------->|XXXwrittenXXXXXXwrittenXXX
 		                                                               ^^^^ out of bounds
 		*/
-		_data[i] = (uint8_t *) wrapped_av_malloc (_stride[i] * (sample_size(i).height + 1) + ALIGNMENT);
+		_data[i] = ImagePool::instance()->get(plane_allocation_size(i));
 #if HAVE_VALGRIND_MEMCHECK_H
 		/* The data between the end of the line size and the stride is undefined but processed by
 		   libswscale, causing lots of valgrind errors.  Mark it all defined to quell these errors.
 		*/
-		VALGRIND_MAKE_MEM_DEFINED (_data[i], _stride[i] * (sample_size(i).height + 1) + ALIGNMENT);
+		VALGRIND_MAKE_MEM_DEFINED (_data[i], plane_allocation_size(i));
 #endif
 	}
 }
 
 
+/** @return number of bytes that we allocate for a plane; see the comment in allocate() */
+size_t
+Image::plane_allocation_size (int plane) const
+{
+	return _stride[plane] * (sample_size(plane).height + 1) + ALIGNMENT;
+}
+
+
 Image::Image (Image const & other)
 	: std::enable_shared_from_this<Image>(other)
 	, _size (other._size)
@@ -1408,12 +1527,8 @@ Image::swap (Image & other)
 Image::~Image ()
 {
 	for (int i = 0; i < planes(); ++i) {
-		av_free (_data[i]);
+		ImagePool::instance()->put(_data[i], plane_allocation_size(i));
 	}
-
-	av_free (_data);
-	av_free (_line_size);
-	av_free (_stride);
 }
 
 
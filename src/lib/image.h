@@ -108,8 +108,10 @@ private:
 	friend struct make_part_black_test;
 
 	void allocate ();
+	size_t plane_allocation_size (int plane) const;
 	void swap (Image &);
 	void make_part_black (int x, int w);
+	void make_rows_black (int start, int height);
 	void yuv_16_black (uint16_t, bool);
 	static uint16_t swap_16 (uint16_t);
 	void video_range_to_full_range ();
@@ -117,9 +119,9 @@ private:
 
 	dcp::Size _size;
 	AVPixelFormat _pixel_format; ///< FFmpeg's way of describing the pixel format of this Image
-	uint8_t** _data; ///< array of pointers to components
-	int* _line_size; ///< array of sizes of the data in each line, in bytes (without any alignment padding bytes)
-	int* _stride; ///< array of strides for each line, in bytes (including any alignment padding bytes)
+	uint8_t* _data[4]; ///< array of pointers to components
+	int _line_size[4]; ///< array of sizes of the data in each line, in bytes (without any alignment padding bytes)
+	int _stride[4]; ///< array of strides for each line, in bytes (including any alignment padding bytes)
 	Alignment _alignment;
 };
 
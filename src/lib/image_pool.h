@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DCPOMATIC_IMAGE_POOL_H
+#define DCPOMATIC_IMAGE_POOL_H
+
+
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <map>
+#include <cstdint>
+
+
+/** @class ImagePool
+ *  @brief A pool of memory for Image planes.
+ *
+ *  When encoding or playing back we make and destroy many large Images of the same few
+ *  formats and sizes, often only a few milliseconds apart.  Image gets its plane memory
+ *  from here and gives it back when it is destroyed, so that we can avoid the cost of
+ *  repeatedly allocating, freeing and page-faulting in big blocks of memory.
+ *
+ *  Planes are keyed by their size in bytes (which is determined by the pixel format, size
+ *  and alignment of the Image) and the pool holds up to a maximum total size of unused planes,
+ *  freeing the least-recently-used ones when it is full.
+ */
+class ImagePool
+{
+public:
+	ImagePool() = default;
+	~ImagePool();
+
+	ImagePool(ImagePool const&) = delete;
+	ImagePool& operator=(ImagePool const&) = delete;
+
+	uint8_t* get(size_t size);
+	void put(uint8_t* data, size_t size);
+	void clear();
+
+	void set_maximum_size(size_t bytes);
+
+	struct Statistics
+	{
+		/** total size of the unused planes in the pool, in bytes */
+		size_t idle = 0;
+		/** number of calls to get() which re-used a plane */
+		int hits = 0;
+		/** number of calls to get() which had to allocate */
+		int misses = 0;
+	};
+
+	Statistics statistics() const;
+
+	static ImagePool* instance();
+
+private:
+	void evict();
+
+	using List = std::list<std::pair<size_t, uint8_t*>>;
+
+	mutable boost::mutex _mutex;
+	/** unused planes with the most recently used at the front */
+	List _idle;
+	/** index into _idle by size */
+	std::multimap<size_t, List::iterator> _index;
+	size_t _idle_size = 0;
+	size_t _maximum_size = 256 * 1024 * 1024;
+	int _hits = 0;
+	int _misses = 0;
+};
+
+
+#endif
@@ -0,0 +1,173 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "interleave.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DCPOMATIC_X86_SIMD
+#include <immintrin.h>
+#endif
+
+
+using namespace dcpomatic;
+
+
+void
+dcpomatic::interleave_to_uint16_scalar(int const* in0, int const* in1, int const* in2, uint16_t* out, int samples, int shift)
+{
+	for (int i = 0; i < samples; ++i) {
+		*out++ = in0[i] << shift;
+		*out++ = in1[i] << shift;
+		*out++ = in2[i] << shift;
+	}
+}
+
+
+#ifdef DCPOMATIC_X86_SIMD
+
+/* pshufb masks to make XYZXYZ... from three registers of eight 16-bit samples: X, Y and Z.
+ * Entries of -1 give 0 (a byte which another of the three registers will fill in).
+ */
+#define DCPOMATIC_INTERLEAVE_MASKS \
+	auto const x0 = _mm_setr_epi8( 0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  4,  5, -1, -1); \
+	auto const y0 = _mm_setr_epi8(-1, -1,  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  4,  5); \
+	auto const z0 = _mm_setr_epi8(-1, -1, -1, -1,  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1); \
+	auto const x1 = _mm_setr_epi8(-1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1, -1, -1, 10, 11); \
+	auto const y1 = _mm_setr_epi8(-1, -1, -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1, -1, -1); \
+	auto const z1 = _mm_setr_epi8( 4,  5, -1, -1, -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1); \
+	auto const x2 = _mm_setr_epi8(-1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1, -1, -1); \
+	auto const y2 = _mm_setr_epi8(10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1); \
+	auto const z2 = _mm_setr_epi8(-1, -1, 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15);
+
+
+/** Shift eight 32-bit samples left and truncate them to 16 bits */
+__attribute__((target("ssse3")))
+static inline __m128i
+narrow_ssse3(int const* in, __m128i shift)
+{
+	auto a = _mm_sll_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in)), shift);
+	auto b = _mm_sll_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in + 4)), shift);
+	/* Sign-extend the bottom 16 bits of each sample so that the saturating pack leaves them alone */
+	a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+	b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+	return _mm_packs_epi32(a, b);
+}
+
+
+__attribute__((target("ssse3")))
+static void
+interleave_to_uint16_ssse3(int const* in0, int const* in1, int const* in2, uint16_t* out, int samples, int shift)
+{
+	DCPOMATIC_INTERLEAVE_MASKS
+
+	auto const shift_vector = _mm_cvtsi32_si128(shift);
+
+	int i = 0;
+	for (; i <= samples - 8; i += 8) {
+		auto const x = narrow_ssse3(in0 + i, shift_vector);
+		auto const y = narrow_ssse3(in1 + i, shift_vector);
+		auto const z = narrow_ssse3(in2 + i, shift_vector);
+
+		auto o = reinterpret_cast<__m128i*>(out);
+		_mm_storeu_si128(o + 0, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(x, x0), _mm_shuffle_epi8(y, y0)), _mm_shuffle_epi8(z, z0)));
+		_mm_storeu_si128(o + 1, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(x, x1), _mm_shuffle_epi8(y, y1)), _mm_shuffle_epi8(z, z1)));
+		_mm_storeu_si128(o + 2, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(x, x2), _mm_shuffle_epi8(y, y2)), _mm_shuffle_epi8(z, z2)));
+		out += 24;
+	}
+
+	interleave_to_uint16_scalar(in0 + i, in1 + i, in2 + i, out, samples - i, shift);
+}
+
+
+/** Shift sixteen 32-bit samples left and truncate them to 16 bits, keeping them in order */
+__attribute__((target("avx2")))
+static inline __m256i
+narrow_avx2(int const* in, __m128i shift)
+{
+	auto a = _mm256_sll_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(in)), shift);
+	auto b = _mm256_sll_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + 8)), shift);
+	a = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+	b = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16);
+	/* The pack works within 128-bit lanes, so put the 64-bit chunks back in order afterwards */
+	return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8);
+}
+
+
+__attribute__((target("avx2")))
+static void
+interleave_to_uint16_avx2(int const* in0, int const* in1, int const* in2, uint16_t* out, int samples, int shift)
+{
+	DCPOMATIC_INTERLEAVE_MASKS
+
+	auto const shift_vector = _mm_cvtsi32_si128(shift);
+
+	/* The same masks in both lanes, as _mm256_shuffle_epi8 works within each 128-bit lane */
+	auto const x0_2 = _mm256_broadcastsi128_si256(x0);
+	auto const y0_2 = _mm256_broadcastsi128_si256(y0);
+	auto const z0_2 = _mm256_broadcastsi128_si256(z0);
+	auto const x1_2 = _mm256_broadcastsi128_si256(x1);
+	auto const y1_2 = _mm256_broadcastsi128_si256(y1);
+	auto const z1_2 = _mm256_broadcastsi128_si256(z1);
+	auto const x2_2 = _mm256_broadcastsi128_si256(x2);
+	auto const y2_2 = _mm256_broadcastsi128_si256(y2);
+	auto const z2_2 = _mm256_broadcastsi128_si256(z2);
+
+	int i = 0;
+	for (; i <= samples - 16; i += 16) {
+		auto const x = narrow_avx2(in0 + i, shift_vector);
+		auto const y = narrow_avx2(in1 + i, shift_vector);
+		auto const z = narrow_avx2(in2 + i, shift_vector);
+
+		/* Each of these has the output for samples 0-7 in the low lane and 8-15 in the high lane */
+		auto const a = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(x, x0_2), _mm256_shuffle_epi8(y, y0_2)), _mm256_shuffle_epi8(z, z0_2));
+		auto const b = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(x, x1_2), _mm256_shuffle_epi8(y, y1_2)), _mm256_shuffle_epi8(z, z1_2));
+		auto const c = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(x, x2_2), _mm256_shuffle_epi8(y, y2_2)), _mm256_shuffle_epi8(z, z2_2));
+
+		auto o = reinterpret_cast<__m256i*>(out);
+		_mm256_storeu_si256(o + 0, _mm256_permute2x128_si256(a, b, 0x20));
+		_mm256_storeu_si256(o + 1, _mm256_permute2x128_si256(c, a, 0x30));
+		_mm256_storeu_si256(o + 2, _mm256_permute2x128_si256(b, c, 0x31));
+		out += 48;
+	}
+
+	interleave_to_uint16_scalar(in0 + i, in1 + i, in2 + i, out, samples - i, shift);
+}
+
+#endif
+
+
+void
+dcpomatic::interleave_to_uint16(int const* in0, int const* in1, int const* in2, uint16_t* out, int samples, int shift)
+{
+	using Function = void (*)(int const*, int const*, int const*, uint16_t*, int, int);
+
+	static Function const function = []() -> Function {
+#ifdef DCPOMATIC_X86_SIMD
+		if (__builtin_cpu_supports("avx2")) {
+			return &interleave_to_uint16_avx2;
+		} else if (__builtin_cpu_supports("ssse3")) {
+			return &interleave_to_uint16_ssse3;
+		}
+#endif
+		return &interleave_to_uint16_scalar;
+	}();
+
+	function(in0, in1, in2, out, samples, shift);
+}
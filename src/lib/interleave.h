@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  src/lib/interleave.h
+ *  @brief Functions to interleave planar sample data, with SIMD versions where available.
+ */
+
+
+#ifndef DCPOMATIC_INTERLEAVE_H
+#define DCPOMATIC_INTERLEAVE_H
+
+
+#include <stdint.h>
+
+
+namespace dcpomatic {
+
+
+/** Interleave three planes of samples into packed 16-bit data, e.g. XYZXYZXYZ...
+ *  Each sample is shifted left by shift bits and then truncated to 16 bits.
+ *  @param in0 First plane.
+ *  @param in1 Second plane.
+ *  @param in2 Third plane.
+ *  @param out Output data, which must have space for (samples * 3) values.
+ *  @param samples Number of samples in each plane.
+ *  @param shift Left shift to apply to each sample.
+ */
+extern void interleave_to_uint16(int const* in0, int const* in1, int const* in2, uint16_t* out, int samples, int shift);
+
+/** Plain C++ version of interleave_to_uint16(), for testing */
+extern void interleave_to_uint16_scalar(int const* in0, int const* in1, int const* in2, uint16_t* out, int samples, int shift);
+
+
+}
+
+
+#endif
@@ -0,0 +1,150 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "config.h"
+#include "j2k_decode_cache.h"
+#include <tuple>
+
+
+using std::shared_ptr;
+
+
+bool
+J2KDecodeCache::Key::operator<(Key const& other) const
+{
+	return std::tie(asset_id, frame, eye, reduce, alignment) < std::tie(other.asset_id, other.frame, other.eye, other.reduce, other.alignment);
+}
+
+
+/** @return Cached image for key, or nullptr if there is none */
+shared_ptr<const Image>
+J2KDecodeCache::get(Key const& key)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+
+	auto i = _index.find(key);
+	if (i == _index.end()) {
+		++_misses;
+		return {};
+	}
+
+	++_hits;
+	/* Move this image to the front as it is now the most recently used */
+	_images.splice(_images.begin(), _images, i->second);
+	return i->second->second;
+}
+
+
+void
+J2KDecodeCache::put(Key const& key, shared_ptr<const Image> image)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+
+	if (_index.find(key) != _index.end()) {
+		/* Another thread got here first */
+		return;
+	}
+
+	_images.push_front(std::make_pair(key, image));
+	_index[key] = _images.begin();
+	_size += image->memory_used();
+
+	evict();
+}
+
+
+/** Remove least-recently-used images until we are within our size limit.
+ *  Must be called with a lock held on _mutex.
+ */
+void
+J2KDecodeCache::evict()
+{
+	while (_size > _maximum_size && !_images.empty()) {
+		auto const& last = _images.back();
+		_size -= last.second->memory_used();
+		_index.erase(last.first);
+		_images.pop_back();
+	}
+}
+
+
+void
+J2KDecodeCache::clear()
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	_images.clear();
+	_index.clear();
+	_size = 0;
+}
+
+
+void
+J2KDecodeCache::set_maximum_size(size_t bytes)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	_maximum_size = bytes;
+	evict();
+}
+
+
+size_t
+J2KDecodeCache::size() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	return _size;
+}
+
+
+int
+J2KDecodeCache::hits() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	return _hits;
+}
+
+
+int
+J2KDecodeCache::misses() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	return _misses;
+}
+
+
+J2KDecodeCache*
+J2KDecodeCache::instance()
+{
+	/* This may be called from many threads at once, so let the compiler make creation thread-safe */
+	static J2KDecodeCache cache;
+	/* Take our size from the config, and follow any changes to it */
+	static auto const connection = [] {
+		auto set_size = [] {
+			cache.set_maximum_size(static_cast<size_t>(Config::instance()->j2k_decode_cache_size()) * 1024 * 1024);
+		};
+		set_size();
+		return Config::instance()->Changed.connect([set_size](Config::Property property) {
+			if (property == Config::J2K_DECODE_CACHE_SIZE) {
+				set_size();
+			}
+		});
+	}();
+	return &cache;
+}
@@ -0,0 +1,107 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef DCPOMATIC_J2K_DECODE_CACHE_H
+#define DCPOMATIC_J2K_DECODE_CACHE_H
+
+
+#include "image.h"
+#include <dcp/types.h>
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+
+/** @class J2KDecodeCache
+ *  @brief A memory-limited cache of decoded JPEG2000 frames from DCPs.
+ *
+ *  Decoding JPEG2000 is slow, and when playing back a DCP we will often decode the same frames
+ *  more than once (when seeking or scrubbing back and forth over the same region).  This cache
+ *  keeps the most recently-used decoded frames so that we can avoid that.
+ *
+ *  The instance() takes its maximum size from Config::j2k_decode_cache_size(), and FilmViewer
+ *  clears it when it is given a new film.
+ */
+class J2KDecodeCache
+{
+public:
+	J2KDecodeCache() = default;
+
+	J2KDecodeCache(J2KDecodeCache const&) = delete;
+	J2KDecodeCache& operator=(J2KDecodeCache const&) = delete;
+
+	class Key
+	{
+	public:
+		Key(std::string asset_id_, int64_t frame_, boost::optional<dcp::Eye> eye_, int reduce_, Image::Alignment alignment_)
+			: asset_id(asset_id_)
+			, frame(frame_)
+			, eye(eye_)
+			, reduce(reduce_)
+			, alignment(alignment_)
+		{}
+
+		/** ID of the picture asset */
+		std::string asset_id;
+		/** frame index within the asset */
+		int64_t frame;
+		boost::optional<dcp::Eye> eye;
+		/** JPEG2000 reduction that was used when decoding */
+		int reduce;
+		Image::Alignment alignment;
+
+		bool operator<(Key const& other) const;
+	};
+
+	std::shared_ptr<const Image> get(Key const& key);
+	void put(Key const& key, std::shared_ptr<const Image> image);
+	void clear();
+
+	void set_maximum_size(size_t bytes);
+
+	/** @return total size of the images in the cache, in bytes */
+	size_t size() const;
+
+	int hits() const;
+	int misses() const;
+
+	static J2KDecodeCache* instance();
+
+private:
+	void evict();
+
+	using List = std::list<std::pair<Key, std::shared_ptr<const Image>>>;
+
+	mutable boost::mutex _mutex;
+	/** cached images, with the most recently used at the front */
+	List _images;
+	std::map<Key, List::iterator> _index;
+	size_t _size = 0;
+	size_t _maximum_size = 512 * 1024 * 1024;
+	int _hits = 0;
+	int _misses = 0;
+};
+
+
+#endif
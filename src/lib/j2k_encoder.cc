@@ -28,6 +28,7 @@
 #include "config.h"
 #include "cross.h"
 #include "dcp_video.h"
+#include "dcpomatic_assert.h"
 #include "dcpomatic_log.h"
 #include "encode_server_description.h"
 #include "encode_server_finder.h"
@@ -41,6 +42,7 @@
 #include "j2k_encoder.h"
 #include "log.h"
 #include "player_video.h"
+#include "trace.h"
 #include "util.h"
 #include "writer.h"
 #include <libcxml/cxml.h>
@@ -55,6 +57,7 @@ using std::exception;
 using std::list;
 using std::make_shared;
 using std::shared_ptr;
+using std::string;
 using std::weak_ptr;
 using boost::optional;
 using dcp::Data;
@@ -93,6 +96,7 @@ grk_plugin::IMessengerLogger* getMessengerLogger(void)
  */
 J2KEncoder::J2KEncoder(shared_ptr<const Film> film, Writer& writer)
 	: VideoEncoder(film, writer)
+	, _thread_count(0)
 #ifdef DCPOMATIC_GROK
 	, _give_up(false)
 #endif
@@ -285,19 +289,14 @@ J2KEncoder::encode (shared_ptr<PlayerVideo> pv, DCPTime time)
 
 	_waker.nudge ();
 
-	size_t threads = 0;
-	{
-		boost::mutex::scoped_lock lm (_threads_mutex);
-		threads = _threads.size();
-	}
+	int const threads = _thread_count;
 
 	boost::mutex::scoped_lock queue_lock (_queue_mutex);
 
-	/* Wait until the queue has gone down a bit.  Allow one thing in the queue even
-	   when there are no threads.
-	*/
-	while (_queue.size() >= (threads * 2) + 1) {
+	/* Wait until the queue has gone down a bit */
+	while (_queue.size() >= queue_limit(threads)) {
 		LOG_TIMING ("decoder-sleep queue=%1 threads=%2", _queue.size(), threads);
+		TraceSpan span("J2KEncoder::encode wait");
 		_full_condition.wait (queue_lock);
 		LOG_TIMING ("decoder-wake queue=%1 threads=%2", _queue.size(), threads);
 	}
@@ -336,11 +335,13 @@ J2KEncoder::encode (shared_ptr<PlayerVideo> pv, DCPTime time)
 				_film->resolution()
 				);
 		_queue.push_back (dcpv);
+		Trace::instance()->counter("J2KEncoder queue", _queue.size());
 
-		/* The queue might not be empty any more, so notify anything which is
-		   waiting on that.
+		/* The queue might not be empty any more, so wake one thread which is
+		   waiting on that; waking them all would just have them fight over
+		   _queue_mutex for the one frame.
 		*/
-		_empty_condition.notify_all ();
+		_empty_condition.notify_one ();
 	}
 
 	_last_player_video[pv->eyes()] = pv;
@@ -358,6 +359,7 @@ J2KEncoder::terminate_threads ()
 	}
 
 	_threads.clear();
+	_thread_count = 0;
 	_ending = true;
 }
 
@@ -454,6 +456,24 @@ J2KEncoder::remake_threads(int cpu, int gpu, list<EncodeServerDescription> serve
 		remove_threads(wanted_threads, current_threads, is_remote_thread);
 	}
 
+	_thread_count = _threads.size();
+	_writer.set_encoder_threads(_threads.size());
+}
+
+
+/** Start a thread of some type that remake_threads() does not know about, and add it to the others */
+void
+J2KEncoder::add_thread(shared_ptr<J2KEncoderThread> thread)
+{
+	boost::mutex::scoped_lock lm(_threads_mutex);
+	if (_ending) {
+		return;
+	}
+
+	thread->start();
+	_threads.push_back(thread);
+
+	_thread_count = _threads.size();
 	_writer.set_encoder_threads(_threads.size());
 }
 
@@ -470,12 +490,66 @@ J2KEncoder::pop()
 
 	auto vf = _queue.front();
 	_queue.pop_front();
+	Trace::instance()->counter("J2KEncoder queue", _queue.size());
 
 	_full_condition.notify_all();
 	return vf;
 }
 
 
+/** @return Number of frames that encode() will allow in the queue before waiting.  This is enough for
+ *  every thread to take frames_per_pop frames at once, and allows one frame even when there are no threads.
+ */
+size_t
+J2KEncoder::queue_limit(int threads)
+{
+	return threads * frames_per_pop + 1;
+}
+
+
+/** @return Number of frames that one thread should take from a queue of a given size.
+ *  This is one, unless there are enough frames for every thread to have a share.
+ */
+int
+J2KEncoder::batch_size(size_t queued, int threads, int maximum)
+{
+	auto const share = std::max(static_cast<int>(queued) / std::max(threads, 1), 1);
+	return std::min(share, maximum);
+}
+
+
+/** Take some frames from the head of the queue, waiting until there is at least one.
+ *  More than one frame is only returned if the queue holds enough for every encoder thread
+ *  to have a share, so taking a batch should never leave another thread idle.
+ *  @param maximum Maximum number of frames to return.
+ */
+std::vector<DCPVideo>
+J2KEncoder::pop(int maximum)
+{
+	DCPOMATIC_ASSERT(maximum > 0);
+
+	boost::mutex::scoped_lock lock(_queue_mutex);
+	while (_queue.empty()) {
+		_empty_condition.wait(lock);
+	}
+
+	LOG_TIMING("encoder-wake thread=%1 queue=%2", thread_id(), _queue.size());
+
+	auto const count = batch_size(_queue.size(), _thread_count, maximum);
+
+	std::vector<DCPVideo> frames;
+	frames.reserve(count);
+	for (int i = 0; i < count; ++i) {
+		frames.push_back(_queue.front());
+		_queue.pop_front();
+	}
+	Trace::instance()->counter("J2KEncoder queue", _queue.size());
+
+	_full_condition.notify_all();
+	return frames;
+}
+
+
 void
 J2KEncoder::retry(DCPVideo video)
 {
@@ -500,7 +574,7 @@ J2KEncoder::retry(DCPVideo video)
 	{
 		boost::mutex::scoped_lock lock(_queue_mutex);
 		_queue.push_front(video);
-		_empty_condition.notify_all();
+		_empty_condition.notify_one();
 	}
 }
 
@@ -511,3 +585,39 @@ J2KEncoder::write(shared_ptr<const dcp::Data> data, int index, Eyes eyes)
 	_writer.write(data, index, eyes);
 	frame_done();
 }
+
+
+/** Called by a remote encoder thread when a server has sent back an encoded frame.
+ *  @param latency Time between sending the frame and receiving it back, in seconds.
+ */
+void
+J2KEncoder::remote_frame_encoded(string const& host_name, double latency)
+{
+	boost::mutex::scoped_lock lm(_server_counters_mutex);
+	auto& counters = _server_counters[host_name];
+	if (!counters) {
+		counters = make_shared<ServerCounters>();
+	}
+	++counters->frames;
+	counters->latency += latency;
+	counters->history.event();
+}
+
+
+std::vector<EncodeServerStatistics>
+J2KEncoder::server_statistics() const
+{
+	boost::mutex::scoped_lock lm(_server_counters_mutex);
+
+	std::vector<EncodeServerStatistics> statistics;
+	for (auto const& i: _server_counters) {
+		EncodeServerStatistics s;
+		s.host_name = i.first;
+		s.frames = i.second->frames;
+		s.latency = i.second->latency / i.second->frames;
+		s.rate = i.second->history.rate();
+		statistics.push_back(s);
+	}
+
+	return statistics;
+}
@@ -40,7 +40,11 @@
 #include <boost/thread.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/thread/mutex.hpp>
+#include <atomic>
+#include <deque>
 #include <list>
+#include <map>
+#include <vector>
 #include <stdint.h>
 
 
@@ -58,6 +62,8 @@ namespace grk_plugin {
 struct local_threads_created_and_destroyed;
 struct remote_threads_created_and_destroyed;
 struct frames_not_lost_when_threads_disappear;
+struct j2k_encoder_batch_test;
+struct j2k_encoder_queue_throughput_test;
 
 
 /** @class J2KEncoder
@@ -88,24 +94,39 @@ public:
 	void end() override;
 
 	DCPVideo pop();
+	std::vector<DCPVideo> pop(int maximum);
 	void retry(DCPVideo frame);
 	void write(std::shared_ptr<const dcp::Data> data, int index, Eyes eyes);
 
+	void remote_frame_encoded(std::string const& host_name, double latency);
+	std::vector<EncodeServerStatistics> server_statistics() const override;
+
+	/** Maximum number of frames that an encoder thread should take from the queue at once */
+	static int constexpr frames_per_pop = 4;
+
 private:
 	friend struct ::local_threads_created_and_destroyed;
 	friend struct ::remote_threads_created_and_destroyed;
 	friend struct ::frames_not_lost_when_threads_disappear;
+	friend struct ::j2k_encoder_batch_test;
+	friend struct ::j2k_encoder_queue_throughput_test;
+
+	static size_t queue_limit(int threads);
+	static int batch_size(size_t queued, int threads, int maximum);
 
 	void frame_done ();
 	void servers_list_changed ();
 	void remake_threads(int cpu, int gpu, std::list<EncodeServerDescription> servers);
+	void add_thread(std::shared_ptr<J2KEncoderThread> thread);
 	void terminate_threads ();
 
 	boost::mutex _threads_mutex;
 	std::vector<std::shared_ptr<J2KEncoderThread>> _threads;
+	/** copy of _threads.size() which can be read without taking _threads_mutex */
+	std::atomic<int> _thread_count;
 
 	mutable boost::mutex _queue_mutex;
-	std::list<DCPVideo> _queue;
+	std::deque<DCPVideo> _queue;
 	/** condition to manage thread wakeups when we have nothing to do */
 	boost::condition _empty_condition;
 	/** condition to manage thread wakeups when we have too much to do */
@@ -117,6 +138,21 @@ private:
 
 	boost::signals2::scoped_connection _server_found_connection;
 
+	struct ServerCounters
+	{
+		ServerCounters()
+			: history(16)
+		{}
+
+		int frames = 0;
+		/** total latency of all frames, in seconds */
+		double latency = 0;
+		EventHistory history;
+	};
+
+	mutable boost::mutex _server_counters_mutex;
+	std::map<std::string, std::shared_ptr<ServerCounters>> _server_counters;
+
 #ifdef DCPOMATIC_GROK
 	grk_plugin::DcpomaticContext* _dcpomatic_context = nullptr;
 	grk_plugin::GrokContext *_context = nullptr;
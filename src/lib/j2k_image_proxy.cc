@@ -22,6 +22,8 @@
 #include "dcpomatic_assert.h"
 #include "dcpomatic_socket.h"
 #include "image.h"
+#include "interleave.h"
+#include "j2k_decode_cache.h"
 #include "j2k_image_proxy.h"
 #include <dcp/colour_conversion.h>
 #include <dcp/j2k_transcode.h>
@@ -139,10 +141,21 @@ J2KImageProxy::prepare (Image::Alignment alignment, optional<dcp::Size> target_s
 		reduce = max (0, reduce);
 	}
 
+	optional<J2KDecodeCache::Key> cache_key;
+	if (_asset_id) {
+		cache_key = J2KDecodeCache::Key(*_asset_id, _frame, _eye, reduce, alignment);
+		if (auto cached = J2KDecodeCache::instance()->get(*cache_key)) {
+			_image = cached;
+			_target_size = target_size;
+			_reduce = reduce;
+			return reduce;
+		}
+	}
+
 	try {
 		/* XXX: should check that potentially trashing _data here doesn't matter */
 		auto decompressed = dcp::decompress_j2k (const_cast<uint8_t*>(_data->data()), _data->size(), reduce);
-		_image = make_shared<Image>(_pixel_format, decompressed->size(), alignment);
+		auto image = make_shared<Image>(_pixel_format, decompressed->size(), alignment);
 
 		int const shift = 16 - decompressed->precision (0);
 
@@ -152,22 +165,23 @@ J2KImageProxy::prepare (Image::Alignment alignment, optional<dcp::Size> target_s
 
 		int const width = decompressed->size().width;
 
-		int p = 0;
 		int* decomp_0 = decompressed->data (0);
 		int* decomp_1 = decompressed->data (1);
 		int* decomp_2 = decompressed->data (2);
 		for (int y = 0; y < decompressed->size().height; ++y) {
-			auto q = reinterpret_cast<uint16_t *>(_image->data()[0] + y * _image->stride()[0]);
-			for (int x = 0; x < width; ++x) {
-				*q++ = decomp_0[p] << shift;
-				*q++ = decomp_1[p] << shift;
-				*q++ = decomp_2[p] << shift;
-				++p;
-			}
+			auto q = reinterpret_cast<uint16_t *>(image->data()[0] + y * image->stride()[0]);
+			int const p = y * width;
+			dcpomatic::interleave_to_uint16(decomp_0 + p, decomp_1 + p, decomp_2 + p, q, width, shift);
+		}
+
+		_image = image;
+		if (cache_key) {
+			J2KDecodeCache::instance()->put(*cache_key, image);
 		}
 	} catch (dcp::J2KDecompressionError& e) {
-		_image = make_shared<Image>(_pixel_format, _size, alignment);
-		_image->make_black ();
+		auto image = make_shared<Image>(_pixel_format, _size, alignment);
+		image->make_black ();
+		_image = image;
 		_error = true;
 	}
 
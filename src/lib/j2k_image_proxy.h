@@ -79,13 +79,27 @@ public:
 		return _eye;
 	}
 
+	/** Say where our JPEG2000 data came from, so that decoded images can be shared
+	 *  with other J2KImageProxy objects for the same frame using J2KDecodeCache.
+	 *  @param asset_id ID of the picture asset.
+	 *  @param frame Index of the frame within the asset.
+	 */
+	void set_source(std::string asset_id, int64_t frame) {
+		_asset_id = asset_id;
+		_frame = frame;
+	}
+
 	size_t memory_used () const override;
 
 private:
 	std::shared_ptr<const dcp::Data> _data;
 	dcp::Size _size;
 	boost::optional<dcp::Eye> _eye;
-	mutable std::shared_ptr<Image> _image;
+	/** ID of the asset that our data came from, if known */
+	boost::optional<std::string> _asset_id;
+	/** Index of our frame within _asset_id */
+	int64_t _frame = 0;
+	mutable std::shared_ptr<const Image> _image;
 	mutable boost::optional<dcp::Size> _target_size;
 	mutable boost::optional<int> _reduce;
 	AVPixelFormat _pixel_format;
@@ -23,6 +23,7 @@
 #include "dcpomatic_log.h"
 #include "j2k_encoder.h"
 #include "j2k_sync_encoder_thread.h"
+#include "trace.h"
 #include <dcp/scope_guard.h>
 
 
@@ -41,21 +42,41 @@ try
 
 	while (true) {
 		LOG_TIMING("encoder-sleep thread=%1", thread_id());
-		auto frame = _encoder.pop();
+		std::vector<DCPVideo> frames;
+		{
+			TraceSpan span("J2KEncoder::pop");
+			frames = _encoder.pop(J2KEncoder::frames_per_pop);
+		}
+
+		/* Index into frames of the first one that we have not yet written or retried */
+		size_t next = 0;
 
-		dcp::ScopeGuard frame_guard([this, &frame]() {
+		dcp::ScopeGuard frames_guard([this, &frames, &next]() {
 			boost::this_thread::disable_interruption dis;
-			_encoder.retry(frame);
+			/* retry() puts frames back at the head of the queue, so go backwards to keep them in order */
+			for (auto i = frames.size(); i > next; --i) {
+				_encoder.retry(frames[i - 1]);
+			}
 		});
 
-		LOG_TIMING("encoder-pop thread=%1 frame=%2 eyes=%3", thread_id(), frame.index(), static_cast<int>(frame.eyes()));
+		start_batch(frames);
+
+		for (auto const& frame: frames) {
+			LOG_TIMING("encoder-pop thread=%1 frame=%2 eyes=%3", thread_id(), frame.index(), static_cast<int>(frame.eyes()));
 
-		auto encoded = encode(frame);
+			std::shared_ptr<dcp::ArrayData> encoded;
+			{
+				TraceSpan span("encode", frame.index());
+				encoded = encode(frame);
+			}
 
-		if (encoded) {
 			boost::this_thread::disable_interruption dis;
-			frame_guard.cancel();
-			_encoder.write(encoded, frame.index(), frame.eyes());
+			if (encoded) {
+				_encoder.write(encoded, frame.index(), frame.eyes());
+			} else {
+				_encoder.retry(frame);
+			}
+			++next;
 		}
 	}
 } catch (boost::thread_interrupted& e) {
@@ -6,6 +6,7 @@
 #include "j2k_encoder_thread.h"
 #include <dcp/array_data.h>
 #include <boost/thread.hpp>
+#include <vector>
 
 
 class DCPVideo;
@@ -25,6 +26,8 @@ public:
 	void run() override;
 
 	virtual void log_thread_start() const = 0;
+	/** Called with each batch of frames that we take from the queue, before encode() is called for each of them */
+	virtual void start_batch(std::vector<DCPVideo> const&) {}
 	virtual std::shared_ptr<dcp::ArrayData> encode(DCPVideo const& frame) = 0;
 };
 
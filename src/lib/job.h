@@ -61,6 +61,19 @@ public:
 		return false;
 	}
 
+	/** The main resource that a job uses; JobManager limits the number of jobs
+	 *  of each class which run at the same time.
+	 */
+	enum class ResourceClass {
+		CPU,   ///< e.g. transcoding
+		IO,    ///< e.g. examining content, verifying or copying DCPs
+		LIGHT  ///< e.g. sending emails
+	};
+
+	virtual ResourceClass resource_class () const {
+		return ResourceClass::CPU;
+	}
+
 	void start ();
 	virtual void pause() {}
 	bool pause_by_user ();
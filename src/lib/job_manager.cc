@@ -26,23 +26,27 @@
 
 #include "analyse_audio_job.h"
 #include "analyse_subtitles_job.h"
+#include "config.h"
 #include "cross.h"
 #include "film.h"
 #include "job.h"
 #include "job_manager.h"
 #include "util.h"
 #include <boost/thread.hpp>
+#include <map>
+#include <set>
 
 
 using std::dynamic_pointer_cast;
 using std::function;
 using std::list;
 using std::make_shared;
+using std::map;
 using std::shared_ptr;
 using std::string;
+using std::set;
 using std::weak_ptr;
 using boost::bind;
-using boost::optional;
 
 
 JobManager* JobManager::_instance = nullptr;
@@ -164,27 +168,44 @@ JobManager::scheduler ()
 			break;
 		}
 
-		bool have_running = false;
+		/* Number of jobs of each resource class that we have allowed to run */
+		map<Job::ResourceClass, int> running;
+		/* Films which have a job earlier in the list that has yet to finish */
+		set<shared_ptr<const Film>> busy_films;
+
 		for (auto i: _jobs) {
-			if ((have_running || _paused) && i->running()) {
-				/* We already have a running job, or are totally paused, so this job should not be running */
-				i->pause_by_priority();
-			} else if (!have_running && !_paused && (i->is_new() || i->paused_by_priority())) {
-				/* We don't have a running job, and we should have one, so start/resume this */
+			auto const film = i->film();
+			bool const film_busy = film && busy_films.find(film) != busy_films.end();
+			if (film && !i->finished() && !i->paused_by_user()) {
+				busy_films.insert(film);
+			}
+
+			auto& count = running[i->resource_class()];
+			bool const can_run = !_paused && !film_busy && count < maximum_jobs(i->resource_class());
+
+			if (i->running()) {
+				if (can_run) {
+					++count;
+				} else {
+					/* We have enough jobs of this type running, we are totally paused, or
+					 * an earlier job for this film needs to go first, so this job should not be running.
+					 */
+					i->pause_by_priority();
+				}
+			} else if (can_run && (i->is_new() || i->paused_by_priority())) {
+				/* There is room for this job, so start/resume it */
 				if (i->is_new()) {
-					_connections.push_back (i->FinishedImmediate.connect(bind(&JobManager::job_finished, this)));
+					_connections.push_back(i->FinishedImmediate.connect(bind(&JobManager::job_finished, this)));
 					i->start ();
 				} else {
 					i->resume ();
 				}
-				emit (boost::bind (boost::ref (ActiveJobsChanged), _last_active_job, i->json_name()));
-				_last_active_job = i->json_name ();
-				have_running = true;
-			} else if (!have_running && i->running()) {
-				have_running = true;
+				++count;
 			}
 		}
 
+		update_active_jobs();
+
 		_schedule_condition.wait(lm);
 	}
 }
@@ -195,14 +216,52 @@ JobManager::job_finished ()
 {
 	{
 		boost::mutex::scoped_lock lm (_mutex);
-		emit (boost::bind(boost::ref (ActiveJobsChanged), _last_active_job, optional<string>()));
-		_last_active_job = optional<string>();
+		update_active_jobs();
 	}
 
 	_schedule_condition.notify_all();
 }
 
 
+/** Emit ActiveJobsChanged if the set of running jobs is not what it was when we last did so.
+ *  Must be called with a lock held on _mutex.
+ */
+void
+JobManager::update_active_jobs ()
+{
+	set<string> active;
+	for (auto i: _jobs) {
+		if (i->running()) {
+			active.insert(i->json_name());
+		}
+	}
+
+	if (active != _active_jobs) {
+		emit(boost::bind(boost::ref(ActiveJobsChanged), _active_jobs, active));
+		_active_jobs = active;
+	}
+}
+
+
+int
+JobManager::maximum_jobs (Job::ResourceClass resource_class) const
+{
+	auto config = Config::instance();
+
+	switch (resource_class) {
+	case Job::ResourceClass::CPU:
+		return std::max(1, config->maximum_cpu_jobs());
+	case Job::ResourceClass::IO:
+		return std::max(1, config->maximum_io_jobs());
+	case Job::ResourceClass::LIGHT:
+		return std::max(1, config->maximum_light_jobs());
+	}
+
+	DCPOMATIC_ASSERT (false);
+	return 1;
+}
+
+
 JobManager *
 JobManager::instance ()
 {
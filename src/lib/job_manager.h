@@ -31,6 +31,7 @@
 #include <boost/signals2.hpp>
 #include <boost/thread/condition.hpp>
 #include <list>
+#include <set>
 
 
 class Film;
@@ -44,6 +45,10 @@ extern bool wait_for_jobs ();
 
 /** @class JobManager
  *  @brief A simple scheduler for jobs.
+ *
+ *  Jobs are run in priority order (the order of _jobs).  Jobs with different
+ *  Job::ResourceClass can run at the same time, up to limits from Config, but
+ *  jobs for the same film are always run one after another.
  */
 class JobManager : public Signaller
 {
@@ -82,7 +87,10 @@ public:
 
 	boost::signals2::signal<void (std::weak_ptr<Job>)> JobAdded;
 	boost::signals2::signal<void ()> JobsReordered;
-	boost::signals2::signal<void (boost::optional<std::string>, boost::optional<std::string>)> ActiveJobsChanged;
+	/** Emitted when the set of running jobs changes, with the json_name()s of the jobs
+	 *  that were running before the change and of those that are running now.
+	 */
+	boost::signals2::signal<void (std::set<std::string>, std::set<std::string>)> ActiveJobsChanged;
 
 	static JobManager* instance ();
 	static void drop ();
@@ -97,6 +105,8 @@ private:
 	void scheduler ();
 	void start ();
 	void job_finished ();
+	void update_active_jobs ();
+	int maximum_jobs (Job::ResourceClass resource_class) const;
 
 	mutable boost::mutex _mutex;
 	boost::condition _schedule_condition;
@@ -105,7 +115,8 @@ private:
 	std::list<boost::signals2::connection> _connections;
 	bool _terminate = false;
 
-	boost::optional<std::string> _last_active_job;
+	/** json_name()s of the jobs that were running when we last emitted ActiveJobsChanged */
+	std::set<std::string> _active_jobs;
 	boost::thread _scheduler;
 
 	/** true if all jobs should be paused */
@@ -41,6 +41,7 @@ using std::string;
 
 
 Log::Log ()
+	: _types (0)
 {
 
 }
@@ -49,12 +50,11 @@ Log::Log ()
 void
 Log::log (shared_ptr<const LogEntry> e)
 {
-	boost::mutex::scoped_lock lm (_mutex);
-
 	if ((_types & e->type()) == 0) {
 		return;
 	}
 
+	boost::mutex::scoped_lock lm (_mutex);
 	do_log (e);
 }
 
@@ -63,14 +63,13 @@ Log::log (shared_ptr<const LogEntry> e)
 void
 Log::log (string message, int type)
 {
-	boost::mutex::scoped_lock lm (_mutex);
-
 	if ((_types & type) == 0) {
 		return;
 	}
 
 	auto e = make_shared<StringLogEntry>(type, message);
 
+	boost::mutex::scoped_lock lm (_mutex);
 	do_log (e);
 }
 
@@ -78,6 +77,8 @@ Log::log (string message, int type)
 void
 Log::dcp_log (dcp::NoteType type, string m)
 {
+	boost::mutex::scoped_lock lm (_mutex);
+
 	switch (type) {
 	case dcp::NoteType::PROGRESS:
 		do_log (make_shared<StringLogEntry>(LogEntry::TYPE_GENERAL, m));
@@ -95,6 +96,5 @@ Log::dcp_log (dcp::NoteType type, string m)
 void
 Log::set_types (int t)
 {
-	boost::mutex::scoped_lock lm (_mutex);
 	_types = t;
 }
@@ -33,6 +33,7 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/signals2.hpp>
+#include <atomic>
 #include <string>
 
 
@@ -53,6 +54,9 @@ public:
 	void dcp_log (dcp::NoteType type, std::string message);
 
 	void set_types (int types);
+	/** This is safe to call without a lock, and is called by the LOG_* macros to
+	 *  decide whether it is worth formatting a message.
+	 */
 	int types () const {
 		return _types;
 	}
@@ -74,7 +78,7 @@ private:
 	virtual void do_log (std::shared_ptr<const LogEntry> entry) = 0;
 
 	/** bit-field of log types which should be put into the log (others are ignored) */
-	int _types = 0;
+	std::atomic<int> _types;
 };
 
 
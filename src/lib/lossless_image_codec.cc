@@ -0,0 +1,188 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "compose.hpp"
+#include "dcpomatic_assert.h"
+#include "exceptions.h"
+#include "ffmpeg_wrapper.h"
+#include "image.h"
+#include "lossless_image_codec.h"
+#include <dcp/scope_guard.h>
+#include <dcp/warnings.h>
+LIBDCP_DISABLE_WARNINGS
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+LIBDCP_ENABLE_WARNINGS
+#include <boost/thread/mutex.hpp>
+#include <cstring>
+#include <set>
+
+#include "i18n.h"
+
+
+using std::make_shared;
+using std::shared_ptr;
+
+
+/** Pixel formats that FFV1 has refused to open with, so that we don't keep trying */
+static boost::mutex unsupported_mutex;
+static std::set<AVPixelFormat> unsupported;
+
+
+/** Compress an image with FFV1.
+ *  @return Compressed data, or nullptr if the image's pixel format is not supported by FFV1.
+ */
+shared_ptr<ffmpeg::Packet>
+lossless_compress_image(Image const& image)
+{
+	auto constexpr name_for_errors = "lossless_compress_image";
+
+	{
+		boost::mutex::scoped_lock lm(unsupported_mutex);
+		if (unsupported.find(image.pixel_format()) != unsupported.end()) {
+			return {};
+		}
+	}
+
+	auto codec = avcodec_find_encoder(AV_CODEC_ID_FFV1);
+	if (!codec) {
+		return {};
+	}
+
+	auto context = avcodec_alloc_context3(codec);
+	if (!context) {
+		throw std::bad_alloc();
+	}
+
+	dcp::ScopeGuard sg = [&context]() { avcodec_free_context(&context); };
+
+	context->width = image.size().width;
+	context->height = image.size().height;
+	context->pix_fmt = image.pixel_format();
+	context->time_base = { 1, 24 };
+	/* Each encoder thread compresses its own images, so there's no need for more threads here */
+	context->thread_count = 1;
+
+	if (avcodec_open2(context, codec, nullptr) < 0) {
+		/* Most likely FFV1 does not support this pixel format */
+		boost::mutex::scoped_lock lm(unsupported_mutex);
+		unsupported.insert(image.pixel_format());
+		return {};
+	}
+
+	auto frame = av_frame_alloc();
+	if (!frame) {
+		throw std::bad_alloc();
+	}
+
+	dcp::ScopeGuard fg = [&frame]() { av_frame_free(&frame); };
+
+	frame->width = image.size().width;
+	frame->height = image.size().height;
+	frame->format = image.pixel_format();
+	for (int i = 0; i < image.planes(); ++i) {
+		frame->data[i] = image.data()[i];
+		/* AVFrame's linesize is what we call `stride' */
+		frame->linesize[i] = image.stride()[i];
+	}
+
+	int r = avcodec_send_frame(context, frame);
+	if (r < 0) {
+		throw EncodeError(N_("avcodec_send_frame"), name_for_errors, r);
+	}
+
+	r = avcodec_send_frame(context, nullptr);
+	if (r < 0) {
+		throw EncodeError(N_("avcodec_send_frame"), name_for_errors, r);
+	}
+
+	auto packet = make_shared<ffmpeg::Packet>();
+	r = avcodec_receive_packet(context, packet->get());
+	if (r < 0) {
+		throw EncodeError(N_("avcodec_receive_packet"), name_for_errors, r);
+	}
+
+	return packet;
+}
+
+
+/** Decompress some data made by lossless_compress_image() into an Image.
+ *  @param packet Compressed data.
+ *  @param image Image to write to; this must have the same size and pixel format as the one that was compressed.
+ */
+void
+lossless_decompress_image(ffmpeg::Packet const& packet, Image& image)
+{
+	auto constexpr name_for_errors = "lossless_decompress_image";
+
+	auto codec = avcodec_find_decoder(AV_CODEC_ID_FFV1);
+	DCPOMATIC_ASSERT(codec);
+
+	auto context = avcodec_alloc_context3(codec);
+	if (!context) {
+		throw std::bad_alloc();
+	}
+
+	dcp::ScopeGuard sg = [&context]() { avcodec_free_context(&context); };
+
+	context->width = image.size().width;
+	context->height = image.size().height;
+	context->pix_fmt = image.pixel_format();
+	context->thread_count = 1;
+
+	int r = avcodec_open2(context, codec, nullptr);
+	if (r < 0) {
+		throw DecodeError(N_("avcodec_open2"), name_for_errors, r);
+	}
+
+	auto frame = av_frame_alloc();
+	if (!frame) {
+		throw std::bad_alloc();
+	}
+
+	dcp::ScopeGuard fg = [&frame]() { av_frame_free(&frame); };
+
+	r = avcodec_send_packet(context, packet.get());
+	if (r < 0) {
+		throw DecodeError(N_("avcodec_send_packet"), name_for_errors, r);
+	}
+
+	r = avcodec_receive_frame(context, frame);
+	if (r < 0) {
+		throw DecodeError(N_("avcodec_receive_frame"), name_for_errors, r);
+	}
+
+	if (frame->width != image.size().width || frame->height != image.size().height || frame->format != image.pixel_format()) {
+		throw DecodeError(String::compose(_("Unexpected image received (%1x%2 format %3)"), frame->width, frame->height, frame->format));
+	}
+
+	for (int i = 0; i < image.planes(); ++i) {
+		uint8_t* p = image.data()[i];
+		uint8_t const* q = frame->data[i];
+		int const lines = image.sample_size(i).height;
+		for (int j = 0; j < lines; ++j) {
+			memcpy(p, q, image.line_size()[i]);
+			p += image.stride()[i];
+			q += frame->linesize[i];
+		}
+	}
+}
@@ -0,0 +1,47 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  src/lib/lossless_image_codec.h
+ *  @brief Functions to losslessly compress and decompress Images.
+ *
+ *  These are used to reduce the amount of data that must be sent to encode servers.
+ */
+
+
+#ifndef DCPOMATIC_LOSSLESS_IMAGE_CODEC_H
+#define DCPOMATIC_LOSSLESS_IMAGE_CODEC_H
+
+
+#include <memory>
+
+
+class Image;
+
+namespace ffmpeg {
+	class Packet;
+}
+
+
+extern std::shared_ptr<ffmpeg::Packet> lossless_compress_image(Image const& image);
+extern void lossless_decompress_image(ffmpeg::Packet const& packet, Image& image);
+
+
+#endif
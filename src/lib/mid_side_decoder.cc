@@ -65,7 +65,7 @@ shared_ptr<AudioBuffers>
 MidSideDecoder::run (shared_ptr<const AudioBuffers> in, int channels)
 {
 	int const N = min (channels, 3);
-	auto out = make_shared<AudioBuffers>(channels, in->frames ());
+	auto out = make_shared<AudioBuffers>(channels, in->frames(), AudioBuffers::Contents::UNDEFINED);
 	for (int i = 0; i < in->frames(); ++i) {
 		auto const left = in->data()[0][i];
 		auto const right = in->data()[1][i];
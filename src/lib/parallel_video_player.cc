@@ -0,0 +1,243 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "dcp_content.h"
+#include "dcpomatic_assert.h"
+#include "film.h"
+#include "parallel_video_player.h"
+#include "player.h"
+#include "player_video.h"
+#include "text_content.h"
+#include "util.h"
+#include <stdexcept>
+
+
+using std::dynamic_pointer_cast;
+using std::make_pair;
+using std::pair;
+using std::shared_ptr;
+using boost::optional;
+using namespace dcpomatic;
+
+
+/** @param film Film to play.
+ *  @param threads Number of threads (and hence Players) to use.
+ *  @param chunk_length Approximate length of each of the chunks that the timeline is split into.
+ *  Each reel is split into chunks of equal length, so no chunk crosses a reel boundary.
+ *  @param frames_per_chunk Maximum number of frames to hold in memory for each chunk.
+ */
+ParallelVideoPlayer::ParallelVideoPlayer(shared_ptr<const Film> film, int threads, DCPTime chunk_length, int frames_per_chunk)
+	: _film(film)
+	, _threads(threads)
+	, _frames_per_chunk(frames_per_chunk)
+{
+	DCPOMATIC_ASSERT(threads > 0);
+	DCPOMATIC_ASSERT(chunk_length > DCPTime());
+	DCPOMATIC_ASSERT(frames_per_chunk > 0);
+
+	auto const rate = film->video_frame_rate();
+	auto const length_frames = std::max(chunk_length.frames_round(rate), static_cast<Frame>(1));
+
+	for (auto reel: film->reels()) {
+		auto const reel_frames = reel.duration().frames_round(rate);
+		auto const chunks = std::max((reel_frames + length_frames / 2) / length_frames, static_cast<Frame>(1));
+		for (Frame i = 0; i < chunks; ++i) {
+			_chunks.emplace_back(
+				DCPTimePeriod(
+					reel.from + DCPTime::from_frames(reel_frames * i / chunks, rate),
+					i == chunks - 1 ? reel.to : reel.from + DCPTime::from_frames(reel_frames * (i + 1) / chunks, rate)
+					)
+				);
+		}
+	}
+
+	for (int i = 0; i < threads; ++i) {
+		_workers.push_back(boost::thread(boost::bind(&ParallelVideoPlayer::thread, this, i)));
+#ifdef DCPOMATIC_LINUX
+		pthread_setname_np(_workers.back().native_handle(), "parallel-player");
+#endif
+	}
+}
+
+
+ParallelVideoPlayer::~ParallelVideoPlayer()
+{
+	boost::this_thread::disable_interruption dis;
+
+	{
+		boost::mutex::scoped_lock lm(_mutex);
+		_stop = true;
+		_condition.notify_all();
+	}
+
+	for (auto& worker: _workers) {
+		try {
+			worker.join();
+		} catch (...) {}
+	}
+}
+
+
+/** @return true if this class can make the same video for a film as a single Player would.  This is not the
+ *  case if there are burnt-in subtitles, as they might start before a chunk and so be missed by the Player
+ *  working on it, or if any video is referenced from another DCP.
+ */
+bool
+ParallelVideoPlayer::suitable(shared_ptr<const Film> film)
+{
+	for (auto content: film->content()) {
+		for (auto text: content->text) {
+			if (text->use() && text->burn()) {
+				return false;
+			}
+		}
+		auto dcp = dynamic_pointer_cast<const DCPContent>(content);
+		if (dcp && dcp->reference_video()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+void
+ParallelVideoPlayer::thread(int index)
+try
+{
+	start_of_thread("ParallelVideoPlayer");
+
+	auto film = _film.lock();
+	DCPOMATIC_ASSERT(film);
+
+	Player player(film, Image::Alignment::PADDED);
+	player.set_ignore_audio();
+	player.set_ignore_text();
+
+	size_t chunk = index;
+	bool chunk_finished = false;
+
+	boost::signals2::scoped_connection connection = player.Video.connect(
+		[this, &chunk, &chunk_finished](shared_ptr<PlayerVideo> video, DCPTime time) {
+			boost::mutex::scoped_lock lm(_mutex);
+			auto& c = _chunks[chunk];
+			if (time >= c.period.to) {
+				chunk_finished = true;
+			} else if (time >= c.period.from) {
+				/* Wait for get() to take some of this chunk's video if we already have enough */
+				while (!_stop && c.video.size() >= _frames_per_chunk) {
+					_condition.wait(lm);
+				}
+				c.video.push_back(make_pair(video, time));
+				_condition.notify_all();
+			}
+		});
+
+	for (; chunk < _chunks.size(); chunk += _threads) {
+		{
+			boost::mutex::scoped_lock lm(_mutex);
+			/* Wait until this chunk is close enough to the one that is being consumed */
+			while (!_stop && chunk >= _next_chunk + _threads) {
+				_condition.wait(lm);
+			}
+			if (_stop) {
+				return;
+			}
+		}
+
+		player.seek(_chunks[chunk].period.from, true);
+		chunk_finished = false;
+		while (!chunk_finished && !player.pass()) {
+			boost::mutex::scoped_lock lm(_mutex);
+			if (_stop) {
+				return;
+			}
+		}
+
+		boost::mutex::scoped_lock lm(_mutex);
+		_chunks[chunk].done = true;
+		_condition.notify_all();
+	}
+}
+catch (...)
+{
+	store_current();
+	boost::mutex::scoped_lock lm(_mutex);
+	_died = true;
+	_condition.notify_all();
+}
+
+
+/** Get the next video frame in the film.  Any exception thrown by one of the threads will be
+ *  re-thrown from here.
+ *  @param wait true to wait until the next frame is ready.
+ *  @return Next frame and its time, or none if there are no more frames or if the next one
+ *  is not ready yet and wait is false.
+ */
+optional<pair<shared_ptr<PlayerVideo>, DCPTime>>
+ParallelVideoPlayer::get(bool wait)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+
+	while (true) {
+		if (_died) {
+			lm.unlock();
+			rethrow();
+			/* rethrow() only throws once, so carry on throwing something if we are called again */
+			throw std::runtime_error("ParallelVideoPlayer thread died");
+		}
+
+		if (_next_chunk == _chunks.size()) {
+			return {};
+		}
+
+		auto& chunk = _chunks[_next_chunk];
+		if (!chunk.video.empty()) {
+			auto video = chunk.video.front();
+			chunk.video.pop_front();
+			/* The worker on this chunk may be waiting for space */
+			_condition.notify_all();
+			return video;
+		}
+
+		if (chunk.done) {
+			++_next_chunk;
+			/* Another worker can start on a new chunk */
+			_condition.notify_all();
+			continue;
+		}
+
+		if (!wait) {
+			return {};
+		}
+
+		_condition.wait(lm);
+	}
+}
+
+
+/** @return true if get() has returned every frame in the film */
+bool
+ParallelVideoPlayer::finished() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	return _next_chunk == _chunks.size();
+}
@@ -0,0 +1,101 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef DCPOMATIC_PARALLEL_VIDEO_PLAYER_H
+#define DCPOMATIC_PARALLEL_VIDEO_PLAYER_H
+
+
+#include "dcpomatic_time.h"
+#include "exception_store.h"
+#include <boost/optional.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+#include <list>
+#include <memory>
+#include <vector>
+
+
+class Film;
+class PlayerVideo;
+
+
+/** @class ParallelVideoPlayer
+ *  @brief Some threads which each run a Player to make the video for a film, and a way to
+ *  get that video back in order.
+ *
+ *  Each reel of the film is split into short chunks which are shared out between the threads in turn;
+ *  each thread seeks its Player to the start of a chunk, passes it until the chunk is finished,
+ *  then moves on to its next.  Threads are only allowed to work a certain number of chunks ahead
+ *  of the one that get() is returning video from, and a thread waits when it has made a certain
+ *  number of frames that get() has not yet taken, so the memory used is limited to that many frames
+ *  for each thread.
+ *
+ *  Only video is made here; the caller must get audio, text and so on from a Player of its own.
+ */
+class ParallelVideoPlayer : public ExceptionStore
+{
+public:
+	ParallelVideoPlayer(std::shared_ptr<const Film> film, int threads, dcpomatic::DCPTime chunk_length, int frames_per_chunk);
+	~ParallelVideoPlayer();
+
+	ParallelVideoPlayer(ParallelVideoPlayer const&) = delete;
+	ParallelVideoPlayer& operator=(ParallelVideoPlayer const&) = delete;
+
+	boost::optional<std::pair<std::shared_ptr<PlayerVideo>, dcpomatic::DCPTime>> get(bool wait);
+	bool finished() const;
+
+	static bool suitable(std::shared_ptr<const Film> film);
+
+private:
+	void thread(int index);
+
+	struct Chunk
+	{
+		explicit Chunk(dcpomatic::DCPTimePeriod period_)
+			: period(period_)
+		{}
+
+		dcpomatic::DCPTimePeriod period;
+		std::list<std::pair<std::shared_ptr<PlayerVideo>, dcpomatic::DCPTime>> video;
+		bool done = false;
+	};
+
+	std::weak_ptr<const Film> _film;
+	int const _threads;
+	/** maximum number of frames to hold for each chunk */
+	size_t const _frames_per_chunk;
+
+	mutable boost::mutex _mutex;
+	/** Condition which is signalled when video is added to or taken from a chunk, a chunk
+	 *  is finished or when get() moves on to a new chunk.
+	 */
+	boost::condition _condition;
+	std::vector<Chunk> _chunks;
+	/** index of the chunk that get() is currently returning video from */
+	size_t _next_chunk = 0;
+	bool _stop = false;
+	bool _died = false;
+
+	std::vector<boost::thread> _workers;
+};
+
+
+#endif
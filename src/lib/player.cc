@@ -52,6 +52,7 @@
 #include "text_content.h"
 #include "text_decoder.h"
 #include "timer.h"
+#include "trace.h"
 #include "video_decoder.h"
 #include <dcp/reel.h>
 #include <dcp/reel_picture_asset.h>
@@ -260,6 +261,9 @@ Player::setup_pieces ()
 	auto old_pieces = _pieces;
 	_pieces.clear ();
 
+	/* Fonts may have changed */
+	_rendered_text_cache.clear();
+
 	auto film = _film.lock();
 	if (!film) {
 		return;
@@ -720,6 +724,7 @@ Player::earliest_piece_and_time() const
 bool
 Player::pass ()
 {
+	TraceSpan span("Player::pass");
 	boost::mutex::scoped_lock lm (_mutex);
 
 	if (_suspended) {
@@ -769,6 +774,7 @@ Player::pass ()
 	case CONTENT:
 	{
 		LOG_DEBUG_PLAYER ("Calling pass() on %1", earliest_content->content->path(0));
+		TraceSpan span("Decoder::pass");
 		earliest_content->done = earliest_content->decoder->pass ();
 		auto dcp = dynamic_pointer_cast<DCPContent>(earliest_content->content);
 		if (dcp && !_play_referenced) {
@@ -918,7 +924,7 @@ Player::pass ()
 
 
 /** @return Open subtitles for the frame at the given time, converted to images */
-optional<PositionImage>
+vector<PositionImage>
 Player::open_texts_for_frame(DCPTime time) const
 {
 	auto film = _film.lock();
@@ -926,7 +932,7 @@ Player::open_texts_for_frame(DCPTime time) const
 		return {};
 	}
 
-	list<PositionImage> texts;
+	vector<PositionImage> texts;
 	int const vfr = film->video_frame_rate();
 
 	for (auto type: { TextType::OPEN_SUBTITLE, TextType::OPEN_CAPTION }) {
@@ -957,7 +963,7 @@ Player::open_texts_for_frame(DCPTime time) const
 
 			/* String texts (rendered to an image) */
 			if (!text.string.empty()) {
-				auto s = render_text(text.string, _video_container_size, time, vfr);
+				auto s = render_text(text.string, _video_container_size, time, vfr, &_rendered_text_cache);
 				copy_if(s.begin(), s.end(), back_inserter(texts), [](PositionImage const& image) {
 					return image.image->size().width && image.image->size().height;
 				});
@@ -966,11 +972,7 @@ Player::open_texts_for_frame(DCPTime time) const
 		}
 	}
 
-	if (texts.empty()) {
-		return {};
-	}
-
-	return merge(texts, _subtitle_alignment);
+	return texts;
 }
 
 
@@ -1195,22 +1197,30 @@ Player::audio (weak_ptr<Piece> weak_piece, AudioStreamPtr stream, ContentAudio c
 
 	auto const fade_coeffs = content->fade (stream, content_audio.frame, content_audio.audio->frames(), rfr);
 	if (content->gain() != 0 || !fade_coeffs.empty()) {
-		auto gain_buffers = make_shared<AudioBuffers>(content_audio.audio);
+		/* Write the result of applying gain (and fade, if required) straight into new buffers,
+		 * rather than copying the input and then modifying it.
+		 */
+		auto const channels = content_audio.audio->channels();
+		auto const frames = content_audio.audio->frames();
+		auto gain_buffers = make_shared<AudioBuffers>(channels, frames, AudioBuffers::Contents::UNDEFINED);
+		auto in = content_audio.audio->data();
+		auto out = gain_buffers->data();
+		auto const gain = db_to_linear (content->gain());
 		if (!fade_coeffs.empty()) {
 			/* Apply both fade and gain */
-			DCPOMATIC_ASSERT (fade_coeffs.size() == static_cast<size_t>(gain_buffers->frames()));
-			auto const channels = gain_buffers->channels();
-			auto const frames = fade_coeffs.size();
-			auto data = gain_buffers->data();
-			auto const gain = db_to_linear (content->gain());
+			DCPOMATIC_ASSERT (fade_coeffs.size() == static_cast<size_t>(frames));
 			for (auto channel = 0; channel < channels; ++channel) {
-				for (auto frame = 0U; frame < frames; ++frame) {
-					data[channel][frame] *= gain * fade_coeffs[frame];
+				for (auto frame = 0; frame < frames; ++frame) {
+					out[channel][frame] = in[channel][frame] * (gain * fade_coeffs[frame]);
 				}
 			}
 		} else {
 			/* Just apply gain */
-			gain_buffers->apply_gain (content->gain());
+			for (auto channel = 0; channel < channels; ++channel) {
+				for (auto frame = 0; frame < frames; ++frame) {
+					out[channel][frame] = in[channel][frame] * gain;
+				}
+			}
 		}
 		content_audio.audio = gain_buffers;
 	}
@@ -1441,9 +1451,7 @@ Player::emit_video(shared_ptr<PlayerVideo> pv, DCPTime time)
 		std::for_each(_active_texts.begin(), _active_texts.end(), [time](ActiveText& a) { a.clear_before(time); });
 	}
 
-	if (auto texts = open_texts_for_frame(time)) {
-		pv->set_text(texts.get());
-	}
+	pv->set_texts(open_texts_for_frame(time), _subtitle_alignment);
 
 	Video (pv, time);
 }
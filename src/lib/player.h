@@ -38,6 +38,7 @@
 #include "image.h"
 #include "player_text.h"
 #include "position_image.h"
+#include "render_text.h"
 #include "shuffler.h"
 #include <boost/atomic.hpp>
 #include <list>
@@ -174,7 +175,7 @@ private:
 	std::pair<std::shared_ptr<AudioBuffers>, dcpomatic::DCPTime> discard_audio (
 		std::shared_ptr<const AudioBuffers> audio, dcpomatic::DCPTime time, dcpomatic::DCPTime discard_to
 		) const;
-	boost::optional<PositionImage> open_texts_for_frame(dcpomatic::DCPTime time) const;
+	std::vector<PositionImage> open_texts_for_frame(dcpomatic::DCPTime time) const;
 	void emit_video(std::shared_ptr<PlayerVideo> pv, dcpomatic::DCPTime time);
 	void use_video(std::shared_ptr<PlayerVideo> pv, dcpomatic::DCPTime time, dcpomatic::DCPTime end);
 	void emit_audio (std::shared_ptr<AudioBuffers> data, dcpomatic::DCPTime time);
@@ -246,12 +247,14 @@ private:
 	Empty _silent;
 
 	EnumIndexedVector<ActiveText, TextType> _active_texts;
+	/** Lines of burnt-in text that we have already rendered */
+	mutable RenderedTextCache _rendered_text_cache;
 	std::shared_ptr<AudioProcessor> _audio_processor;
 	bool _disable_audio_processor = false;
 
 	boost::atomic<dcpomatic::DCPTime> _playback_length;
 
-	/** Alignment for subtitle images that we create */
+	/** Alignment for merged subtitle images that PlayerVideo::text() creates */
 	Image::Alignment _subtitle_alignment = Image::Alignment::PADDED;
 
 	boost::signals2::scoped_connection _film_changed_connection;
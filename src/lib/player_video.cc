@@ -38,9 +38,11 @@ extern "C" {
 using std::cout;
 using std::dynamic_pointer_cast;
 using std::function;
+using std::list;
 using std::make_shared;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 using std::weak_ptr;
 using boost::optional;
 using dcp::Data;
@@ -95,23 +97,38 @@ PlayerVideo::PlayerVideo (shared_ptr<cxml::Node> node, shared_ptr<Socket> socket
 
 	_in = image_proxy_factory (node->node_child("In"), socket);
 
-	if (node->optional_number_child<int>("SubtitleX")) {
-
+	for (auto text: node->node_children("Subtitle")) {
 		auto image = make_shared<Image> (
-			AV_PIX_FMT_BGRA, dcp::Size(node->number_child<int>("SubtitleWidth"), node->number_child<int>("SubtitleHeight")), Image::Alignment::PADDED
+			AV_PIX_FMT_BGRA, dcp::Size(text->number_child<int>("Width"), text->number_child<int>("Height")), Image::Alignment::PADDED
 			);
 
 		image->read_from_socket (socket);
 
-		_text = PositionImage (image, Position<int>(node->number_child<int>("SubtitleX"), node->number_child<int>("SubtitleY")));
+		_texts.push_back(PositionImage(image, Position<int>(text->number_child<int>("X"), text->number_child<int>("Y"))));
 	}
 }
 
 
+/** @param texts Texts to blend onto our image.
+ *  @param merged_alignment Alignment to use for the image returned by text().
+ */
 void
-PlayerVideo::set_text (PositionImage image)
+PlayerVideo::set_texts(vector<PositionImage> texts, Image::Alignment merged_alignment)
 {
-	_text = image;
+	_texts = std::move(texts);
+	_merged_text_alignment = merged_alignment;
+}
+
+
+/** @return All our texts merged into one image, or an empty optional if there are none */
+optional<PositionImage>
+PlayerVideo::text() const
+{
+	if (_texts.empty()) {
+		return {};
+	}
+
+	return merge(list<PositionImage>(_texts.begin(), _texts.end()), _merged_text_alignment);
 }
 
 
@@ -188,8 +205,9 @@ PlayerVideo::make_image (function<AVPixelFormat (AVPixelFormat)> pixel_format, V
 		total_crop, _inter_size, _out_size, yuv_to_rgb, _video_range, pixel_format (prox.image->pixel_format()), video_range, Image::Alignment::COMPACT, fast
 		);
 
-	if (_text) {
-		_image->alpha_blend (_text->image, _text->position);
+	/* alpha_blend() clips each text to the image, so there's no need to merge them first */
+	for (auto const& text: _texts) {
+		_image->alpha_blend(text.image, text.position);
 	}
 
 	if (_fade) {
@@ -217,11 +235,12 @@ PlayerVideo::add_metadata(xmlpp::Element* element) const
 	if (_colour_conversion) {
 		_colour_conversion.get().as_xml(element);
 	}
-	if (_text) {
-		cxml::add_text_child(element, "SubtitleWidth", fmt::to_string(_text->image->size().width));
-		cxml::add_text_child(element, "SubtitleHeight", fmt::to_string(_text->image->size().height));
-		cxml::add_text_child(element, "SubtitleX", fmt::to_string(_text->position.x));
-		cxml::add_text_child(element, "SubtitleY", fmt::to_string(_text->position.y));
+	for (auto const& text: _texts) {
+		auto node = cxml::add_child(element, "Subtitle");
+		cxml::add_text_child(node, "Width", fmt::to_string(text.image->size().width));
+		cxml::add_text_child(node, "Height", fmt::to_string(text.image->size().height));
+		cxml::add_text_child(node, "X", fmt::to_string(text.position.x));
+		cxml::add_text_child(node, "Y", fmt::to_string(text.position.y));
 	}
 }
 
@@ -230,8 +249,8 @@ void
 PlayerVideo::write_to_socket (shared_ptr<Socket> socket) const
 {
 	_in->write_to_socket (socket);
-	if (_text) {
-		_text->image->write_to_socket (socket);
+	for (auto const& text: _texts) {
+		text.image->write_to_socket(socket);
 	}
 }
 
@@ -246,7 +265,7 @@ PlayerVideo::has_j2k () const
 		return false;
 	}
 
-	return _crop == Crop() && _out_size == j2k->size() && _inter_size == j2k->size() && !_text && !_fade && !_colour_conversion;
+	return _crop == Crop() && _out_size == j2k->size() && _inter_size == j2k->size() && _texts.empty() && !_fade && !_colour_conversion;
 }
 
 
@@ -281,17 +300,17 @@ PlayerVideo::same (shared_ptr<const PlayerVideo> other) const
 		return false;
 	}
 
-	if ((!_text && other->_text) || (_text && !other->_text)) {
-		/* One has a text and the other doesn't */
+	if (_texts.size() != other->_texts.size()) {
 		return false;
 	}
 
-	if (_text && other->_text && !_text->same (other->_text.get ())) {
-		/* They both have texts but they are different */
-		return false;
+	for (size_t i = 0; i < _texts.size(); ++i) {
+		if (!_texts[i].same(other->_texts[i])) {
+			return false;
+		}
 	}
 
-	/* Now neither has subtitles */
+	/* Now the texts are the same */
 
 	return _in->same (other->_in);
 }
@@ -328,7 +347,7 @@ PlayerVideo::memory_used () const
 }
 
 
-/** @return Shallow copy of this; _in and _text are shared between the original and the copy */
+/** @return Shallow copy of this; _in and _texts are shared between the original and the copy */
 shared_ptr<PlayerVideo>
 PlayerVideo::shallow_copy () const
 {
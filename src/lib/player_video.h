@@ -70,10 +70,11 @@ public:
 
 	std::shared_ptr<PlayerVideo> shallow_copy () const;
 
-	void set_text (PositionImage);
-	boost::optional<PositionImage> text () const {
-		return _text;
+	void set_texts(std::vector<PositionImage> texts, Image::Alignment merged_alignment);
+	std::vector<PositionImage> texts() const {
+		return _texts;
 	}
+	boost::optional<PositionImage> text() const;
 
 	void prepare (std::function<AVPixelFormat (AVPixelFormat)> pixel_format, VideoRange video_range, Image::Alignment alignment, bool fast, bool proxy_only);
 	std::shared_ptr<Image> image (std::function<AVPixelFormat (AVPixelFormat)> pixel_format, VideoRange video_range, bool fast) const;
@@ -138,7 +139,10 @@ private:
 	Part _part;
 	boost::optional<ColourConversion> _colour_conversion;
 	VideoRange _video_range;
-	boost::optional<PositionImage> _text;
+	/** Texts to be blended onto the image, in order */
+	std::vector<PositionImage> _texts;
+	/** Alignment to use when merging _texts in text() */
+	Image::Alignment _merged_text_alignment = Image::Alignment::PADDED;
 	/** Content that we came from.  This is so that reset_metadata() can work. */
 	std::weak_ptr<Content> _content;
 	/** Video time that we came from.  Again, this is for reset_metadata() */
@@ -0,0 +1,223 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "dcp_video.h"
+#include "dcpomatic_assert.h"
+#include "enum_indexed_vector.h"
+#include "exceptions.h"
+#include "film.h"
+#include "frame_info.h"
+#include "player.h"
+#include "player_video.h"
+#include "reel_encoder.h"
+#include "trace.h"
+#include "util.h"
+#include <dcp/file.h>
+#include <dcp/j2k_picture_asset_writer.h>
+#include <dcp/mono_j2k_picture_asset.h>
+#include <dcp/stereo_j2k_picture_asset.h>
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+#include <list>
+
+
+using std::list;
+using std::make_shared;
+using std::shared_ptr;
+using boost::optional;
+using namespace dcpomatic;
+
+
+/** @param film Film to encode.
+ *  @param period Period of the film to make a picture asset for.
+ *  @param threads Number of threads to encode JPEG2000 with.
+ */
+ReelEncoder::ReelEncoder(shared_ptr<const Film> film, DCPTimePeriod period, int threads)
+	: _film(film)
+	, _period(period)
+	, _threads(std::max(1, threads))
+{
+
+}
+
+
+/** Make the picture asset.
+ *  @param asset_path Path to write the picture asset MXF to.
+ *  @param info_path Path to write the frame info file to.
+ *  @param progress Function which will be called with the number of frames that have been
+ *  written so far.  It may throw an exception to stop the encode.
+ */
+void
+ReelEncoder::encode(boost::filesystem::path asset_path, boost::filesystem::path info_path, std::function<void (Frame)> progress)
+{
+	DCPOMATIC_ASSERT(_film->video_encoding() == VideoEncoding::JPEG2000);
+	/* Encrypted films are never sent to servers, as we would need their keys */
+	DCPOMATIC_ASSERT(!_film->encrypted());
+
+	auto const rate = _film->video_frame_rate();
+	auto const standard = _film->interop() ? dcp::Standard::INTEROP : dcp::Standard::SMPTE;
+
+	shared_ptr<dcp::J2KPictureAsset> asset;
+	if (_film->three_d()) {
+		asset = make_shared<dcp::StereoJ2KPictureAsset>(dcp::Fraction(rate, 1), standard);
+	} else {
+		asset = make_shared<dcp::MonoJ2KPictureAsset>(dcp::Fraction(rate, 1), standard);
+	}
+
+	asset->set_size(_film->frame_size());
+	asset->set_metadata(mxf_metadata());
+
+	auto writer = asset->start_write(asset_path, dcp::Behaviour::MAKE_NEW);
+
+	dcp::File info(info_path, "wb");
+	if (!info) {
+		throw OpenFileError(info_path, info.open_error(), OpenFileError::WRITE);
+	}
+
+	/** JPEG2000 data for a frame, or none if it is still being encoded */
+	struct Encoded
+	{
+		optional<dcp::ArrayData> data;
+	};
+
+	/** A frame that is waiting to be written */
+	struct Pending
+	{
+		Frame frame;
+		Eyes eyes;
+		/** may be shared with the previous frame for the same eyes, if the image is the same */
+		shared_ptr<Encoded> encoded;
+	};
+
+	boost::mutex mutex;
+	/** signalled when a frame's encoding has finished, or failed */
+	boost::condition condition;
+	list<Pending> pending;
+	bool failed = false;
+
+	boost::asio::io_service service;
+	boost::thread_group pool;
+	auto work = make_shared<boost::asio::io_service::work>(service);
+
+	for (int i = 0; i < _threads; ++i) {
+		pool.create_thread(boost::bind(&boost::asio::io_service::run, &service));
+	}
+
+	Frame written = 0;
+
+	/* Write frames from the front of pending, in order, until there are at most max_pending left */
+	auto write = [&](size_t max_pending) {
+		boost::mutex::scoped_lock lm(mutex);
+		while (pending.size() > max_pending) {
+			while (!failed && !pending.front().encoded->data) {
+				condition.wait(lm);
+			}
+			if (failed) {
+				lm.unlock();
+				rethrow();
+				DCPOMATIC_ASSERT(false);
+			}
+
+			auto next = pending.front();
+			pending.pop_front();
+			lm.unlock();
+
+			J2KFrameInfo(writer->write(next.encoded->data->data(), next.encoded->data->size())).write(info, next.frame, next.eyes);
+			if (next.eyes != Eyes::RIGHT) {
+				progress(++written);
+			}
+
+			lm.lock();
+		}
+	};
+
+	auto const bit_rate = _film->video_bit_rate(VideoEncoding::JPEG2000);
+	auto const resolution = _film->resolution();
+	auto const start = _period.from.frames_floor(rate);
+
+	bool finished = false;
+	EnumIndexedVector<shared_ptr<PlayerVideo>, Eyes> last_video;
+	EnumIndexedVector<shared_ptr<Encoded>, Eyes> last_encoded;
+
+	Player player(_film, Image::Alignment::PADDED);
+	player.set_ignore_audio();
+	player.set_ignore_text();
+
+	boost::signals2::scoped_connection connection = player.Video.connect(
+		[&](shared_ptr<PlayerVideo> video, DCPTime time) {
+			if (time >= _period.to) {
+				finished = true;
+				return;
+			} else if (time < _period.from) {
+				return;
+			}
+
+			auto const eyes = video->eyes();
+			auto const position = time.frames_floor(rate);
+
+			/* Encode the image unless it is the same as the last one, in which case we can write that again */
+			if (!last_video[eyes] || !video->same(last_video[eyes])) {
+				auto encoded = make_shared<Encoded>();
+				DCPVideo dcp_video(video, position, rate, bit_rate, resolution);
+				service.post([this, dcp_video, encoded, &mutex, &condition, &failed]() {
+					try {
+						TraceSpan span("ReelEncoder encode", dcp_video.index());
+						auto data = dcp_video.encode_locally();
+						boost::mutex::scoped_lock lm(mutex);
+						encoded->data = data;
+					} catch (...) {
+						store_current();
+						boost::mutex::scoped_lock lm(mutex);
+						failed = true;
+					}
+					condition.notify_all();
+				});
+				last_video[eyes] = video;
+				last_encoded[eyes] = encoded;
+			}
+
+			{
+				boost::mutex::scoped_lock lm(mutex);
+				pending.push_back({position - start, eyes, last_encoded[eyes]});
+			}
+
+			/* Keep the encoding threads busy without holding too many images in memory */
+			write(_threads * 2);
+		});
+
+	try {
+		player.seek(_period.from, true);
+		while (!finished && !player.pass()) {}
+		write(0);
+	} catch (...) {
+		/* Abandon any frames that have not started encoding yet */
+		service.stop();
+		work.reset();
+		pool.join_all();
+		throw;
+	}
+
+	work.reset();
+	pool.join_all();
+
+	writer->finalize();
+}
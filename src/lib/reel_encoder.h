@@ -0,0 +1,62 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef DCPOMATIC_REEL_ENCODER_H
+#define DCPOMATIC_REEL_ENCODER_H
+
+
+#include "dcpomatic_time.h"
+#include "exception_store.h"
+#include "types.h"
+#include <boost/filesystem.hpp>
+#include <functional>
+#include <memory>
+
+
+class Film;
+
+
+/** @class ReelEncoder
+ *  @brief Make a complete JPEG2000 picture asset, and its frame info file, for one period
+ *  (usually a reel) of a Film.
+ *
+ *  This is what an encoding server does when it is asked to encode a whole reel, rather
+ *  than the single frames that J2KEncoder sends.  The result can be given to
+ *  Writer::use_picture_asset().
+ */
+class ReelEncoder : public ExceptionStore
+{
+public:
+	ReelEncoder(std::shared_ptr<const Film> film, dcpomatic::DCPTimePeriod period, int threads);
+
+	ReelEncoder(ReelEncoder const&) = delete;
+	ReelEncoder& operator=(ReelEncoder const&) = delete;
+
+	void encode(boost::filesystem::path asset, boost::filesystem::path info, std::function<void (Frame)> progress);
+
+private:
+	std::shared_ptr<const Film> _film;
+	dcpomatic::DCPTimePeriod _period;
+	int _threads;
+};
+
+
+#endif
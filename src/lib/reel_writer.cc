@@ -57,6 +57,7 @@
 #include <dcp/stereo_j2k_picture_asset.h>
 #include <dcp/text_image.h>
 #include <fmt/format.h>
+#include <algorithm>
 
 #include "i18n.h"
 
@@ -80,24 +81,6 @@ using dcp::Data;
 using namespace dcpomatic;
 
 
-static dcp::MXFMetadata
-mxf_metadata ()
-{
-	dcp::MXFMetadata meta;
-	auto config = Config::instance();
-	if (!config->dcp_company_name().empty()) {
-		meta.company_name = config->dcp_company_name ();
-	}
-	if (!config->dcp_product_name().empty()) {
-		meta.product_name = config->dcp_product_name ();
-	}
-	if (!config->dcp_product_version().empty()) {
-		meta.product_version = config->dcp_product_version ();
-	}
-	return meta;
-}
-
-
 /** @param job Related job, or 0.
  *  @param text_only true to enable a special mode where the writer will expect only subtitles and closed captions to be written
  *  (no picture nor sound) and not give errors in that case.  This is used by the hints system to check the potential sizes of
@@ -264,7 +247,7 @@ ReelWriter::check_existing_picture_asset (boost::filesystem::path asset)
 
 	/* Offset of the last dcp::FrameInfo in the info file */
 	int const n = (dcp::filesystem::file_size(_info_file.path()) / J2KFrameInfo::size_on_disk()) - 1;
-	LOG_GENERAL("The last FI is %1; info file is %2, info size %3", n, dcp::filesystem::file_size(_info_file.path()), J2KFrameInfo::size_on_disk())
+	LOG_GENERAL("The last FI is %1; info file is %2, info size %3", n, dcp::filesystem::file_size(_info_file.path()), J2KFrameInfo::size_on_disk());
 
 	Frame first_nonexistent_frame;
 	if (film()->three_d()) {
@@ -328,6 +311,77 @@ ReelWriter::write(shared_ptr<dcp::MonoMPEG2PictureFrame> image)
 }
 
 
+/** Use a complete JPEG2000 picture asset which was made somewhere else (e.g. by an encoding server)
+ *  rather than one made from frames given to write().  Nothing must have been written to this reel's
+ *  picture asset.  Any asset that we were going to re-use from a previous encode is removed, and forgotten.
+ *  @param asset Picture asset MXF, which will be moved into our output directory.
+ *  @param info Frame info file for the asset, which will be copied into our info file and then removed.
+ */
+void
+ReelWriter::use_picture_asset(boost::filesystem::path asset, boost::filesystem::path info)
+{
+	DCPOMATIC_ASSERT(film()->video_encoding() == VideoEncoding::JPEG2000);
+
+	shared_ptr<dcp::J2KPictureAsset> picture;
+	if (film()->three_d()) {
+		picture = make_shared<dcp::StereoJ2KPictureAsset>(asset);
+	} else {
+		picture = make_shared<dcp::MonoJ2KPictureAsset>(asset);
+	}
+
+	auto const frames = _period.duration().frames_round(film()->video_frame_rate());
+	if (picture->intrinsic_duration() != frames) {
+		throw FileError(String::compose(_("picture asset has %1 frames rather than %2"), picture->intrinsic_duration(), frames), asset);
+	}
+
+	/* Copy the frame info so that the asset can be re-used if the DCP is made again */
+	{
+		dcp::File info_file(info, "rb");
+		if (!info_file) {
+			throw OpenFileError(info, info_file.open_error(), OpenFileError::READ);
+		}
+		for (Frame i = 0; i < frames; ++i) {
+			if (film()->three_d()) {
+				J2KFrameInfo(info_file, i, Eyes::LEFT).write(_info_file, i, Eyes::LEFT);
+				J2KFrameInfo(info_file, i, Eyes::RIGHT).write(_info_file, i, Eyes::RIGHT);
+			} else {
+				J2KFrameInfo(info_file, i, Eyes::BOTH).write(_info_file, i, Eyes::BOTH);
+			}
+		}
+	}
+	dcp::filesystem::remove(info);
+
+	/* Nothing was written to the writer that we made in the constructor, so it has not made a file */
+	_j2k_picture_asset_writer.reset();
+
+	auto remembered_assets = film()->read_remembered_assets();
+
+	/* Get rid of the asset that the constructor set up; it may be a partial or complete one which was
+	 * going to be re-used, and which would otherwise be left in the DCP directory.
+	 */
+	if (auto old = _j2k_picture_asset ? _j2k_picture_asset->file() : optional<boost::filesystem::path>()) {
+		remembered_assets.erase(
+			std::remove_if(remembered_assets.begin(), remembered_assets.end(), [&old](RememberedAsset const& remembered) {
+				return remembered.filename().filename() == old->filename();
+			}),
+			remembered_assets.end()
+			);
+		boost::system::error_code ec;
+		dcp::filesystem::remove(*old, ec);
+	}
+
+	auto const filename = _output_dir / video_asset_filename(picture, _reel_index, _reel_count, _content_summary);
+	dcp::filesystem::rename(asset, filename);
+	picture->set_file(filename);
+
+	remembered_assets.push_back(RememberedAsset(filename.filename(), _period, film()->video_identifier()));
+	film()->write_remembered_assets(remembered_assets);
+
+	_j2k_picture_asset = picture;
+	_first_nonexistent_frame = frames;
+}
+
+
 void
 ReelWriter::fake_write(Frame frame, Eyes eyes)
 {
@@ -729,12 +783,9 @@ ReelWriter::create_reel (
 }
 
 
-/** @param set_progress Method to call with progress; first parameter is the number of bytes
- *  done, second parameter is the number of bytes in total.
- */
-void
-ReelWriter::calculate_digests(std::function<void (int64_t, int64_t)> set_progress)
-try
+/** @return the assets that we have written to MXF files */
+vector<shared_ptr<const dcp::Asset>>
+ReelWriter::file_assets() const
 {
 	vector<shared_ptr<const dcp::Asset>> assets;
 
@@ -751,23 +802,7 @@ try
 		assets.push_back(_atmos_asset);
 	}
 
-	int64_t total_size = 0;
-	for (auto asset: assets) {
-		total_size += asset->file() ? boost::filesystem::file_size(*asset->file()) : 0;
-	}
-
-	int64_t total_done = 0;
-	for (auto asset: assets) {
-		asset->hash([&total_done, total_size, set_progress](int64_t done, int64_t) {
-			set_progress(total_done + done, total_size);
-		});
-		total_done += asset->file() ? boost::filesystem::file_size(*asset->file()) : 0;
-	}
-
-} catch (boost::thread_interrupted) {
-	/* set_progress contains an interruption_point, so any of these methods
-	 * may throw thread_interrupted, at which point we just give up.
-	 */
+	return assets;
 }
 
 
@@ -44,6 +44,7 @@ class Job;
 struct write_frame_info_test;
 
 namespace dcp {
+	class Asset;
 	class AtmosAsset;
 	class MonoJ2KPictureAsset;
 	class MonoJ2KPictureAssetWriter;
@@ -81,6 +82,7 @@ public:
 	void write(PlayerText text, TextType type, boost::optional<DCPTextTrack> track, dcpomatic::DCPTimePeriod period, FontIdMap const& fonts, std::shared_ptr<dcpomatic::Font> chosen_interop_font);
 	void write (std::shared_ptr<const dcp::AtmosFrame> atmos, AtmosMetadata metadata);
 	void write(std::shared_ptr<dcp::MonoMPEG2PictureFrame> image);
+	void use_picture_asset(boost::filesystem::path asset, boost::filesystem::path info);
 
 	void finish (boost::filesystem::path output_dcp);
 	std::shared_ptr<dcp::Reel> create_reel (
@@ -89,7 +91,7 @@ public:
 		bool ensure_subtitles,
 		std::set<DCPTextTrack> ensure_closed_captions
 		);
-	void calculate_digests(std::function<void (int64_t, int64_t)> set_progress);
+	std::vector<std::shared_ptr<const dcp::Asset>> file_assets() const;
 
 	Frame start () const;
 
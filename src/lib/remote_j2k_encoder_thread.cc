@@ -20,10 +20,14 @@
 
 
 #include "dcp_video.h"
+#include "dcpomatic_assert.h"
 #include "dcpomatic_log.h"
+#include "dcpomatic_socket.h"
+#include "exceptions.h"
 #include "j2k_encoder.h"
 #include "remote_j2k_encoder_thread.h"
 #include "util.h"
+#include <chrono>
 
 #include "i18n.h"
 
@@ -32,6 +36,13 @@ using std::make_shared;
 using std::shared_ptr;
 
 
+static double
+seconds_since(std::chrono::steady_clock::time_point time)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - time).count();
+}
+
+
 RemoteJ2KEncoderThread::RemoteJ2KEncoderThread(J2KEncoder& encoder, EncodeServerDescription server)
 	: J2KSyncEncoderThread(encoder)
 	, _server(server)
@@ -48,13 +59,42 @@ RemoteJ2KEncoderThread::log_thread_start() const
 }
 
 
+/** Send all the frames in a batch to the server, if it supports keep-alive, so that
+ *  it can encode them in parallel.  encode() will then collect the results.
+ */
+void
+RemoteJ2KEncoderThread::start_batch(std::vector<DCPVideo> const& frames)
+{
+	if (!_server.keep_alive() || frames.size() < 2) {
+		return;
+	}
+
+	DCPOMATIC_ASSERT(_in_flight.empty());
+
+	try {
+		if (!_socket) {
+			_socket = DCPVideo::connect_to_server(_server);
+		}
+		for (size_t i = 0; i < frames.size(); ++i) {
+			auto const id = _next_request_id++;
+			frames[i].send_to_server(_server, _socket, id, i == (frames.size() - 1));
+			_in_flight.push_back({id, frames[i].index(), frames[i].eyes(), std::chrono::steady_clock::now()});
+		}
+	} catch (std::exception& e) {
+		/* encode() will try again with each frame on its own */
+		LOG_GENERAL("Could not send batch of frames to %1 (%2)", _server.host_name(), e.what());
+		forget_connection();
+	}
+}
+
+
 shared_ptr<dcp::ArrayData>
 RemoteJ2KEncoderThread::encode(DCPVideo const& frame)
 {
 	shared_ptr<dcp::ArrayData> encoded;
 
 	try {
-		encoded = make_shared<dcp::ArrayData>(frame.encode_remotely(_server));
+		encoded = make_shared<dcp::ArrayData>(encode_remotely(frame));
 		if (_remote_backoff > 0) {
 			LOG_GENERAL("%1 was lost, but now she is found; removing backoff", _server.host_name());
 			_remote_backoff = 0;
@@ -72,6 +112,8 @@ RemoteJ2KEncoderThread::encode(DCPVideo const& frame)
 	}
 
 	if (!encoded) {
+		/* We don't know what state the connection is in, so start again with a new one next time */
+		forget_connection();
 		if (_remote_backoff < 60) {
 			/* back off more */
 			_remote_backoff += 10;
@@ -82,3 +124,72 @@ RemoteJ2KEncoderThread::encode(DCPVideo const& frame)
 	return encoded;
 }
 
+
+dcp::ArrayData
+RemoteJ2KEncoderThread::encode_remotely(DCPVideo const& frame)
+{
+	auto const start = std::chrono::steady_clock::now();
+
+	if (!_server.keep_alive()) {
+		/* This server wants a new connection for each frame */
+		auto encoded = frame.encode_remotely(_server);
+		_encoder.remote_frame_encoded(_server.host_name(), seconds_since(start));
+		return encoded;
+	}
+
+	if (!_in_flight.empty()) {
+		auto const in_flight = _in_flight.front();
+		_in_flight.pop_front();
+		/* encode() should be called with frames in the same order as they were given to start_batch() */
+		DCPOMATIC_ASSERT(in_flight.index == frame.index() && in_flight.eyes == frame.eyes());
+		try {
+			auto encoded = receive(in_flight.request_id);
+			_encoder.remote_frame_encoded(_server.host_name(), seconds_since(in_flight.sent));
+			return encoded;
+		} catch (NetworkError& e) {
+			/* The server may have closed the connection since we last used it, so try again
+			 * with a new one before we call it a failure.
+			 */
+			LOG_GENERAL("Connection to %1 was lost (%2); reconnecting", _server.host_name(), e.what());
+			forget_connection();
+		}
+	}
+
+	if (!_socket) {
+		_socket = DCPVideo::connect_to_server(_server);
+	}
+
+	auto const id = _next_request_id++;
+	frame.send_to_server(_server, _socket, id, true);
+	auto encoded = receive(id);
+	_encoder.remote_frame_encoded(_server.host_name(), seconds_since(start));
+	return encoded;
+}
+
+
+/** Read responses from the server until we get the one for a given request */
+dcp::ArrayData
+RemoteJ2KEncoderThread::receive(int request_id)
+{
+	while (true) {
+		auto iter = _received.find(request_id);
+		if (iter != _received.end()) {
+			auto encoded = iter->second;
+			_received.erase(iter);
+			return encoded;
+		}
+
+		auto response = DCPVideo::receive_from_server_with_id(_socket);
+		_received[response.first] = response.second;
+	}
+}
+
+
+/** Close our connection, if we have one, and forget about any frames that we sent on it */
+void
+RemoteJ2KEncoderThread::forget_connection()
+{
+	_socket.reset();
+	_in_flight.clear();
+	_received.clear();
+}
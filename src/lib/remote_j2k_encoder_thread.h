@@ -1,5 +1,12 @@
 #include "encode_server_description.h"
 #include "j2k_sync_encoder_thread.h"
+#include <dcp/array_data.h>
+#include <chrono>
+#include <list>
+#include <map>
+
+
+class Socket;
 
 
 class RemoteJ2KEncoderThread : public J2KSyncEncoderThread
@@ -8,6 +15,7 @@ public:
 	RemoteJ2KEncoderThread(J2KEncoder& encoder, EncodeServerDescription server);
 
 	void log_thread_start() const override;
+	void start_batch(std::vector<DCPVideo> const& frames) override;
 	std::shared_ptr<dcp::ArrayData> encode(DCPVideo const& frame) override;
 
 	EncodeServerDescription server() const {
@@ -15,7 +23,28 @@ public:
 	}
 
 private:
+	dcp::ArrayData encode_remotely(DCPVideo const& frame);
+	dcp::ArrayData receive(int request_id);
+	void forget_connection();
+
 	EncodeServerDescription _server;
+	/** Connection to the server which we keep open between frames, if the server allows it */
+	std::shared_ptr<Socket> _socket;
+	int _next_request_id = 0;
+
+	/** A frame which has been sent to the server by start_batch() */
+	struct InFlight
+	{
+		int request_id;
+		int index;
+		Eyes eyes;
+		std::chrono::steady_clock::time_point sent;
+	};
+
+	/** Frames sent by start_batch() which encode() has not yet asked for, in the order they were sent */
+	std::list<InFlight> _in_flight;
+	/** Encoded data that has come back from the server but that encode() has not yet asked for, keyed by request ID */
+	std::map<int, dcp::ArrayData> _received;
 	/** Number of seconds that we currently wait between attempts to connect to the server */
 	int _remote_backoff = 0;
 };
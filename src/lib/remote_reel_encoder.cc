@@ -0,0 +1,355 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "config.h"
+#include "constants.h"
+#include "dcp_video.h"
+#include "dcpomatic_assert.h"
+#include "dcpomatic_log.h"
+#include "dcpomatic_socket.h"
+#include "encode_server_finder.h"
+#include "exceptions.h"
+#include "film.h"
+#include "parallel_video_player.h"
+#include "remote_reel_encoder.h"
+#include "util.h"
+#include <libcxml/cxml.h>
+#include <dcp/filesystem.h>
+#include <dcp/scope_guard.h>
+#include <dcp/warnings.h>
+LIBDCP_DISABLE_WARNINGS
+#include <libxml++/libxml++.h>
+LIBDCP_ENABLE_WARNINGS
+#include <fmt/format.h>
+
+
+using std::list;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using boost::optional;
+using namespace dcpomatic;
+
+
+/** Time to wait for a server to say something before we give up on it, in seconds.  Servers
+ *  report their progress after every frame, but they must also load the film and seek to the
+ *  start of the reel before the first.
+ */
+static int constexpr server_timeout = 120;
+
+
+/** @param film Film to encode.
+ *  @param servers Servers to use, as returned by servers().
+ *  @param local_only Indices of reels which the caller should make rather than giving them to a server.
+ *  @param progress Function which will be called, from any of our threads, with the number of frames
+ *  that have been encoded by a server since the last call.  This may be negative if a server fails.
+ */
+RemoteReelEncoder::RemoteReelEncoder(
+	shared_ptr<const Film> film,
+	list<EncodeServerDescription> servers,
+	std::set<int> local_only,
+	std::function<void (Frame)> progress
+	)
+	: _film(film)
+	, _periods(film->reels())
+	, _metadata(film->metadata()->write_to_string("UTF-8"))
+	, _directory(dcp::filesystem::canonical(film->directory().get()))
+	, _progress(progress)
+	, _states(_periods.size(), State::UNCLAIMED)
+{
+	for (auto reel: local_only) {
+		DCPOMATIC_ASSERT(reel >= 0 && reel < static_cast<int>(_states.size()));
+		_states[reel] = State::UNCLAIMED_LOCAL_ONLY;
+	}
+
+	for (auto i = 0U; i < _periods.size(); ++i) {
+		boost::system::error_code ec;
+		dcp::filesystem::remove(asset_path(i), ec);
+		dcp::filesystem::remove(info_path(i), ec);
+	}
+
+	for (auto const& server: servers) {
+		_workers.push_back(boost::thread(boost::bind(&RemoteReelEncoder::thread, this, server)));
+#ifdef DCPOMATIC_LINUX
+		pthread_setname_np(_workers.back().native_handle(), "remote-reel");
+#endif
+	}
+}
+
+
+RemoteReelEncoder::~RemoteReelEncoder()
+{
+	boost::this_thread::disable_interruption dis;
+
+	{
+		boost::mutex::scoped_lock lm(_mutex);
+		_stop = true;
+		/* Closing the connections makes our threads' reads fail straight away, and tells the servers to stop */
+		for (auto socket: _sockets) {
+			socket->cancel();
+		}
+	}
+
+	for (auto& worker: _workers) {
+		try {
+			worker.join();
+		} catch (...) {}
+	}
+}
+
+
+/** @return Servers that we should ask to encode reels of a film; this will be empty if the configuration
+ *  says not to, or if the film cannot be made this way.  Encrypted films are never made this way, as we
+ *  would have to send their keys to the servers.
+ */
+list<EncodeServerDescription>
+RemoteReelEncoder::servers(shared_ptr<const Film> film)
+{
+	if (
+		!Config::instance()->encode_reels_on_servers() ||
+		film->video_encoding() != VideoEncoding::JPEG2000 ||
+		!film->directory() ||
+		film->encrypted()
+	   ) {
+		return {};
+	}
+
+	/* Servers make the video for a reel in the same way as ParallelVideoPlayer does for a chunk */
+	if (!ParallelVideoPlayer::suitable(film)) {
+		return {};
+	}
+
+	list<EncodeServerDescription> servers;
+	for (auto const& server: EncodeServerFinder::instance()->servers()) {
+		if (server.current_link_version() && server.reel_encoding()) {
+			servers.push_back(server);
+		}
+	}
+
+	return servers;
+}
+
+
+/** Claim the first reel which no server has started, so that the caller can make its picture asset.
+ *  @param wait true to wait, if every reel has been claimed, for a server which is still working to either
+ *  finish or give up on its reel.
+ *  @return Index of the reel, or none if there is nothing (else) to claim.
+ */
+optional<int>
+RemoteReelEncoder::claim(bool wait)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+
+	while (true) {
+		bool working = false;
+		for (auto i = 0U; i < _states.size(); ++i) {
+			if (_states[i] == State::UNCLAIMED || _states[i] == State::UNCLAIMED_LOCAL_ONLY) {
+				_states[i] = State::LOCAL;
+				return i;
+			} else if (_states[i] == State::REMOTE) {
+				working = true;
+			}
+		}
+
+		if (!wait || !working) {
+			return {};
+		}
+
+		_condition.wait(lm);
+	}
+}
+
+
+/** @return Assets that servers have made; these should be given to Writer::use_picture_asset() */
+vector<RemoteReelEncoder::Asset>
+RemoteReelEncoder::assets() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+
+	vector<Asset> assets;
+	for (auto i = 0U; i < _states.size(); ++i) {
+		if (_states[i] == State::REMOTE_DONE) {
+			assets.push_back({static_cast<int>(i), asset_path(i), info_path(i)});
+		}
+	}
+
+	return assets;
+}
+
+
+boost::filesystem::path
+RemoteReelEncoder::asset_path(int reel) const
+{
+	auto film = _film.lock();
+	DCPOMATIC_ASSERT(film);
+	return film->dir("remote_reels") / fmt::format("{}.mxf", reel);
+}
+
+
+boost::filesystem::path
+RemoteReelEncoder::info_path(int reel) const
+{
+	auto film = _film.lock();
+	DCPOMATIC_ASSERT(film);
+	return film->dir("remote_reels") / fmt::format("{}.info", reel);
+}
+
+
+void
+RemoteReelEncoder::thread(EncodeServerDescription server)
+try
+{
+	start_of_thread("RemoteReelEncoder");
+
+	while (true) {
+		optional<int> reel;
+		{
+			boost::mutex::scoped_lock lm(_mutex);
+			if (_stop) {
+				return;
+			}
+			for (int i = _states.size() - 1; i >= 0; --i) {
+				if (_states[i] == State::UNCLAIMED) {
+					_states[i] = State::REMOTE;
+					reel = i;
+					break;
+				}
+			}
+		}
+
+		if (!reel) {
+			return;
+		}
+
+		Frame done = 0;
+
+		auto give_back = [this, &reel, &done]() {
+			_progress(-done);
+			boost::mutex::scoped_lock lm(_mutex);
+			_states[*reel] = State::UNCLAIMED;
+			_condition.notify_all();
+		};
+
+		auto stopping = [this]() {
+			boost::mutex::scoped_lock lm(_mutex);
+			return _stop;
+		};
+
+		try {
+			LOG_GENERAL("Asking %1 to encode reel %2", server.host_name(), *reel);
+			encode(server, *reel, done);
+		} catch (std::exception& e) {
+			if (!stopping()) {
+				LOG_ERROR("Server %1 failed to encode reel %2 (%3); it will be encoded locally", server.host_name(), *reel, e.what());
+			}
+			give_back();
+			return;
+		} catch (...) {
+			if (!stopping()) {
+				LOG_ERROR("Server %1 failed to encode reel %2; it will be encoded locally", server.host_name(), *reel);
+			}
+			give_back();
+			return;
+		}
+
+		LOG_GENERAL("%1 finished encoding reel %2", server.host_name(), *reel);
+
+		boost::mutex::scoped_lock lm(_mutex);
+		_states[*reel] = State::REMOTE_DONE;
+		_condition.notify_all();
+	}
+}
+catch (...)
+{
+	store_current();
+}
+
+
+/** Ask a server to encode a reel, and wait for it to finish.
+ *  @param done Updated with the number of frames that the server has encoded.
+ */
+void
+RemoteReelEncoder::encode(EncodeServerDescription server, int reel, Frame& done)
+{
+	auto socket = DCPVideo::connect_to_server(server, server_timeout);
+
+	{
+		boost::mutex::scoped_lock lm(_mutex);
+		if (_stop) {
+			throw EncodeError("Reel encoding cancelled");
+		}
+		_sockets.insert(socket);
+	}
+
+	dcp::ScopeGuard sg = [this, socket]() {
+		boost::mutex::scoped_lock lm(_mutex);
+		_sockets.erase(socket);
+	};
+
+	/* The server writes the asset and info file into the film's remote_reels directory, with the
+	 * names that asset_path() and info_path() give.
+	 */
+	xmlpp::Document doc;
+	auto root = doc.create_root_node("ReelEncodingRequest");
+	cxml::add_text_child(root, "Version", fmt::to_string(SERVER_LINK_VERSION));
+	cxml::add_text_child(root, "Film", _metadata);
+	cxml::add_text_child(root, "Directory", _directory.string());
+	cxml::add_text_child(root, "Reel", fmt::to_string(reel));
+	cxml::add_text_child(root, "From", fmt::to_string(_periods[reel].from.get()));
+	cxml::add_text_child(root, "To", fmt::to_string(_periods[reel].to.get()));
+
+	{
+		Socket::WriteDigestScope ds(socket);
+		auto xml = doc.write_to_string("UTF-8");
+		socket->write(xml.bytes() + 1);
+		socket->write(reinterpret_cast<uint8_t const*>(xml.c_str()), xml.bytes() + 1);
+	}
+
+	/* The server sends the number of frames it has written after each one */
+	while (true) {
+		auto const frames = socket->read_uint32();
+		if (frames == REEL_ENCODING_FINISHED) {
+			break;
+		}
+
+		_progress(frames - done);
+		done = frames;
+
+		boost::mutex::scoped_lock lm(_mutex);
+		if (_stop) {
+			throw EncodeError("Reel encoding cancelled");
+		}
+	}
+
+	auto const length = socket->read_uint32();
+	if (length > MAX_ENCODE_REQUEST_SIZE) {
+		throw NetworkError("Malformed reel encoding response (too large)");
+	}
+
+	vector<char> buffer(length + 1, '\0');
+	socket->read(reinterpret_cast<uint8_t*>(buffer.data()), length);
+
+	cxml::Document response("ReelEncodingResponse");
+	response.read_string(string(buffer.data()));
+	if (auto error = response.optional_string_child("Error")) {
+		throw EncodeError(*error);
+	}
+}
@@ -0,0 +1,120 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef DCPOMATIC_REMOTE_REEL_ENCODER_H
+#define DCPOMATIC_REMOTE_REEL_ENCODER_H
+
+
+#include "dcpomatic_time.h"
+#include "encode_server_description.h"
+#include "exception_store.h"
+#include "types.h"
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+#include <functional>
+#include <list>
+#include <memory>
+#include <set>
+#include <vector>
+
+
+class Film;
+class Socket;
+
+
+/** @class RemoteReelEncoder
+ *  @brief Some threads which ask encoding servers to make the picture assets for whole reels of a film.
+ *
+ *  The servers read the film's content themselves, so they must be able to see it (and the film's
+ *  directory, where they write the assets) at the same paths as we do.  They must also have been
+ *  configured to accept such requests.
+ *
+ *  Each server is given reels in turn, starting from the end of the film, while the caller takes
+ *  reels to make itself from the start using claim().  If a server fails the reel it was working on
+ *  is handed back so that the caller can claim() it, and that server is not used again.  Reels which
+ *  can re-use some or all of an existing picture asset are never given to servers.
+ */
+class RemoteReelEncoder : public ExceptionStore
+{
+public:
+	RemoteReelEncoder(
+		std::shared_ptr<const Film> film,
+		std::list<EncodeServerDescription> servers,
+		std::set<int> local_only,
+		std::function<void (Frame)> progress
+		);
+	~RemoteReelEncoder();
+
+	RemoteReelEncoder(RemoteReelEncoder const&) = delete;
+	RemoteReelEncoder& operator=(RemoteReelEncoder const&) = delete;
+
+	boost::optional<int> claim(bool wait);
+
+	struct Asset
+	{
+		int reel;
+		boost::filesystem::path asset;
+		boost::filesystem::path info;
+	};
+
+	std::vector<Asset> assets() const;
+
+	static std::list<EncodeServerDescription> servers(std::shared_ptr<const Film> film);
+
+private:
+	void thread(EncodeServerDescription server);
+	void encode(EncodeServerDescription server, int reel, Frame& done);
+	boost::filesystem::path asset_path(int reel) const;
+	boost::filesystem::path info_path(int reel) const;
+
+	enum class State
+	{
+		UNCLAIMED,
+		/** unclaimed, and only the caller may claim it */
+		UNCLAIMED_LOCAL_ONLY,
+		LOCAL,
+		REMOTE,
+		REMOTE_DONE
+	};
+
+	std::weak_ptr<const Film> _film;
+	std::vector<dcpomatic::DCPTimePeriod> _periods;
+	/** the film's metadata, to send to the servers */
+	std::string _metadata;
+	/** the film's directory, to send to the servers */
+	boost::filesystem::path _directory;
+	std::function<void (Frame)> _progress;
+
+	mutable boost::mutex _mutex;
+	/** Condition which is signalled when a server finishes or gives up on a reel */
+	boost::condition _condition;
+	std::vector<State> _states;
+	bool _stop = false;
+	/** Connections to servers which are working on reels, so that we can close them to stop the servers */
+	std::set<std::shared_ptr<Socket>> _sockets;
+
+	std::vector<boost::thread> _workers;
+};
+
+
+#endif
@@ -35,6 +35,7 @@ LIBDCP_ENABLE_WARNINGS
 #include <pango/pangocairo.h>
 #include <fmt/format.h>
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <iostream>
 
 
@@ -452,13 +453,29 @@ render_line(vector<StringText> subtitles, dcp::Size target, DCPTime time, int fr
 /** @param time Time of the frame that these subtitles are going on.
  *  @param target Size of the container that this subtitle will end up in.
  *  @param frame_rate DCP frame rate.
+ *  @param cache Cache to use for rendered lines, or nullptr.
  */
 vector<PositionImage>
-render_text(vector<StringText> subtitles, dcp::Size target, DCPTime time, int frame_rate)
+render_text(vector<StringText> subtitles, dcp::Size target, DCPTime time, int frame_rate, RenderedTextCache* cache)
 {
 	vector<StringText> pending;
 	vector<PositionImage> images;
 
+	auto render = [&]() -> PositionImage {
+		if (!cache) {
+			return render_line(pending, target, time, frame_rate);
+		}
+
+		auto const fade_factor = calculate_fade_factor(pending.front(), time, frame_rate);
+		if (auto cached = cache->get(pending, target, fade_factor)) {
+			return *cached;
+		}
+
+		auto image = render_line(pending, target, time, frame_rate);
+		cache->put(pending, target, fade_factor, image);
+		return image;
+	};
+
 	for (auto const& i: subtitles) {
 		if (!pending.empty()) {
 			auto const last = pending.back();
@@ -466,7 +483,7 @@ render_text(vector<StringText> subtitles, dcp::Size target, DCPTime time, int fr
 			auto const different_h = i.h_align() != last.h_align() || fabs(i.h_position() - pending.back().h_position()) > 1e-4;
 			if (different_v || different_h) {
 				/* We need a new line if any new positioning (horizontal or vertical) changes for this section */
-				images.push_back(render_line(pending, target, time, frame_rate));
+				images.push_back(render());
 				pending.clear ();
 			}
 		}
@@ -474,13 +491,86 @@ render_text(vector<StringText> subtitles, dcp::Size target, DCPTime time, int fr
 	}
 
 	if (!pending.empty()) {
-		images.push_back(render_line(pending, target, time, frame_rate));
+		images.push_back(render());
 	}
 
 	return images;
 }
 
 
+/** @return true if rendering a and b would give the same image */
+static bool
+same_rendering(StringText const& a, StringText const& b)
+{
+	return static_cast<dcp::TextString const&>(a) == static_cast<dcp::TextString const&>(b) &&
+		a.outline_width == b.outline_width &&
+		a.font == b.font &&
+		a.valign_standard == b.valign_standard;
+}
+
+
+optional<PositionImage>
+RenderedTextCache::get(vector<StringText> const& line, dcp::Size target, float fade_factor)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+
+	auto same_line = [&line](vector<StringText> const& other) {
+		return line.size() == other.size() && std::equal(line.begin(), line.end(), other.begin(), same_rendering);
+	};
+
+	for (auto i = _entries.begin(); i != _entries.end(); ++i) {
+		if (i->target == target && i->fade_factor == fade_factor && same_line(i->line)) {
+			_entries.splice(_entries.begin(), _entries, i);
+			++_hits;
+			return _entries.front().image;
+		}
+	}
+
+	++_misses;
+	return {};
+}
+
+
+void
+RenderedTextCache::put(vector<StringText> const& line, dcp::Size target, float fade_factor, PositionImage image)
+{
+	/* Enough for all the lines on screen at once, with some to spare for a line which
+	 * goes away for a moment and then comes back.
+	 */
+	size_t constexpr max_entries = 16;
+
+	boost::mutex::scoped_lock lm(_mutex);
+	_entries.push_front({line, target, fade_factor, image});
+	if (_entries.size() > max_entries) {
+		_entries.pop_back();
+	}
+}
+
+
+void
+RenderedTextCache::clear()
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	_entries.clear();
+}
+
+
+int
+RenderedTextCache::hits() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	return _hits;
+}
+
+
+int
+RenderedTextCache::misses() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	return _misses;
+}
+
+
 vector<dcpomatic::Rect<int>>
 bounding_box(vector<StringText> subtitles, dcp::Size target, optional<dcp::SubtitleStandard> override_standard)
 {
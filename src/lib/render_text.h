@@ -24,6 +24,8 @@
 #include "rect.h"
 #include "string_text.h"
 #include <dcp/util.h>
+#include <boost/thread/mutex.hpp>
+#include <list>
 #include <memory>
 
 
@@ -32,11 +34,50 @@ namespace dcpomatic {
 }
 
 
+class RenderedTextCache;
+
+
 std::string marked_up(std::vector<StringText> subtitles, int target_height, float fade_factor, std::string font_name);
-std::vector<PositionImage> render_text(std::vector<StringText>, dcp::Size, dcpomatic::DCPTime, int);
+std::vector<PositionImage> render_text(std::vector<StringText>, dcp::Size, dcpomatic::DCPTime, int, RenderedTextCache* cache = nullptr);
 std::vector<dcpomatic::Rect<int>> bounding_box(std::vector<StringText> subtitles, dcp::Size target, boost::optional<dcp::SubtitleStandard> override_standard = boost::none);
 
 
+/** A cache of rendered lines of text.  A subtitle line is usually on screen, unchanged,
+ *  for many frames, and laying it out and rasterising it with Pango and Cairo is slow, so
+ *  render_text() can use one of these to render each line only once.
+ *
+ *  Lines are keyed on their text, styling, font, target size and fade factor; the fade is
+ *  part of the key (rather than being applied to a cached unfaded image) so that the result
+ *  is exactly the same as rendering from scratch.  Only the frames within a fade miss.
+ */
+class RenderedTextCache
+{
+public:
+	/** @return Cached rendering of a line, or an empty optional */
+	boost::optional<PositionImage> get(std::vector<StringText> const& line, dcp::Size target, float fade_factor);
+	void put(std::vector<StringText> const& line, dcp::Size target, float fade_factor, PositionImage image);
+	void clear();
+
+	int hits() const;
+	int misses() const;
+
+private:
+	struct Entry
+	{
+		std::vector<StringText> line;
+		dcp::Size target;
+		float fade_factor;
+		PositionImage image;
+	};
+
+	mutable boost::mutex _mutex;
+	/** Most-recently-used first */
+	std::list<Entry> _entries;
+	int _hits = 0;
+	int _misses = 0;
+};
+
+
 class FontMetrics
 {
 public:
@@ -94,12 +94,12 @@ Resampler::run (shared_ptr<const AudioBuffers> in)
 		int const max_resampled_frames = ceil (static_cast<double>(in_frames) * _out_rate / _in_rate) + 32;
 
 		SRC_DATA data;
-		std::vector<float> in_buffer(in_frames * _channels);
-		std::vector<float> out_buffer(max_resampled_frames * _channels);
+		_in_buffer.resize(in_frames * _channels);
+		_out_buffer.resize(max_resampled_frames * _channels);
 
 		{
 			auto p = in->data ();
-			auto q = in_buffer.data();
+			auto q = _in_buffer.data();
 			for (int i = 0; i < in_frames; ++i) {
 				for (int j = 0; j < _channels; ++j) {
 					*q++ = p[j][in_offset + i];
@@ -107,10 +107,10 @@ Resampler::run (shared_ptr<const AudioBuffers> in)
 			}
 		}
 
-		data.data_in = in_buffer.data();
+		data.data_in = _in_buffer.data();
 		data.input_frames = in_frames;
 
-		data.data_out = out_buffer.data();
+		data.data_out = _out_buffer.data();
 		data.output_frames = max_resampled_frames;
 
 		data.end_of_input = 0;
@@ -21,6 +21,7 @@
 
 #include <samplerate.h>
 #include <memory>
+#include <vector>
 
 
 class AudioBuffers;
@@ -49,4 +50,8 @@ private:
 	int _in_rate;
 	int _out_rate;
 	int _channels;
+	/** Interleaved input to libsamplerate, kept between calls to run() to save re-allocating it */
+	std::vector<float> _in_buffer;
+	/** Interleaved output from libsamplerate, kept between calls to run() to save re-allocating it */
+	std::vector<float> _out_buffer;
 };
@@ -0,0 +1,109 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "dcpomatic_assert.h"
+#include "image.h"
+#include "rgb_to_xyz.h"
+#include <dcp/colour_conversion.h>
+#include <dcp/openjpeg_image.h>
+#include <dcp/rgb_xyz.h>
+#include <dcp/transfer_function.h>
+#include <algorithm>
+#include <cmath>
+
+
+using std::make_shared;
+using std::max;
+using std::min;
+using std::shared_ptr;
+
+
+namespace {
+
+
+/** @return v rounded to the nearest integer, with ties going to the even one.  This is the
+ *  same as lrint() in the default rounding mode, but can be inlined; it is only valid for
+ *  0 <= v < 2^51.  The trick relies on arithmetic being done in double precision, which is
+ *  not the case with x87 maths, so in that case we fall back to lrint().
+ */
+inline int
+round_to_nearest(double v)
+{
+#if defined(__SSE2_MATH__) || defined(_M_X64) || defined(__aarch64__)
+	double const magic = 6755399441055744.0;
+	return static_cast<int>((v + magic) - magic);
+#else
+	return lrint(v);
+#endif
+}
+
+
+}
+
+
+shared_ptr<dcp::OpenJPEGImage>
+dcpomatic::rgb_to_xyz(Image const& rgb, dcp::ColourConversion const& conversion)
+{
+	/* Like dcp::rgb_to_xyz() we'll treat anything with 3 packed 16-bit components as RGB */
+	DCPOMATIC_ASSERT(rgb.pixel_format() == AV_PIX_FMT_RGB48LE || rgb.pixel_format() == AV_PIX_FMT_XYZ12LE);
+
+	auto const size = rgb.size();
+	auto xyz = make_shared<dcp::OpenJPEGImage>(size);
+
+	/* libdcp caches these LUTs, so it is cheap to ask for them for each frame.  Input gamma is
+	 * looked up with 12-bit precision, as dcp::rgb_to_xyz() does.
+	 */
+	auto const& lut_in_vector = conversion.in()->double_lut(0, 1, 12, false);
+	auto const& lut_out_vector = conversion.out()->int_lut(0, 1, 16, true, 4095);
+	double const* lut_in = lut_in_vector.data();
+	int const* lut_out = lut_out_vector.data();
+
+	/* The product of the RGB to XYZ matrix, the Bradford transform and the DCI companding */
+	double m[9];
+	dcp::combined_rgb_to_xyz(conversion, m);
+
+	int* out_x = xyz->data(0);
+	int* out_y = xyz->data(1);
+	int* out_z = xyz->data(2);
+
+	for (int y = 0; y < size.height; ++y) {
+		auto p = reinterpret_cast<uint16_t const*>(rgb.data()[0] + y * rgb.stride()[0]);
+		for (int x = 0; x < size.width; ++x) {
+			/* In gamma LUT (converting 16-bit to 12-bit) */
+			double const r = lut_in[p[0] >> 4];
+			double const g = lut_in[p[1] >> 4];
+			double const b = lut_in[p[2] >> 4];
+			p += 3;
+
+			/* RGB to XYZ, Bradford transform and DCI companding, then clamp */
+			double const dx = min(1.0, max(0.0, r * m[0] + g * m[1] + b * m[2]));
+			double const dy = min(1.0, max(0.0, r * m[3] + g * m[4] + b * m[5]));
+			double const dz = min(1.0, max(0.0, r * m[6] + g * m[7] + b * m[8]));
+
+			/* Out gamma LUT */
+			*out_x++ = lut_out[round_to_nearest(dx * 65535)];
+			*out_y++ = lut_out[round_to_nearest(dy * 65535)];
+			*out_z++ = lut_out[round_to_nearest(dz * 65535)];
+		}
+	}
+
+	return xyz;
+}
@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  src/lib/rgb_to_xyz.h
+ *  @brief Conversion of RGB48LE images to XYZ ready for the JPEG2000 encoder.
+ */
+
+
+#ifndef DCPOMATIC_RGB_TO_XYZ_H
+#define DCPOMATIC_RGB_TO_XYZ_H
+
+
+#include <memory>
+
+
+class Image;
+
+namespace dcp {
+	class ColourConversion;
+	class OpenJPEGImage;
+}
+
+
+namespace dcpomatic {
+
+
+/** Convert an RGB48LE image to 12-bit XYZ, writing straight into the planes of a new
+ *  dcp::OpenJPEGImage.  The results are the same as those from dcp::rgb_to_xyz(), but
+ *  the inner loop avoids a call out to lrint() for each sample.
+ */
+extern std::shared_ptr<dcp::OpenJPEGImage> rgb_to_xyz(Image const& rgb, dcp::ColourConversion const& conversion);
+
+
+}
+
+
+#endif
@@ -0,0 +1,150 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "dcpomatic_assert.h"
+#include "enum_indexed_vector.h"
+#include "scale_context_cache.h"
+#include <dcp/warnings.h>
+LIBDCP_DISABLE_WARNINGS
+extern "C" {
+#include <libswscale/swscale.h>
+}
+LIBDCP_ENABLE_WARNINGS
+#include <stdexcept>
+#include <tuple>
+
+
+#include "i18n.h"
+
+
+using std::runtime_error;
+using std::unique_ptr;
+
+
+bool
+ScaleContextCache::Key::operator==(Key const& other) const
+{
+	return std::tie(in_size, in_format, out_size, out_format, flags, yuv_to_rgb, in_range, out_range) ==
+		std::tie(other.in_size, other.in_format, other.out_size, other.out_format, other.flags, other.yuv_to_rgb, other.in_range, other.out_range);
+}
+
+
+ScaleContextCache::~ScaleContextCache()
+{
+	clear();
+}
+
+
+ScaleContextCache::Context::~Context()
+{
+	_cache->put(_key, _context);
+}
+
+
+unique_ptr<ScaleContextCache::Context>
+ScaleContextCache::get(Key const& key)
+{
+	{
+		boost::mutex::scoped_lock lm(_mutex);
+		for (auto i = _idle.begin(); i != _idle.end(); ++i) {
+			if (i->first == key) {
+				auto context = i->second;
+				_idle.erase(i);
+				++_hits;
+				return unique_ptr<Context>(new Context(this, key, context));
+			}
+		}
+		++_misses;
+	}
+
+	auto context = sws_getContext(
+		key.in_size.width, key.in_size.height, key.in_format,
+		key.out_size.width, key.out_size.height, key.out_format,
+		key.flags, 0, 0, 0
+		);
+
+	if (!context) {
+		throw runtime_error(N_("Could not allocate SwsContext"));
+	}
+
+	DCPOMATIC_ASSERT(key.yuv_to_rgb < dcp::YUVToRGB::COUNT);
+	EnumIndexedVector<int, dcp::YUVToRGB> lut;
+	lut[dcp::YUVToRGB::REC601] = SWS_CS_ITU601;
+	lut[dcp::YUVToRGB::REC709] = SWS_CS_ITU709;
+	lut[dcp::YUVToRGB::REC2020] = SWS_CS_BT2020;
+
+	sws_setColorspaceDetails(
+		context,
+		sws_getCoefficients(lut[key.yuv_to_rgb]), key.in_range,
+		sws_getCoefficients(lut[key.yuv_to_rgb]), key.out_range,
+		0, 1 << 16, 1 << 16
+		);
+
+	return unique_ptr<Context>(new Context(this, key, context));
+}
+
+
+void
+ScaleContextCache::put(Key const& key, SwsContext* context)
+{
+	boost::mutex::scoped_lock lm(_mutex);
+
+	_idle.push_front(std::make_pair(key, context));
+	while (_idle.size() > _maximum_idle) {
+		sws_freeContext(_idle.back().second);
+		_idle.pop_back();
+	}
+}
+
+
+void
+ScaleContextCache::clear()
+{
+	boost::mutex::scoped_lock lm(_mutex);
+
+	for (auto const& i: _idle) {
+		sws_freeContext(i.second);
+	}
+	_idle.clear();
+}
+
+
+int
+ScaleContextCache::hits() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	return _hits;
+}
+
+
+int
+ScaleContextCache::misses() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	return _misses;
+}
+
+
+ScaleContextCache*
+ScaleContextCache::instance()
+{
+	static ScaleContextCache cache;
+	return &cache;
+}
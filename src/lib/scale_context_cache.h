@@ -0,0 +1,144 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DCPOMATIC_SCALE_CONTEXT_CACHE_H
+#define DCPOMATIC_SCALE_CONTEXT_CACHE_H
+
+
+#include <dcp/types.h>
+#include <dcp/warnings.h>
+LIBDCP_DISABLE_WARNINGS
+extern "C" {
+#include <libavutil/pixfmt.h>
+}
+LIBDCP_ENABLE_WARNINGS
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <memory>
+
+
+struct SwsContext;
+
+
+/** @class ScaleContextCache
+ *  @brief A pool of libswscale contexts which can be re-used between frames.
+ *
+ *  Setting up a SwsContext (especially the filter coefficients for bicubic scaling) is
+ *  quite expensive, and when transcoding we will usually make the same scale for every frame.
+ *  SwsContexts cannot be used by more than one thread at once, so each call to get() hands
+ *  out a context for the exclusive use of the caller until its Context is destroyed.
+ */
+class ScaleContextCache
+{
+public:
+	ScaleContextCache() = default;
+	~ScaleContextCache();
+
+	ScaleContextCache(ScaleContextCache const&) = delete;
+	ScaleContextCache& operator=(ScaleContextCache const&) = delete;
+
+	/** Everything that goes into sws_getContext() and sws_setColorspaceDetails() */
+	class Key
+	{
+	public:
+		Key(
+			dcp::Size in_size_,
+			AVPixelFormat in_format_,
+			dcp::Size out_size_,
+			AVPixelFormat out_format_,
+			int flags_,
+			dcp::YUVToRGB yuv_to_rgb_,
+			int in_range_,
+			int out_range_
+		   )
+			: in_size(in_size_)
+			, in_format(in_format_)
+			, out_size(out_size_)
+			, out_format(out_format_)
+			, flags(flags_)
+			, yuv_to_rgb(yuv_to_rgb_)
+			, in_range(in_range_)
+			, out_range(out_range_)
+		{}
+
+		dcp::Size in_size;
+		AVPixelFormat in_format;
+		dcp::Size out_size;
+		AVPixelFormat out_format;
+		/** SWS_* flags */
+		int flags;
+		dcp::YUVToRGB yuv_to_rgb;
+		/** source range as passed to sws_setColorspaceDetails() (0 for video, 1 for full) */
+		int in_range;
+		/** destination range as passed to sws_setColorspaceDetails() (0 for video, 1 for full) */
+		int out_range;
+
+		bool operator==(Key const& other) const;
+	};
+
+	/** A context which has been taken from the cache; it will be given back when this is destroyed */
+	class Context
+	{
+	public:
+		Context(ScaleContextCache* cache, Key key, SwsContext* context)
+			: _cache(cache)
+			, _key(key)
+			, _context(context)
+		{}
+
+		~Context();
+
+		Context(Context const&) = delete;
+		Context& operator=(Context const&) = delete;
+
+		SwsContext* get() const {
+			return _context;
+		}
+
+	private:
+		ScaleContextCache* _cache;
+		Key _key;
+		SwsContext* _context;
+	};
+
+	/** @return a context set up for the given parameters; throws std::runtime_error if one cannot be made */
+	std::unique_ptr<Context> get(Key const& key);
+
+	void clear();
+
+	int hits() const;
+	int misses() const;
+
+	static ScaleContextCache* instance();
+
+private:
+	void put(Key const& key, SwsContext* context);
+
+	mutable boost::mutex _mutex;
+	/** contexts which are not being used, with the most recently used at the front */
+	std::list<std::pair<Key, SwsContext*>> _idle;
+	/** maximum size of _idle */
+	size_t _maximum_idle = 32;
+	int _hits = 0;
+	int _misses = 0;
+};
+
+
+#endif
@@ -28,7 +28,11 @@
 #include "screen.h"
 #include <libxml++/libxml++.h>
 #include <boost/algorithm/string.hpp>
+#include <boost/asio.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <exception>
 
 
 using std::list;
@@ -51,6 +55,36 @@ Screen::trusted_device_thumbprints () const
 }
 
 
+static KDMWithMetadataPtr
+encrypt_for_screen(
+	dcp::DecryptedKDM const& decrypted,
+	shared_ptr<const dcp::CertificateChain> signer,
+	CinemaID cinema_id,
+	Cinema const& cinema,
+	Screen const& screen,
+	dcp::LocalTime valid_from,
+	dcp::LocalTime valid_to,
+	dcp::Formulation formulation,
+	bool disable_forensic_marking_picture,
+	optional<int> disable_forensic_marking_audio
+	)
+{
+	auto kdm = decrypted.encrypt(
+		signer, screen.recipient.get(), screen.trusted_device_thumbprints(), formulation, disable_forensic_marking_picture, disable_forensic_marking_audio
+		);
+
+	dcp::NameFormat::Map name_values;
+	name_values['c'] = cinema.name;
+	name_values['s'] = screen.name;
+	name_values['f'] = kdm.content_title_text();
+	name_values['b'] = valid_from.date() + " " + valid_from.time_of_day(true, false);
+	name_values['e'] = valid_to.date() + " " + valid_to.time_of_day(true, false);
+	name_values['i'] = kdm.cpl_id();
+
+	return make_shared<KDMWithMetadata>(name_values, cinema_id, cinema.emails, kdm);
+}
+
+
 KDMWithMetadataPtr
 kdm_for_screen (
 	std::function<dcp::DecryptedKDM (dcp::LocalTime, dcp::LocalTime)> make_kdm,
@@ -76,18 +110,88 @@ kdm_for_screen (
 		throw InvalidSignerError();
 	}
 
-	auto kdm = make_kdm(valid_from, valid_to).encrypt(
-		signer, screen.recipient.get(), screen.trusted_device_thumbprints(), formulation, disable_forensic_marking_picture, disable_forensic_marking_audio
+	return encrypt_for_screen(
+		make_kdm(valid_from, valid_to), signer, cinema_id, cinema, screen, valid_from, valid_to, formulation, disable_forensic_marking_picture, disable_forensic_marking_audio
 		);
+}
 
-	dcp::NameFormat::Map name_values;
-	name_values['c'] = cinema.name;
-	name_values['s'] = screen.name;
-	name_values['f'] = kdm.content_title_text();
-	name_values['b'] = valid_from.date() + " " + valid_from.time_of_day(true, false);
-	name_values['e'] = valid_to.date() + " " + valid_to.time_of_day(true, false);
-	name_values['i'] = kdm.cpl_id();
 
-	return make_shared<KDMWithMetadata>(name_values, cinema_id, cinema.emails, kdm);
+/** Make KDMs for some screens, encrypting and signing them on a pool of threads.
+ *  make_kdm is called once, on the calling thread, and its result is then encrypted for each screen.
+ *  @return KDMs in the same order as screens; screens without a recipient certificate are skipped.
+ */
+vector<KDMWithMetadataPtr>
+kdms_for_screens(
+	std::function<dcp::DecryptedKDM (dcp::LocalTime, dcp::LocalTime)> make_kdm,
+	vector<ScreenDetails> const& screens,
+	dcp::LocalTime valid_from,
+	dcp::LocalTime valid_to,
+	dcp::Formulation formulation,
+	bool disable_forensic_marking_picture,
+	optional<int> disable_forensic_marking_audio,
+	vector<KDMCertificatePeriod>& period_checks
+	)
+{
+	vector<ScreenDetails const*> recipients;
+	for (auto const& details: screens) {
+		if (details.screen.recipient) {
+			period_checks.push_back(
+				check_kdm_and_certificate_validity_periods(details.cinema.name, details.screen.name, details.screen.recipient.get(), valid_from, valid_to)
+				);
+			recipients.push_back(&details);
+		}
+	}
+
+	if (recipients.empty()) {
+		return {};
+	}
+
+	auto signer = Config::instance()->signer_chain();
+	if (!signer->valid()) {
+		throw InvalidSignerError();
+	}
+
+	auto const decrypted = make_kdm(valid_from, valid_to);
+
+	/* Each thread writes to its own entries in these, so that the output order does not
+	 * depend on which thread finishes first.
+	 */
+	vector<KDMWithMetadataPtr> kdms(recipients.size());
+	vector<std::exception_ptr> errors(recipients.size());
+
+	boost::asio::io_service service;
+	boost::thread_group pool;
+
+	auto work = make_shared<boost::asio::io_service::work>(service);
+
+	int const threads = std::max(1U, boost::thread::hardware_concurrency());
+	for (int i = 0; i < threads; ++i) {
+		pool.create_thread(boost::bind(&boost::asio::io_service::run, &service));
+	}
+
+	for (size_t i = 0; i < recipients.size(); ++i) {
+		service.post([&, i]() {
+			try {
+				auto const& details = *recipients[i];
+				kdms[i] = encrypt_for_screen(
+					decrypted, signer, details.cinema_id, details.cinema, details.screen, valid_from, valid_to, formulation, disable_forensic_marking_picture, disable_forensic_marking_audio
+					);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		});
+	}
+
+	work.reset();
+	pool.join_all();
+	service.stop();
+
+	for (auto error: errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	return kdms;
 }
 
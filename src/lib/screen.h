@@ -23,6 +23,7 @@
 #define DCPOMATIC_SCREEN_H
 
 
+#include "cinema.h"
 #include "cinema_list.h"
 #include "kdm_recipient.h"
 #include "kdm_util.h"
@@ -36,7 +37,6 @@
 #include <string>
 
 
-class Cinema;
 class Film;
 
 
@@ -86,4 +86,33 @@ kdm_for_screen (
 	);
 
 
+/** A screen to make a KDM for, with the cinema that it is in */
+class ScreenDetails
+{
+public:
+	ScreenDetails(CinemaID const& cinema_id, Cinema const& cinema, dcpomatic::Screen const& screen)
+		: cinema_id(cinema_id)
+		, cinema(cinema)
+		, screen(screen)
+	{}
+
+	CinemaID cinema_id;
+	Cinema cinema;
+	dcpomatic::Screen screen;
+};
+
+
+std::vector<KDMWithMetadataPtr>
+kdms_for_screens(
+	std::function<dcp::DecryptedKDM (dcp::LocalTime, dcp::LocalTime)> make_kdm,
+	std::vector<ScreenDetails> const& screens,
+	dcp::LocalTime valid_from,
+	dcp::LocalTime valid_to,
+	dcp::Formulation formulation,
+	bool disable_forensic_marking_picture,
+	boost::optional<int> disable_forensic_marking_audio,
+	std::vector<KDMCertificatePeriod>& period_checks
+	);
+
+
 #endif
@@ -31,6 +31,9 @@ public:
 	std::string name () const override;
 	std::string json_name () const override;
 	void run () override;
+	ResourceClass resource_class () const override {
+		return ResourceClass::LIGHT;
+	}
 
 private:
 	std::string _body;
@@ -38,6 +38,9 @@ public:
 	std::string name () const override;
 	std::string json_name () const override;
 	void run () override;
+	ResourceClass resource_class () const override {
+		return ResourceClass::LIGHT;
+	}
 
 private:
 	void add_file (std::string& body, boost::filesystem::path file) const;
@@ -0,0 +1,182 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "cross.h"
+#include "exceptions.h"
+#include "trace.h"
+#include <dcp/file.h>
+#include <cinttypes>
+
+
+using std::string;
+
+
+Trace::Trace()
+	: _enabled(false)
+	, _epoch(std::chrono::steady_clock::now())
+{
+
+}
+
+
+void
+Trace::start()
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	_events.clear();
+	/* Enough for a few minutes of a busy encode before we have to re-allocate */
+	_events.reserve(256 * 1024);
+	_enabled = true;
+}
+
+
+void
+Trace::stop()
+{
+	_enabled = false;
+}
+
+
+void
+Trace::span(char const* name, int64_t start, int64_t end, int64_t frame)
+{
+	if (!_enabled) {
+		return;
+	}
+
+	auto const thread = thread_id();
+	boost::mutex::scoped_lock lm(_mutex);
+	_events.emplace_back(name, 'X', thread, start, end - start, frame);
+}
+
+
+void
+Trace::counter(char const* name, int64_t value)
+{
+	if (!_enabled) {
+		return;
+	}
+
+	auto const time = now();
+	auto const thread = thread_id();
+	boost::mutex::scoped_lock lm(_mutex);
+	_events.emplace_back(name, 'C', thread, time, 0, value);
+}
+
+
+/** Set the name that will be shown in the trace for the calling thread */
+void
+Trace::set_thread_name(string name)
+{
+	auto const thread = thread_id();
+	boost::mutex::scoped_lock lm(_mutex);
+	_thread_names[thread] = name;
+}
+
+
+static
+string
+escape(string s)
+{
+	string out;
+	for (auto c: s) {
+		if (c == '"' || c == '\\') {
+			out += '\\';
+		}
+		if (static_cast<unsigned char>(c) >= 0x20) {
+			out += c;
+		}
+	}
+	return out;
+}
+
+
+/** Write everything that has been recorded since start() to a Chrome trace JSON file */
+void
+Trace::write(boost::filesystem::path path) const
+{
+	dcp::File file(path, "w");
+	if (!file) {
+		throw OpenFileError(path, file.open_error(), OpenFileError::WRITE);
+	}
+
+	boost::mutex::scoped_lock lm(_mutex);
+
+	fprintf(file.get(), "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	bool first = true;
+	auto separator = [&file, &first]() {
+		if (!first) {
+			fprintf(file.get(), ",\n");
+		}
+		first = false;
+	};
+
+	for (auto const& thread: _thread_names) {
+		separator();
+		fprintf(
+			file.get(),
+			"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu64 ",\"args\":{\"name\":\"%s\"}}",
+			thread.first, escape(thread.second).c_str()
+		       );
+	}
+
+	for (auto const& event: _events) {
+		separator();
+		if (event.phase == 'X') {
+			fprintf(
+				file.get(),
+				"{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%" PRIu64 ",\"ts\":%" PRId64 ",\"dur\":%" PRId64,
+				event.name, event.thread, event.time, event.duration
+			       );
+			if (event.value >= 0) {
+				fprintf(file.get(), ",\"args\":{\"frame\":%" PRId64 "}", event.value);
+			}
+			fprintf(file.get(), "}");
+		} else {
+			fprintf(
+				file.get(),
+				"{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%" PRIu64 ",\"ts\":%" PRId64 ",\"args\":{\"value\":%" PRId64 "}}",
+				event.name, event.thread, event.time, event.value
+			       );
+		}
+	}
+
+	fprintf(file.get(), "\n]}\n");
+}
+
+
+/** @return number of events recorded since start() */
+size_t
+Trace::events() const
+{
+	boost::mutex::scoped_lock lm(_mutex);
+	return _events.size();
+}
+
+
+Trace*
+Trace::instance()
+{
+	/* Never destroyed, as threads may still be recording into it during static destruction */
+	static auto trace = new Trace();
+	return trace;
+}
@@ -0,0 +1,160 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  src/lib/trace.h
+ *  @brief Trace class and TraceSpan helper.
+ */
+
+
+#ifndef DCPOMATIC_TRACE_H
+#define DCPOMATIC_TRACE_H
+
+
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+
+/** @class Trace
+ *  @brief A recorder of timed spans and counters from the encode and playback pipeline.
+ *
+ *  When started, parts of the pipeline (the player, decoders, butler, J2K encoder and
+ *  its threads and the writer) record what they are doing, and when; the result can be
+ *  written as a Chrome trace JSON file to be viewed in chrome://tracing or Perfetto.
+ *
+ *  When the trace is not started recording a span or counter costs one atomic load.
+ */
+class Trace
+{
+public:
+	Trace();
+
+	Trace(Trace const&) = delete;
+	Trace& operator=(Trace const&) = delete;
+
+	void start();
+	void stop();
+
+	bool enabled() const {
+		return _enabled;
+	}
+
+	/** @return Time in microseconds since this Trace was created */
+	int64_t now() const {
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _epoch).count();
+	}
+
+	/** Record a span of time spent doing something.
+	 *  @param name Name of the span; must be a string literal (or otherwise live forever).
+	 *  @param start Start time, from now().
+	 *  @param end End time, from now().
+	 *  @param frame Frame index that the span relates to, or -1.
+	 */
+	void span(char const* name, int64_t start, int64_t end, int64_t frame = -1);
+	/** Record the value of some counter, e.g. a queue depth.
+	 *  @param name Name of the counter; must be a string literal (or otherwise live forever).
+	 */
+	void counter(char const* name, int64_t value);
+
+	void set_thread_name(std::string name);
+
+	void write(boost::filesystem::path path) const;
+
+	size_t events() const;
+
+	static Trace* instance();
+
+private:
+	struct Event
+	{
+		Event(char const* name_, char phase_, uint64_t thread_, int64_t time_, int64_t duration_, int64_t value_)
+			: name(name_)
+			, phase(phase_)
+			, thread(thread_)
+			, time(time_)
+			, duration(duration_)
+			, value(value_)
+		{}
+
+		char const* name;
+		/** 'X' for a span, 'C' for a counter */
+		char phase;
+		uint64_t thread;
+		/** microseconds since _epoch */
+		int64_t time;
+		/** microseconds, for spans */
+		int64_t duration;
+		/** frame index for spans (or -1), value for counters */
+		int64_t value;
+	};
+
+	std::atomic<bool> _enabled;
+	std::chrono::steady_clock::time_point _epoch;
+
+	mutable boost::mutex _mutex;
+	std::vector<Event> _events;
+	std::map<uint64_t, std::string> _thread_names;
+};
+
+
+/** @class TraceSpan
+ *  @brief Record a span in the Trace covering the lifetime of this object.
+ */
+class TraceSpan
+{
+public:
+	/** @param name Name of the span; must be a string literal (or otherwise live forever).
+	 *  @param frame Frame index that the span relates to, or -1.
+	 */
+	explicit TraceSpan(char const* name, int64_t frame = -1)
+		: _name(name)
+		, _frame(frame)
+	{
+		auto trace = Trace::instance();
+		if (trace->enabled()) {
+			_start = trace->now();
+		}
+	}
+
+	~TraceSpan()
+	{
+		auto trace = Trace::instance();
+		if (_start >= 0 && trace->enabled()) {
+			trace->span(_name, _start, trace->now(), _frame);
+		}
+	}
+
+	TraceSpan(TraceSpan const&) = delete;
+	TraceSpan& operator=(TraceSpan const&) = delete;
+
+private:
+	char const* _name;
+	int64_t _frame;
+	int64_t _start = -1;
+};
+
+
+#endif
@@ -133,6 +133,13 @@ TranscodeJob::run ()
 
 		LOG_GENERAL(N_("Transcode job completed successfully: %1 fps"), dcp::locale_convert<string>(frames_per_second(), 2, true));
 
+		for (auto const& server: _encoder->server_statistics()) {
+			LOG_GENERAL(
+				N_("Encode server %1 made %2 frames with a mean latency of %3s"),
+				server.host_name, server.frames, dcp::locale_convert<string>(server.latency, 2, true)
+				);
+		}
+
 		if (variant::count_created_dcps() && dynamic_pointer_cast<DCPFilmEncoder>(_encoder)) {
 			try {
 				Analytics::instance()->successful_dcp_encode();
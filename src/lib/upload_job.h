@@ -36,6 +36,9 @@ public:
 	std::string name () const override;
 	std::string json_name () const override;
 	void run () override;
+	ResourceClass resource_class () const override {
+		return ResourceClass::IO;
+	}
 	std::string status () const override;
 
 private:
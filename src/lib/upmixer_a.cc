@@ -94,7 +94,7 @@ UpmixerA::run (shared_ptr<const AudioBuffers> in, int channels)
 	all_out.push_back (_ls.run(in_L));
 	all_out.push_back (_rs.run(in_R));
 
-	auto out = make_shared<AudioBuffers>(channels, in->frames());
+	auto out = make_shared<AudioBuffers>(channels, in->frames(), AudioBuffers::Contents::UNDEFINED);
 	int const N = min (channels, 6);
 
 	for (int i = 0; i < N; ++i) {
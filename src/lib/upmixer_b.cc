@@ -102,7 +102,7 @@ UpmixerB::run (shared_ptr<const AudioBuffers> in, int channels)
 	shared_ptr<AudioBuffers> S;
 	if (channels > 4) {
 		/* Ls is L - R with some delay */
-		auto sub = make_shared<AudioBuffers>(1, in->frames());
+		auto sub = make_shared<AudioBuffers>(1, in->frames(), AudioBuffers::Contents::UNDEFINED);
 		sub->copy_channel_from (in.get(), 0, 0);
 		float* p = sub->data (0);
 		float const * q = in->data (1);
@@ -27,6 +27,7 @@
 
 
 #include "audio_buffers.h"
+#include "audio_mix.h"
 #include "audio_processor.h"
 #include "cinema_sound_processor.h"
 #include "compose.hpp"
@@ -48,6 +49,7 @@
 #include "render_text.h"
 #include "string_text.h"
 #include "text_decoder.h"
+#include "trace.h"
 #include "util.h"
 #include "variant.h"
 #include "video_content.h"
@@ -756,6 +758,25 @@ asset_filename (shared_ptr<dcp::Asset> asset, string type, int reel_index, int r
 }
 
 
+/** @return metadata to put into MXF files that we write, taken from the configuration */
+dcp::MXFMetadata
+mxf_metadata ()
+{
+	dcp::MXFMetadata meta;
+	auto config = Config::instance();
+	if (!config->dcp_company_name().empty()) {
+		meta.company_name = config->dcp_company_name ();
+	}
+	if (!config->dcp_product_name().empty()) {
+		meta.product_name = config->dcp_product_name ();
+	}
+	if (!config->dcp_product_version().empty()) {
+		meta.product_version = config->dcp_product_version ();
+	}
+	return meta;
+}
+
+
 string
 video_asset_filename(shared_ptr<dcp::PictureAsset> asset, int reel_index, int reel_count, optional<string> summary)
 {
@@ -870,28 +891,59 @@ audio_channel_types (list<int> mapped, int channels)
 	return make_pair (non_lfe, lfe);
 }
 
+/** Remap some audio into a new AudioBuffers.
+ *  @param input Audio to remap.
+ *  @param output_channels Number of channels that the output should have.
+ *  @param map Mapping from input to output channels.
+ */
 shared_ptr<AudioBuffers>
-remap (shared_ptr<const AudioBuffers> input, int output_channels, AudioMapping map)
+remap (shared_ptr<const AudioBuffers> input, int output_channels, AudioMapping const& map)
 {
-	auto mapped = make_shared<AudioBuffers>(output_channels, input->frames());
-	mapped->make_silent ();
-
-	int to_do = min (map.input_channels(), input->channels());
-
-	for (int i = 0; i < to_do; ++i) {
-		for (int j = 0; j < mapped->channels(); ++j) {
-			if (map.get(i, j) > 0) {
-				mapped->accumulate_channel(
-					input.get(),
-					i,
-					j,
-					map.get(i, j)
-					);
+	auto mapped = make_shared<AudioBuffers>(output_channels, input->frames(), AudioBuffers::Contents::UNDEFINED);
+	remap (*input, map, *mapped);
+	return mapped;
+}
+
+
+/** Remap some audio into an existing AudioBuffers, overwriting whatever is there.
+ *  @param input Audio to remap.
+ *  @param map Mapping from input to output channels.
+ *  @param output Buffers to write to; these must have the same number of frames as input.
+ */
+void
+remap (AudioBuffers const& input, AudioMapping const& map, AudioBuffers& output)
+{
+	DCPOMATIC_ASSERT (output.frames() == input.frames());
+
+	int const to_do = min (map.input_channels(), input.channels());
+
+	/* Make a list of the inputs which contribute to each output; the inputs for output channel j are
+	 * inputs[first[j]] to inputs[first[j + 1] - 1].  Typical mappings are mostly zeros, so this is
+	 * much shorter than the whole matrix.
+	 */
+	vector<dcpomatic::MixInput> inputs;
+	vector<int> first;
+	for (int j = 0; j < output.channels(); ++j) {
+		first.push_back(inputs.size());
+		for (int i = 0; i < to_do; ++i) {
+			auto const gain = map.get(i, j);
+			if (gain > 0) {
+				inputs.push_back({ input.data(i), gain });
 			}
 		}
 	}
+	first.push_back(inputs.size());
 
-	return mapped;
+	/* Write all the outputs for a block of frames at a time, so that the inputs are still in cache
+	 * when they are used for more than one output.
+	 */
+	int const block = 1024;
+	for (int offset = 0; offset < input.frames(); offset += block) {
+		int const frames = min(block, input.frames() - offset);
+		for (int j = 0; j < output.channels(); ++j) {
+			dcpomatic::mix(inputs.data() + first[j], first[j + 1] - first[j], offset, output.data(j), frames);
+		}
+	}
 }
 
 
@@ -1071,19 +1123,14 @@ default_font_file ()
 /* Set to 1 to print the IDs of some of our threads to stdout on creation */
 #define DCPOMATIC_DEBUG_THREADS 0
 
-#if DCPOMATIC_DEBUG_THREADS
 void
 start_of_thread (string name)
 {
+#if DCPOMATIC_DEBUG_THREADS
 	std::cout << "THREAD:" << name << ":" << std::hex << pthread_self() << "\n";
-}
-#else
-void
-start_of_thread (string)
-{
-
-}
 #endif
+	Trace::instance()->set_thread_name(name);
+}
 
 
 string
@@ -35,6 +35,9 @@ public:
 	std::string name () const override;
 	std::string json_name () const override;
 	void run () override;
+	ResourceClass resource_class () const override {
+		return ResourceClass::IO;
+	}
 
 	dcp::VerificationResult const& result() const {
 		return _result;
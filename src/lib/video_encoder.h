@@ -24,6 +24,7 @@
 
 
 #include "dcpomatic_time.h"
+#include "encode_server_statistics.h"
 #include "event_history.h"
 #include "film.h"
 #include "player_video.h"
@@ -56,6 +57,11 @@ public:
 	int video_frames_enqueued() const;
 	boost::optional<float> current_encoding_rate() const;
 
+	/** @return statistics about any encode servers that we are using */
+	virtual std::vector<EncodeServerStatistics> server_statistics() const {
+		return {};
+	}
+
 protected:
 	/** Film that we are encoding */
 	std::shared_ptr<const Film> _film;
@@ -36,9 +36,11 @@
 #include "ratio.h"
 #include "reel_writer.h"
 #include "text_content.h"
+#include "trace.h"
 #include "util.h"
 #include "version.h"
 #include "writer.h"
+#include <dcp/asset.h>
 #include <dcp/cpl.h>
 #include <dcp/mono_mpeg2_picture_frame.h>
 #include <dcp/locale_convert.h>
@@ -153,6 +155,7 @@ Writer::write (shared_ptr<const Data> encoded, Frame frame, Eyes eyes)
 		/* There are too many full frames in memory; wake the main writer thread and
 		   wait until it sorts everything out */
 		_empty_condition.notify_all ();
+		TraceSpan span("Writer::write wait", frame);
 		_full_condition.wait (lock);
 	}
 
@@ -180,6 +183,31 @@ Writer::write(shared_ptr<dcp::MonoMPEG2PictureFrame> image, Frame frame)
 }
 
 
+/** Use a complete picture asset, made somewhere else, for a reel.  No frames must have
+ *  been written to the reel.
+ *  @param reel Index of the reel.
+ *  @param asset Picture asset MXF.
+ *  @param info Frame info file for the asset.
+ */
+void
+Writer::use_picture_asset(int reel, boost::filesystem::path asset, boost::filesystem::path info)
+{
+	DCPOMATIC_ASSERT(reel >= 0 && reel < static_cast<int>(_reels.size()));
+	_reels[reel].use_picture_asset(asset, info);
+}
+
+
+/** @return true if a reel is re-using some or all of a picture asset from a previous encode,
+ *  in which case there is no point in making that reel's picture asset somewhere else.
+ */
+bool
+Writer::has_existing_picture_asset(int reel) const
+{
+	DCPOMATIC_ASSERT(reel >= 0 && reel < static_cast<int>(_reels.size()));
+	return _reels[reel].first_nonexistent_frame() > 0;
+}
+
+
 bool
 Writer::can_repeat (Frame frame) const
 {
@@ -394,6 +422,7 @@ try
 
 			/* Nothing to do: wait until something happens which may indicate that we do */
 			LOG_TIMING (N_("writer-sleep queue=%1"), _queue.size());
+			TraceSpan span("Writer::thread wait");
 			_empty_condition.wait (lock);
 			LOG_TIMING (N_("writer-wake queue=%1"), _queue.size());
 		}
@@ -426,9 +455,12 @@ try
 			if (qi.type == QueueItem::Type::FULL && qi.encoded) {
 				--_queued_full_in_memory;
 			}
+			Trace::instance()->counter("Writer queue", _queue.size());
 
 			lock.unlock ();
 
+			TraceSpan span("Writer::thread write", qi.frame);
+
 			auto& reel = _reels[qi.reel];
 
 			switch (qi.type) {
@@ -481,6 +513,7 @@ try
 
 			LOG_GENERAL("Writer full; pushes %1 to disk while awaiting %2", item->frame, awaiting);
 
+			TraceSpan span("Writer::thread push to disk", item->frame);
 			item->encoded->write_via_temp(
 				film()->j2c_path(item->reel, item->frame, item->eyes, true),
 				film()->j2c_path(item->reel, item->frame, item->eyes, false)
@@ -521,6 +554,24 @@ Writer::terminate_thread (bool can_throw)
 }
 
 
+/** Calculate the digest of an asset's file, which will then be cached in the asset.
+ *  @param set_progress Method to call with progress; first parameter is the number of bytes
+ *  done, second parameter is the number of bytes in total.
+ */
+static void
+calculate_digest(shared_ptr<const dcp::Asset> asset, std::function<void (int64_t, int64_t)> set_progress)
+try
+{
+	asset->hash([set_progress](int64_t done, int64_t total) {
+		set_progress(done, total);
+	});
+} catch (boost::thread_interrupted) {
+	/* set_progress contains an interruption_point, so this may throw
+	 * thread_interrupted, at which point we just give up.
+	 */
+}
+
+
 void
 Writer::calculate_digests ()
 {
@@ -551,14 +602,19 @@ Writer::calculate_digests ()
 
 	int index = 0;
 
-	for (auto& i: _reels) {
-		service.post(
-			boost::bind(
-				&ReelWriter::calculate_digests,
-				&i,
-				std::function<void (int64_t, int64_t)>(boost::bind(set_progress, index, _1, _2))
-				));
-		++index;
+	/* Hash each asset in its own task, rather than each reel, so that (for example) the picture
+	 * and sound of a single-reel DCP are read at the same time.
+	 */
+	for (auto& reel: _reels) {
+		for (auto asset: reel.file_assets()) {
+			service.post(
+				boost::bind(
+					&calculate_digest,
+					asset,
+					std::function<void (int64_t, int64_t)>(boost::bind(set_progress, index, _1, _2))
+					));
+			++index;
+		}
 	}
 	service.post(
 		boost::bind(
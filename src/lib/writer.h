@@ -124,6 +124,8 @@ public:
 	void write (ReferencedReelAsset asset);
 	void write (std::shared_ptr<const dcp::AtmosFrame> atmos, dcpomatic::DCPTime time, AtmosMetadata metadata);
 	void write (std::shared_ptr<dcp::MonoMPEG2PictureFrame> image, Frame frame);
+	void use_picture_asset(int reel, boost::filesystem::path asset, boost::filesystem::path info);
+	bool has_existing_picture_asset(int reel) const;
 	void finish();
 
 	void set_encoder_threads (int threads);
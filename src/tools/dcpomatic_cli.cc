@@ -38,6 +38,7 @@
 #include "lib/make_dcp.h"
 #include "lib/ratio.h"
 #include "lib/signal_manager.h"
+#include "lib/trace.h"
 #include "lib/transcode_job.h"
 #include "lib/util.h"
 #include "lib/variant.h"
@@ -84,6 +85,7 @@ help (string n)
 	     << "      --export-format <format>      export project to a file, rather than making a DCP: specify mov or mp4\n"
 	     << "      --export-filename <filename>  filename to export to with --export-format\n"
 	     << "      --hints                       analyze film for hints before encoding and abort if any are found\n"
+	     << "      --trace <filename>            write a Chrome trace JSON file showing what the encoder threads were doing\n"
 	     << "\n"
 	     << "<FILM> is the film directory.\n";
 }
@@ -285,6 +287,7 @@ main (int argc, char* argv[])
 	optional<string> export_format;
 	optional<boost::filesystem::path> export_filename;
 	bool hints = false;
+	optional<boost::filesystem::path> trace;
 
 	int option_index = 0;
 	while (true) {
@@ -307,10 +310,11 @@ main (int argc, char* argv[])
 			{ "export-format", required_argument, 0, 'C' },
 			{ "export-filename", required_argument, 0, 'D' },
 			{ "hints", no_argument, 0, 'E' },
+			{ "trace", required_argument, 0, 'F' },
 			{ 0, 0, 0, 0 }
 		};
 
-		int c = getopt_long(fixer.argc(), fixer.argv(), "vhfnrt:j:kAs:ldc:BC:D:E", long_options, &option_index);
+		int c = getopt_long(fixer.argc(), fixer.argv(), "vhfnrt:j:kAs:ldc:BC:D:EF:", long_options, &option_index);
 
 		if (c == -1) {
 			break;
@@ -369,6 +373,9 @@ main (int argc, char* argv[])
 		case 'E':
 			hints = true;
 			break;
+		case 'F':
+			trace = optarg;
+			break;
 		}
 	}
 
@@ -520,6 +527,10 @@ main (int argc, char* argv[])
 
 	TranscodeJob::ChangedBehaviour const behaviour = check ? TranscodeJob::ChangedBehaviour::STOP : TranscodeJob::ChangedBehaviour::IGNORE;
 
+	if (trace) {
+		Trace::instance()->start();
+	}
+
 	if (export_format) {
 		auto job = std::make_shared<TranscodeJob>(film, behaviour);
 		job->set_encoder (
@@ -539,6 +550,15 @@ main (int argc, char* argv[])
 
 	bool const error = show_jobs_on_console (progress);
 
+	if (trace) {
+		Trace::instance()->stop();
+		try {
+			Trace::instance()->write(*trace);
+		} catch (std::exception& e) {
+			cerr << "Could not write trace: " << e.what() << "\n";
+		}
+	}
+
 	if (keep_going) {
 		while (true) {
 			dcpomatic_sleep_seconds (3600);
@@ -202,6 +202,14 @@ try
 		}
 		auto device = *device_opt;
 
+		auto buffers_opt = nanomsg->receive (LONG_TIMEOUT);
+		if (!buffers_opt) {
+			LOG_DISK_NC("Failed to receive write request");
+			throw CommunicationFailedError();
+		}
+		/* Don't let the front-end make us use an unreasonable amount of memory */
+		auto const buffers = std::max(2, std::min(64, atoi(buffers_opt->c_str())));
+
 		vector<boost::filesystem::path> dcp_paths;
 		while (true) {
 			auto dcp_path_opt = nanomsg->receive (LONG_TIMEOUT);
@@ -267,7 +275,7 @@ try
 
 		request_privileges (
 			"com.dcpomatic.write-drive",
-			[dcp_paths, device]() {
+			[dcp_paths, device, buffers]() {
 #if defined(DCPOMATIC_LINUX)
 				auto posix_partition = device;
 				/* XXX: don't know if this logic is sensible */
@@ -276,12 +284,12 @@ try
 				} else {
 					posix_partition += "1";
 				}
-				dcpomatic::write (dcp_paths, device, posix_partition, nanomsg);
+				dcpomatic::write (dcp_paths, device, posix_partition, buffers, nanomsg);
 #elif defined(DCPOMATIC_OSX)
 				auto fast_device = boost::algorithm::replace_first_copy (device, "/dev/disk", "/dev/rdisk");
-				dcpomatic::write (dcp_paths, fast_device, fast_device + "s1", nanomsg);
+				dcpomatic::write (dcp_paths, fast_device, fast_device + "s1", buffers, nanomsg);
 #elif defined(DCPOMATIC_WINDOWS)
-				dcpomatic::write (dcp_paths, device, "", nanomsg);
+				dcpomatic::write (dcp_paths, device, "", buffers, nanomsg);
 #endif
 			},
 			[]() {
@@ -349,7 +349,7 @@ private:
 
 	void main_thread ()
 	try {
-		EncodeServer server (false, Config::instance()->server_encoding_threads());
+		EncodeServer server (false, Config::instance()->server_encoding_threads(), Config::instance()->server_reel_encoding());
 		server.run ();
 	} catch (...) {
 		store_current ();
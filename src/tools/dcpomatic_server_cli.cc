@@ -59,6 +59,7 @@ help (string n)
 	     << variant::insert_dcpomatic("  -v, --version      show %1 version\n")
 	     << "  -h, --help         show this help\n"
 	     << "  -t, --threads      number of parallel encoding threads to use\n"
+	     << "  --reel-encoding    accept requests from masters to encode whole reels\n"
 	     << "  --verbose          be verbose to stdout\n"
 	     << "  --log              write a log file of activity\n";
 }
@@ -75,6 +76,7 @@ main (int argc, char* argv[])
 	int num_threads = Config::instance()->server_encoding_threads ();
 	bool verbose = false;
 	bool write_log = false;
+	bool reel_encoding = Config::instance()->server_reel_encoding();
 
 	int option_index = 0;
 	while (true) {
@@ -84,10 +86,11 @@ main (int argc, char* argv[])
 			{ "threads", required_argument, 0, 't'},
 			{ "verbose", no_argument, 0, 'A'},
 			{ "log", no_argument, 0, 'B'},
+			{ "reel-encoding", no_argument, 0, 'C'},
 			{ 0, 0, 0, 0 }
 		};
 
-		int c = getopt_long(fixer.argc(), fixer.argv(), "vht:AB", long_options, &option_index);
+		int c = getopt_long(fixer.argc(), fixer.argv(), "vht:ABC", long_options, &option_index);
 
 		if (c == -1) {
 			break;
@@ -109,6 +112,9 @@ main (int argc, char* argv[])
 		case 'B':
 			write_log = true;
 			break;
+		case 'C':
+			reel_encoding = true;
+			break;
 		}
 	}
 
@@ -121,7 +127,7 @@ main (int argc, char* argv[])
 	setup_grok_library_path();
 #endif
 
-	EncodeServer server (verbose, num_threads);
+	EncodeServer server (verbose, num_threads, reel_encoding);
 
 	try {
 		server.run ();
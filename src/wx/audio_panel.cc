@@ -467,12 +467,15 @@ AudioPanel::setup_peak ()
 
 
 void
-AudioPanel::active_jobs_changed (optional<string> old_active, optional<string> new_active)
+AudioPanel::active_jobs_changed (set<string> const& old_active, set<string> const& new_active)
 {
-	if (old_active && *old_active == "analyse_audio") {
+	bool const was_analysing = old_active.find("analyse_audio") != old_active.end();
+	bool const is_analysing = new_active.find("analyse_audio") != new_active.end();
+
+	if (was_analysing && !is_analysing) {
 		setup_peak ();
 		_mapping->Enable (true);
-	} else if (new_active && *new_active == "analyse_audio") {
+	} else if (!was_analysing && is_analysing) {
 		_mapping->Enable (false);
 	}
 }
@@ -23,6 +23,7 @@
 #include "content_widget.h"
 #include "timecode.h"
 #include "lib/audio_mapping.h"
+#include <set>
 
 
 class AudioDialog;
@@ -52,7 +53,7 @@ private:
 	void mapping_changed (AudioMapping);
 	void setup_description ();
 	void setup_peak ();
-	void active_jobs_changed (boost::optional<std::string>, boost::optional<std::string>);
+	void active_jobs_changed (std::set<std::string> const& old_active, std::set<std::string> const& new_active);
 	void setup_sensitivity ();
 	void add_to_grid () override;
 	boost::optional<float> peak () const;
@@ -48,6 +48,7 @@ LIBDCP_DISABLE_WARNINGS
 #include <wx/tglbtn.h>
 #include <wx/wx.h>
 LIBDCP_ENABLE_WARNINGS
+#include <algorithm>
 
 
 using std::cout;
@@ -55,6 +56,7 @@ using std::dynamic_pointer_cast;
 using std::exception;
 using std::list;
 using std::make_pair;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::weak_ptr;
@@ -291,9 +293,9 @@ Controls::update_position_label ()
 
 
 void
-Controls::active_jobs_changed (optional<string> j)
+Controls::active_jobs_changed (set<string> const& active)
 {
-	_active_job = j;
+	_active_jobs = active;
 	setup_sensitivity ();
 }
 
@@ -355,7 +357,7 @@ void
 Controls::setup_sensitivity ()
 {
 	/* examine content is the only job which stops the viewer working */
-	bool const active_job = _active_job && *_active_job != "examine_content";
+	bool const active_job = std::any_of(_active_jobs.begin(), _active_jobs.end(), [](string const& job) { return job != "examine_content"; });
 	bool const c = _film && !_film->content().empty() && !active_job;
 
 	_slider->Enable (c);
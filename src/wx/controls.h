@@ -31,6 +31,7 @@ LIBDCP_DISABLE_WARNINGS
 #include <wx/wx.h>
 LIBDCP_ENABLE_WARNINGS
 #include <boost/signals2.hpp>
+#include <set>
 
 
 class CheckBox;
@@ -83,7 +84,7 @@ protected:
 	MarkersPanel* _markers;
 	wxSlider* _slider;
 	FilmViewer& _viewer;
-	boost::optional<std::string> _active_job;
+	std::set<std::string> _active_jobs;
 
 private:
 
@@ -97,7 +98,7 @@ private:
 	void frame_number_clicked ();
 	void jump_to_selected_clicked ();
 	void timecode_clicked ();
-	void active_jobs_changed (boost::optional<std::string>);
+	void active_jobs_changed (std::set<std::string> const& active);
 	dcpomatic::DCPTime nudge_amount (wxKeyboardState& ev);
 	void image_changed (std::weak_ptr<PlayerVideo>);
 	void outline_content_changed ();
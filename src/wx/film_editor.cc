@@ -40,6 +40,7 @@ LIBDCP_ENABLE_WARNINGS
 
 
 using std::list;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::weak_ptr;
@@ -177,9 +178,9 @@ FilmEditor::set_general_sensitivity (bool s)
 
 
 void
-FilmEditor::active_jobs_changed (optional<string> j)
+FilmEditor::active_jobs_changed (set<string> const& active)
 {
-	set_general_sensitivity (!j);
+	set_general_sensitivity (active.empty());
 }
 
 
@@ -30,6 +30,7 @@ LIBDCP_DISABLE_WARNINGS
 #include <wx/wx.h>
 LIBDCP_ENABLE_WARNINGS
 #include <boost/signals2.hpp>
+#include <set>
 
 
 class ContentPanel;
@@ -70,7 +71,7 @@ private:
 	void film_content_change (ChangeType type, int);
 
 	void set_general_sensitivity (bool);
-	void active_jobs_changed (boost::optional<std::string>);
+	void active_jobs_changed (std::set<std::string> const& active);
 
 	void page_changed(wxBookCtrlEvent& ev);
 
@@ -43,6 +43,7 @@
 #include "lib/film.h"
 #include "lib/filter.h"
 #include "lib/image.h"
+#include "lib/j2k_decode_cache.h"
 #include "lib/job_manager.h"
 #include "lib/log.h"
 #include "lib/player.h"
@@ -160,6 +161,8 @@ FilmViewer::set_film (shared_ptr<Film> film)
 
 	_video_view->clear ();
 	_closed_captions_dialog->clear ();
+	/* Frames from the old film are no use to us now */
+	J2KDecodeCache::instance()->clear();
 
 	destroy_butler();
 
@@ -770,6 +773,8 @@ void
 FilmViewer::set_dcp_decode_reduction (optional<int> reduction)
 {
 	_dcp_decode_reduction = reduction;
+	/* Frames decoded at the old reduction will not be asked for again */
+	J2KDecodeCache::instance()->clear();
 	if (_player) {
 		_player->set_dcp_decode_reduction (reduction);
 	}
@@ -1567,6 +1567,18 @@ private:
 		table->Add (_only_servers_encode, 1, wxEXPAND | wxLEFT, DCPOMATIC_SIZER_GAP);
 		table->AddSpacer (0);
 
+		_compress_images_to_servers = new CheckBox(_panel, _("Compress images sent to encoding servers"));
+		table->Add(_compress_images_to_servers, 1, wxEXPAND | wxLEFT, DCPOMATIC_SIZER_GAP);
+		table->AddSpacer(0);
+
+		_encode_reels_on_servers = new CheckBox(_panel, _("Encode whole reels on servers with shared storage"));
+		table->Add(_encode_reels_on_servers, 1, wxEXPAND | wxLEFT, DCPOMATIC_SIZER_GAP);
+		table->AddSpacer(0);
+
+		_server_reel_encoding = new CheckBox(_panel, _("Allow masters to encode whole reels on this machine when it is a server"));
+		table->Add(_server_reel_encoding, 1, wxEXPAND | wxLEFT, DCPOMATIC_SIZER_GAP);
+		table->AddSpacer(0);
+
 		_layout_for_short_screen = new CheckBox(_panel, _("Layout for short screen"));
 		table->Add(_layout_for_short_screen, 1, wxEXPAND | wxLEFT, DCPOMATIC_SIZER_GAP);
 		table->AddSpacer (0);
@@ -1579,6 +1591,39 @@ private:
 			table->Add (s, 1);
 		}
 
+		add_label_to_sizer(table, _panel, _("Maximum simultaneous CPU-heavy jobs"), true, 0, wxLEFT | wxRIGHT | wxALIGN_CENTRE_VERTICAL);
+		_maximum_cpu_jobs = new wxSpinCtrl(_panel);
+		table->Add(_maximum_cpu_jobs, 1);
+
+		add_label_to_sizer(table, _panel, _("Maximum simultaneous I/O-heavy jobs"), true, 0, wxLEFT | wxRIGHT | wxALIGN_CENTRE_VERTICAL);
+		_maximum_io_jobs = new wxSpinCtrl(_panel);
+		table->Add(_maximum_io_jobs, 1);
+
+		add_label_to_sizer(table, _panel, _("Maximum simultaneous light jobs"), true, 0, wxLEFT | wxRIGHT | wxALIGN_CENTRE_VERTICAL);
+		_maximum_light_jobs = new wxSpinCtrl(_panel);
+		table->Add(_maximum_light_jobs, 1);
+
+		add_label_to_sizer(table, _panel, _("Number of threads to decode with when making DCPs"), true, 0, wxLEFT | wxRIGHT | wxALIGN_CENTRE_VERTICAL);
+		_dcp_decode_threads = new wxSpinCtrl(_panel);
+		table->Add(_dcp_decode_threads, 1);
+
+		{
+			add_label_to_sizer(table, _panel, _("Memory to use for caching decoded DCP frames"), true, 0, wxLEFT | wxRIGHT | wxALIGN_CENTRE_VERTICAL);
+			auto s = new wxBoxSizer(wxHORIZONTAL);
+			_j2k_decode_cache_size = new wxSpinCtrl(_panel);
+			s->Add(_j2k_decode_cache_size, 1);
+			add_label_to_sizer(s, _panel, _("MB"), false, 0, wxLEFT | wxALIGN_CENTRE_VERTICAL);
+			table->Add(s, 1);
+		}
+
+		add_label_to_sizer(table, _panel, _("Number of 16MB buffers to use when writing to drives"), true, 0, wxLEFT | wxRIGHT | wxALIGN_CENTRE_VERTICAL);
+		_disk_writer_buffers = new wxSpinCtrl(_panel);
+		table->Add(_disk_writer_buffers, 1);
+
+		_decode_ahead = new CheckBox(_panel, _("Decode video files ahead on a separate thread"));
+		table->Add(_decode_ahead, 1, wxEXPAND | wxLEFT, DCPOMATIC_SIZER_GAP);
+		table->AddSpacer(0);
+
 		{
 			auto format = create_label (_panel, _("DCP metadata filename format"), true);
 #ifdef DCPOMATIC_OSX
@@ -1663,8 +1708,24 @@ private:
 		_video_display_mode->Bind (wxEVT_CHOICE, boost::bind(&AdvancedPage::video_display_mode_changed, this));
 		_show_experimental_audio_processors->bind(&AdvancedPage::show_experimental_audio_processors_changed, this);
 		_only_servers_encode->bind(&AdvancedPage::only_servers_encode_changed, this);
+		_compress_images_to_servers->bind(&AdvancedPage::compress_images_to_servers_changed, this);
+		_encode_reels_on_servers->bind(&AdvancedPage::encode_reels_on_servers_changed, this);
+		_server_reel_encoding->bind(&AdvancedPage::server_reel_encoding_changed, this);
 		_layout_for_short_screen->bind(&AdvancedPage::layout_for_short_screen_changed, this);
 		_frames_in_memory_multiplier->Bind (wxEVT_SPINCTRL, boost::bind(&AdvancedPage::frames_in_memory_multiplier_changed, this));
+		_maximum_cpu_jobs->SetRange(1, 64);
+		_maximum_cpu_jobs->Bind(wxEVT_SPINCTRL, boost::bind(&AdvancedPage::maximum_jobs_changed, this));
+		_maximum_io_jobs->SetRange(1, 64);
+		_maximum_io_jobs->Bind(wxEVT_SPINCTRL, boost::bind(&AdvancedPage::maximum_jobs_changed, this));
+		_maximum_light_jobs->SetRange(1, 64);
+		_maximum_light_jobs->Bind(wxEVT_SPINCTRL, boost::bind(&AdvancedPage::maximum_jobs_changed, this));
+		_dcp_decode_threads->SetRange(1, 32);
+		_dcp_decode_threads->Bind(wxEVT_SPINCTRL, boost::bind(&AdvancedPage::dcp_decode_threads_changed, this));
+		_j2k_decode_cache_size->SetRange(0, 65536);
+		_j2k_decode_cache_size->Bind(wxEVT_SPINCTRL, boost::bind(&AdvancedPage::j2k_decode_cache_size_changed, this));
+		_disk_writer_buffers->SetRange(2, 64);
+		_disk_writer_buffers->Bind(wxEVT_SPINCTRL, boost::bind(&AdvancedPage::disk_writer_buffers_changed, this));
+		_decode_ahead->bind(&AdvancedPage::decode_ahead_changed, this);
 		_dcp_metadata_filename_format->Changed.connect (boost::bind (&AdvancedPage::dcp_metadata_filename_format_changed, this));
 		_dcp_asset_filename_format->Changed.connect (boost::bind (&AdvancedPage::dcp_asset_filename_format_changed, this));
 		_log_general->bind(&AdvancedPage::log_changed, this);
@@ -1696,6 +1757,9 @@ private:
 		}
 		checked_set (_show_experimental_audio_processors, config->show_experimental_audio_processors ());
 		checked_set (_only_servers_encode, config->only_servers_encode ());
+		checked_set (_compress_images_to_servers, config->compress_images_to_servers());
+		checked_set (_encode_reels_on_servers, config->encode_reels_on_servers());
+		checked_set (_server_reel_encoding, config->server_reel_encoding());
 		checked_set (_layout_for_short_screen, config->layout_for_short_screen());
 		checked_set (_log_general, config->log_types() & LogEntry::TYPE_GENERAL);
 		checked_set (_log_warning, config->log_types() & LogEntry::TYPE_WARNING);
@@ -1708,6 +1772,13 @@ private:
 		checked_set (_log_debug_player, config->log_types() & LogEntry::TYPE_DEBUG_PLAYER);
 		checked_set (_log_debug_audio_analysis, config->log_types() & LogEntry::TYPE_DEBUG_AUDIO_ANALYSIS);
 		checked_set (_frames_in_memory_multiplier, config->frames_in_memory_multiplier());
+		checked_set(_maximum_cpu_jobs, config->maximum_cpu_jobs());
+		checked_set(_maximum_io_jobs, config->maximum_io_jobs());
+		checked_set(_maximum_light_jobs, config->maximum_light_jobs());
+		checked_set(_dcp_decode_threads, config->dcp_decode_threads());
+		checked_set(_j2k_decode_cache_size, config->j2k_decode_cache_size());
+		checked_set(_disk_writer_buffers, config->disk_writer_buffers());
+		checked_set(_decode_ahead, config->decode_ahead());
 #ifdef DCPOMATIC_WINDOWS
 		checked_set (_win32_console, config->win32_console());
 #endif
@@ -1727,6 +1798,34 @@ private:
 		Config::instance()->set_frames_in_memory_multiplier(_frames_in_memory_multiplier->GetValue());
 	}
 
+	void maximum_jobs_changed()
+	{
+		auto config = Config::instance();
+		config->set_maximum_cpu_jobs(_maximum_cpu_jobs->GetValue());
+		config->set_maximum_io_jobs(_maximum_io_jobs->GetValue());
+		config->set_maximum_light_jobs(_maximum_light_jobs->GetValue());
+	}
+
+	void dcp_decode_threads_changed()
+	{
+		Config::instance()->set_dcp_decode_threads(_dcp_decode_threads->GetValue());
+	}
+
+	void j2k_decode_cache_size_changed()
+	{
+		Config::instance()->set_j2k_decode_cache_size(_j2k_decode_cache_size->GetValue());
+	}
+
+	void disk_writer_buffers_changed()
+	{
+		Config::instance()->set_disk_writer_buffers(_disk_writer_buffers->GetValue());
+	}
+
+	void decode_ahead_changed()
+	{
+		Config::instance()->set_decode_ahead(_decode_ahead->GetValue());
+	}
+
 	void show_experimental_audio_processors_changed ()
 	{
 		Config::instance()->set_show_experimental_audio_processors(_show_experimental_audio_processors->GetValue());
@@ -1737,6 +1836,21 @@ private:
 		Config::instance()->set_only_servers_encode (_only_servers_encode->GetValue());
 	}
 
+	void compress_images_to_servers_changed()
+	{
+		Config::instance()->set_compress_images_to_servers(_compress_images_to_servers->GetValue());
+	}
+
+	void encode_reels_on_servers_changed()
+	{
+		Config::instance()->set_encode_reels_on_servers(_encode_reels_on_servers->GetValue());
+	}
+
+	void server_reel_encoding_changed()
+	{
+		Config::instance()->set_server_reel_encoding(_server_reel_encoding->GetValue());
+	}
+
 	void layout_for_short_screen_changed()
 	{
 		Config::instance()->set_layout_for_short_screen(_layout_for_short_screen->GetValue());
@@ -1797,8 +1911,18 @@ private:
 
 	wxChoice* _video_display_mode = nullptr;
 	wxSpinCtrl* _frames_in_memory_multiplier = nullptr;
+	wxSpinCtrl* _maximum_cpu_jobs = nullptr;
+	wxSpinCtrl* _maximum_io_jobs = nullptr;
+	wxSpinCtrl* _maximum_light_jobs = nullptr;
+	wxSpinCtrl* _dcp_decode_threads = nullptr;
+	wxSpinCtrl* _j2k_decode_cache_size = nullptr;
+	wxSpinCtrl* _disk_writer_buffers = nullptr;
+	CheckBox* _decode_ahead = nullptr;
 	CheckBox* _show_experimental_audio_processors = nullptr;
 	CheckBox* _only_servers_encode = nullptr;
+	CheckBox* _compress_images_to_servers = nullptr;
+	CheckBox* _encode_reels_on_servers = nullptr;
+	CheckBox* _server_reel_encoding = nullptr;
 	CheckBox* _layout_for_short_screen = nullptr;
 	NameFormatEditor* _dcp_metadata_filename_format = nullptr;
 	NameFormatEditor* _dcp_asset_filename_format = nullptr;
@@ -207,24 +207,23 @@ KDMDialog::make_clicked ()
 
 		CinemaList cinemas;
 
+		vector<ScreenDetails> screens;
 		for (auto screen: _screens->screens()) {
-			auto p = kdm_for_screen(
-				make_kdm,
-				screen.first,
-				*cinemas.cinema(screen.first),
-				*cinemas.screen(screen.second),
-				_timing->from(),
-				_timing->until(),
-				_output->formulation(),
-				!_output->forensic_mark_video(),
-				for_audio,
-				period_checks
-				);
-			if (p) {
-				kdms.push_back (p);
-			}
+			screens.push_back({screen.first, *cinemas.cinema(screen.first), *cinemas.screen(screen.second)});
 		}
 
+		auto const made = kdms_for_screens(
+			make_kdm,
+			screens,
+			_timing->from(),
+			_timing->until(),
+			_output->formulation(),
+			!_output->forensic_mark_video(),
+			for_audio,
+			period_checks
+			);
+		kdms.insert(kdms.end(), made.begin(), made.end());
+
 		if (
 			find_if(
 				period_checks.begin(),
@@ -42,6 +42,7 @@ LIBDCP_ENABLE_WARNINGS
 using std::dynamic_pointer_cast;
 using std::map;
 using std::make_shared;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using boost::bind;
@@ -68,7 +69,7 @@ SubtitleAppearanceDialog::SubtitleAppearanceDialog (wxWindow* parent, shared_ptr
 		_stream = ff->subtitle_stream ();
 		/* XXX: assuming that all FFmpeg streams have bitmap subs */
 		if (_stream->colours().empty()) {
-			_job_manager_connection = JobManager::instance()->ActiveJobsChanged.connect(boost::bind(&SubtitleAppearanceDialog::active_jobs_changed, this, _1));
+			_job_manager_connection = JobManager::instance()->ActiveJobsChanged.connect(boost::bind(&SubtitleAppearanceDialog::active_jobs_changed, this, _1, _2));
 			_job = JobManager::instance()->add(make_shared<ExamineFFmpegSubtitlesJob>(film, ff));
 		}
 	}
@@ -318,9 +319,13 @@ SubtitleAppearanceDialog::setup_sensitivity ()
 }
 
 void
-SubtitleAppearanceDialog::active_jobs_changed (optional<string> last)
+SubtitleAppearanceDialog::active_jobs_changed (set<string> const& old_active, set<string> const& new_active)
 {
-	if (last && *last == "examine_subtitles") {
+	auto const examining = [](set<string> const& active) {
+		return active.find("examine_subtitles") != active.end();
+	};
+
+	if (examining(old_active) && !examining(new_active)) {
 		_colours_panel->Show (true);
 		if (_finding) {
 			_finding->Show (false);
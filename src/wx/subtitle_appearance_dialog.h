@@ -27,6 +27,7 @@ LIBDCP_DISABLE_WARNINGS
 #include <wx/wx.h>
 LIBDCP_ENABLE_WARNINGS
 #include <boost/signals2.hpp>
+#include <set>
 
 
 class CheckBox;
@@ -53,7 +54,7 @@ private:
 	void restore ();
 	CheckBox* set_to (wxWindow* w, int& r);
 	void content_change (ChangeType type);
-	void active_jobs_changed (boost::optional<std::string> last);
+	void active_jobs_changed (std::set<std::string> const& old_active, std::set<std::string> const& new_active);
 	void add_colours ();
 
 	std::weak_ptr<const Film> _film;
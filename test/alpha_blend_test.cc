@@ -0,0 +1,110 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  test/alpha_blend_test.cc
+ *  @brief Time Image::alpha_blend for each pair of formats that it supports.
+ *  @ingroup selfcontained
+ *  @see test/image_test.cc
+ */
+
+
+#include "lib/image.h"
+#include <dcp/types.h>
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstring>
+
+
+using std::make_shared;
+using std::shared_ptr;
+
+
+/** Make something that looks a bit like a couple of lines of rendered subtitle: mostly
+ *  transparent, with some blocks of opaque and partially-transparent pixels.
+ */
+static
+shared_ptr<Image>
+subtitle_like(AVPixelFormat format, dcp::Size size)
+{
+	auto image = make_shared<Image>(format, size, Image::Alignment::PADDED);
+	image->make_transparent();
+
+	int const bytes_per_pixel = format == AV_PIX_FMT_RGBA64BE ? 8 : 4;
+
+	for (int y = 0; y < size.height; ++y) {
+		if ((y % 100) >= 60) {
+			continue;
+		}
+		auto p = image->data()[0] + y * image->stride()[0];
+		for (int x = size.width / 4; x < size.width * 3 / 4; ++x) {
+			if ((x % 40) < 25) {
+				for (int i = 0; i < bytes_per_pixel; ++i) {
+					p[x * bytes_per_pixel + i] = ((x % 40) < 5) ? 0x80 : 0xff;
+				}
+			}
+		}
+	}
+
+	return image;
+}
+
+
+BOOST_AUTO_TEST_CASE(alpha_blend_benchmark_test)
+{
+	dcp::Size const frame(3996, 2160);
+	dcp::Size const overlay(3996, 200);
+	int const repeats = 4;
+
+	for (auto target_format: {
+		AV_PIX_FMT_RGB24, AV_PIX_FMT_BGRA, AV_PIX_FMT_RGBA, AV_PIX_FMT_RGB48LE, AV_PIX_FMT_XYZ12LE,
+		AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P10, AV_PIX_FMT_YUV422P10LE, AV_PIX_FMT_YUV444P10LE
+		}) {
+
+		for (auto other_format: { AV_PIX_FMT_BGRA, AV_PIX_FMT_RGBA, AV_PIX_FMT_RGBA64BE }) {
+			auto target = make_shared<Image>(target_format, frame, Image::Alignment::PADDED);
+			for (int i = 0; i < target->planes(); ++i) {
+				memset(target->data()[i], 0x01, target->stride()[i] * target->sample_size(i).height);
+			}
+			auto const before = make_shared<Image>(*target);
+
+			/* Fully-transparent overlays must leave the target alone */
+			auto transparent = make_shared<Image>(other_format, overlay, Image::Alignment::PADDED);
+			transparent->make_transparent();
+			target->alpha_blend(transparent, Position<int>(0, frame.height - overlay.height - 100));
+			BOOST_REQUIRE(*target == *before);
+
+			auto subtitle = subtitle_like(other_format, overlay);
+			auto const start = std::chrono::steady_clock::now();
+			for (int i = 0; i < repeats; ++i) {
+				target->alpha_blend(subtitle, Position<int>(0, frame.height - overlay.height - 100));
+			}
+			auto const end = std::chrono::steady_clock::now();
+
+			BOOST_TEST_MESSAGE(
+				av_get_pix_fmt_name(other_format) << " onto " << av_get_pix_fmt_name(target_format) << ": " <<
+				std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / repeats << "us"
+				);
+		}
+	}
+}
@@ -0,0 +1,157 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** @file  test/audio_analyser_test.cc
+ *  @brief Check AudioAnalyser's calculations against a simple version, and time them.
+ *  @ingroup selfcontained
+ */
+
+
+#include "lib/audio_analyser.h"
+#include "lib/audio_analysis.h"
+#include "lib/audio_buffers.h"
+#include "lib/audio_point.h"
+#include "lib/film.h"
+#include "lib/image_content.h"
+#include "lib/playlist.h"
+#include "lib/video_content.h"
+#include "test.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <chrono>
+#include <random>
+
+
+using std::make_shared;
+using std::max;
+using std::vector;
+using namespace dcpomatic;
+
+
+/** Analyse the first few minutes of a 2-hour, 16-channel film (so that the number of samples
+ *  per point is what it would be for a real feature) and check the results against the
+ *  straightforward per-sample calculation that AudioAnalyser used to do.  Both versions
+ *  calculate LEQ(m) so that the timings can be compared.
+ */
+BOOST_AUTO_TEST_CASE(audio_analyser_16_channel_test)
+{
+	int const channels = 16;
+	int const rate = 48000;
+	int const block = 4800;
+	int const blocks = 2 * 60 * rate / block;
+
+	auto content = make_shared<ImageContent>("test/data/flat_red.png");
+	auto film = new_test_film("audio_analyser_16_channel_test", { content });
+	film->set_audio_channels(channels);
+	content->video->set_length(2 * 60 * 60 * 24);
+
+	AudioAnalyser analyser(film, film->playlist(), true, [](float) {});
+	auto const samples_per_point = std::max(int64_t(1), DCPTime(film->playlist()->length(film)).frames_round(rate) / 1024);
+
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> distribution(-1, 1);
+
+	/* Reference results */
+	vector<vector<AudioPoint>> points(channels);
+	vector<AudioPoint> current(channels);
+	vector<float> sample_peak(channels);
+	vector<Frame> sample_peak_frame(channels);
+
+	/* The same channel corrections as AudioAnalyser uses for 16 channels */
+	vector<double> channel_corrections(channels, 1);
+	for (auto c: { 4, 5, 8, 9, 10, 11 }) {
+		channel_corrections[c] = pow(10, -3.0 / 20);
+	}
+	for (auto c: { 6, 7, 12, 13, 14, 15 }) {
+		channel_corrections[c] = pow(10, -144.0 / 20);
+	}
+	leqm_nrt::Calculator leqm(channels, rate, 24, channel_corrections, 850, 64, boost::thread::hardware_concurrency());
+
+	std::chrono::duration<double> reference_time(0);
+	std::chrono::duration<double> analyser_time(0);
+
+	auto buffers = make_shared<AudioBuffers>(channels, block);
+	for (int b = 0; b < blocks; ++b) {
+		for (int c = 0; c < channels; ++c) {
+			/* Some silence to exercise the clamping of small values */
+			float const level = (b + c) % 5 == 0 ? 0 : 1.0f / (c + 1);
+			for (int i = 0; i < block; ++i) {
+				buffers->data(c)[i] = distribution(random) * level;
+			}
+		}
+
+		auto const start = std::chrono::steady_clock::now();
+
+		int64_t const done = int64_t(b) * block;
+		vector<double> interleaved(block * channels);
+		for (int c = 0; c < channels; ++c) {
+			for (int i = 0; i < block; ++i) {
+				float s = buffers->data(c)[i];
+				interleaved[i * channels + c] = s;
+				float as = fabsf(s);
+				if (as < 10e-7) {
+					s = as = 10e-7;
+				}
+				current[c][AudioPoint::RMS] += pow(s, 2);
+				current[c][AudioPoint::PEAK] = max(current[c][AudioPoint::PEAK], as);
+				if (as > sample_peak[c]) {
+					sample_peak[c] = as;
+					sample_peak_frame[c] = done + i;
+				}
+				if (((done + i) % samples_per_point) == 0) {
+					current[c][AudioPoint::RMS] = sqrt(current[c][AudioPoint::RMS] / samples_per_point);
+					points[c].push_back(current[c]);
+					current[c] = AudioPoint();
+				}
+			}
+		}
+
+		leqm.add(interleaved);
+
+		auto const middle = std::chrono::steady_clock::now();
+		analyser.analyse(buffers, DCPTime::from_frames(done, rate));
+		auto const end = std::chrono::steady_clock::now();
+
+		reference_time += middle - start;
+		analyser_time += end - middle;
+	}
+
+	analyser.finish();
+	auto analysis = analyser.get();
+
+	for (int c = 0; c < channels; ++c) {
+		BOOST_REQUIRE_EQUAL(analysis.points(c), static_cast<int>(points[c].size()));
+		for (int p = 0; p < analysis.points(c); ++p) {
+			auto point = analysis.get_point(c, p);
+			BOOST_CHECK_EQUAL(point[AudioPoint::PEAK], points[c][p][AudioPoint::PEAK]);
+			BOOST_CHECK_CLOSE(point[AudioPoint::RMS], points[c][p][AudioPoint::RMS], 0.1);
+		}
+		BOOST_CHECK_EQUAL(analysis.sample_peak()[c].peak, sample_peak[c]);
+		BOOST_CHECK(analysis.sample_peak()[c].time == DCPTime::from_frames(sample_peak_frame[c], rate));
+	}
+
+	BOOST_REQUIRE(analysis.leqm());
+	BOOST_CHECK_CLOSE(*analysis.leqm(), leqm.leq_m(), 0.001);
+
+	BOOST_TEST_MESSAGE(
+		"Per-sample, including LEQ(m): " << reference_time.count() << "s; "
+		"AudioAnalyser::analyse, including LEQ(m): " << analyser_time.count() << "s"
+		);
+}
@@ -25,7 +25,10 @@
 
 #include <cmath>
 #include <boost/test/unit_test.hpp>
+#include "lib/audio_buffer_pool.h"
 #include "lib/audio_buffers.h"
+#include "lib/audio_mapping.h"
+#include "lib/util.h"
 
 using std::pow;
 
@@ -385,3 +388,79 @@ BOOST_AUTO_TEST_CASE(audio_buffers_set_channels_higher)
 		}
 	}
 }
+
+
+/** Check that shrinking and re-growing buffers in place gives silence in the re-grown part */
+BOOST_AUTO_TEST_CASE(audio_buffers_shrink_and_grow)
+{
+	AudioBuffers buffers(6, 2000);
+	srand(5);
+	random_fill(buffers);
+
+	buffers.set_frames(100);
+	buffers.set_channels(2);
+	buffers.set_frames(1000);
+	buffers.set_channels(6);
+
+	srand(5);
+	for (int i = 0; i < 100; ++i) {
+		for (int c = 0; c < 6; ++c) {
+			auto const f = random_float();
+			if (c < 2) {
+				BOOST_CHECK_EQUAL(buffers.data(c)[i], f);
+			} else {
+				BOOST_CHECK_EQUAL(buffers.data(c)[i], 0);
+			}
+		}
+	}
+
+	for (int i = 100; i < 1000; ++i) {
+		for (int c = 0; c < 6; ++c) {
+			BOOST_CHECK_EQUAL(buffers.data(c)[i], 0);
+		}
+	}
+}
+
+
+/** Check that AudioBuffers of the same size re-use each other's memory */
+BOOST_AUTO_TEST_CASE(audio_buffers_pool_test)
+{
+	AudioBufferPool::instance()->clear();
+
+	float* data = nullptr;
+	{
+		AudioBuffers buffers(16, 4000);
+		data = buffers.data(0);
+	}
+
+	auto const hits = AudioBufferPool::instance()->statistics().hits;
+	AudioBuffers buffers(16, 4000, AudioBuffers::Contents::UNDEFINED);
+	BOOST_CHECK(buffers.data(0) == data);
+	BOOST_CHECK_EQUAL(AudioBufferPool::instance()->statistics().hits, hits + 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(audio_buffers_remap_test)
+{
+	AudioBuffers input(3, 500);
+	srand(6);
+	random_fill(input);
+
+	AudioMapping map(3, 4);
+	map.make_zero();
+	map.set(0, 0, 1);
+	map.set(1, 0, 0.5);
+	map.set(2, 2, 0.25);
+
+	/* Fill the output with rubbish to check that remap() overwrites all of it */
+	AudioBuffers output(4, 500);
+	random_fill(output);
+	remap(input, map, output);
+
+	for (int i = 0; i < 500; ++i) {
+		BOOST_CHECK_CLOSE(output.data(0)[i], input.data(0)[i] + input.data(1)[i] * 0.5, tolerance);
+		BOOST_CHECK_EQUAL(output.data(1)[i], 0);
+		BOOST_CHECK_CLOSE(output.data(2)[i], input.data(2)[i] * 0.25, tolerance);
+		BOOST_CHECK_EQUAL(output.data(3)[i], 0);
+	}
+}
@@ -0,0 +1,172 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  test/audio_mix_test.cc
+ *  @brief Check the optimised audio mixing functions against the plain versions, and time remap().
+ *  @ingroup selfcontained
+ */
+
+
+#include "lib/audio_buffers.h"
+#include "lib/audio_mapping.h"
+#include "lib/audio_mix.h"
+#include "lib/util.h"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+
+using std::vector;
+
+
+static void
+random_fill(AudioBuffers& buffers)
+{
+	for (int c = 0; c < buffers.channels(); ++c) {
+		for (int i = 0; i < buffers.frames(); ++i) {
+			buffers.data(c)[i] = float(rand()) / RAND_MAX - 0.5;
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(audio_mix_test)
+{
+	srand(1);
+
+	AudioBuffers in(5, 1031);
+	random_fill(in);
+
+	/* Odd sizes and offsets to check the handling of whatever is left over after the SIMD loops */
+	for (int count = 0; count <= 5; ++count) {
+		vector<dcpomatic::MixInput> inputs;
+		for (int i = 0; i < count; ++i) {
+			inputs.push_back({ in.data(i), float(rand()) / RAND_MAX });
+		}
+
+		for (auto offset: { 0, 1, 7 }) {
+			for (auto frames: { 0, 1, 13, 1024 }) {
+				vector<float> reference(1031);
+				vector<float> check(1031);
+				dcpomatic::mix_scalar(inputs.data(), count, offset, reference.data(), frames);
+				dcpomatic::mix(inputs.data(), count, offset, check.data(), frames);
+				BOOST_REQUIRE(reference == check);
+			}
+		}
+	}
+
+	/* Mixing into one of the inputs */
+	AudioBuffers reference(in);
+	AudioBuffers check(in);
+	dcpomatic::MixInput const reference_inputs[] = { { reference.data(0), 1 }, { reference.data(1), 0.5 } };
+	dcpomatic::mix_scalar(reference_inputs, 2, 0, reference.data(0), 1031);
+	dcpomatic::MixInput const check_inputs[] = { { check.data(0), 1 }, { check.data(1), 0.5 } };
+	dcpomatic::mix(check_inputs, 2, 0, check.data(0), 1031);
+	BOOST_REQUIRE(std::equal(reference.data(0), reference.data(0) + 1031, check.data(0)));
+
+	/* Gain */
+	for (auto frames: { 0, 3, 1031 }) {
+		AudioBuffers reference(in);
+		AudioBuffers check(in);
+		dcpomatic::apply_gain_scalar(reference.data(2), frames, 0.3);
+		dcpomatic::apply_gain(check.data(2), frames, 0.3);
+		BOOST_REQUIRE(std::equal(reference.data(2), reference.data(2) + 1031, check.data(2)));
+	}
+}
+
+
+/** The way remap() used to work: silence the output then accumulate each input / output pair in turn */
+static void
+remap_by_pairs(AudioBuffers const& input, AudioMapping const& map, AudioBuffers& output)
+{
+	output.make_silent();
+	for (int i = 0; i < std::min(map.input_channels(), input.channels()); ++i) {
+		for (int j = 0; j < output.channels(); ++j) {
+			auto const gain = map.get(i, j);
+			if (gain > 0) {
+				auto s = input.data(i);
+				auto d = output.data(j);
+				for (int k = 0; k < input.frames(); ++k) {
+					*d++ += (*s++) * gain;
+				}
+			}
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(audio_mix_remap_test)
+{
+	srand(2);
+
+	/* Stereo to 5.1, with L+R to centre */
+	AudioMapping two_to_six(2, 6);
+	two_to_six.make_zero();
+	two_to_six.set(0, 0, 1);
+	two_to_six.set(1, 1, 1);
+	two_to_six.set(0, 2, 0.707);
+	two_to_six.set(1, 2, 0.707);
+
+	/* 5.1 to 16 channels */
+	AudioMapping six_to_sixteen(6, 16);
+	six_to_sixteen.make_zero();
+	for (int i = 0; i < 6; ++i) {
+		six_to_sixteen.set(i, i, 1);
+	}
+
+	/* 16 channels straight through, with some gain */
+	AudioMapping sixteen_to_sixteen(16, 16);
+	sixteen_to_sixteen.make_zero();
+	for (int i = 0; i < 16; ++i) {
+		sixteen_to_sixteen.set(i, i, i % 2 ? 1 : 0.5);
+	}
+
+	for (auto map: { two_to_six, six_to_sixteen, sixteen_to_sixteen }) {
+		/* One second of 96kHz audio */
+		AudioBuffers input(map.input_channels(), 96000);
+		random_fill(input);
+		AudioBuffers reference(map.output_channels(), 96000);
+		AudioBuffers check(map.output_channels(), 96000);
+
+		int const repeats = 20;
+
+		auto const start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeats; ++i) {
+			remap_by_pairs(input, map, reference);
+		}
+		auto const middle = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeats; ++i) {
+			remap(input, map, check);
+		}
+		auto const end = std::chrono::steady_clock::now();
+
+		for (int c = 0; c < map.output_channels(); ++c) {
+			BOOST_REQUIRE(std::equal(reference.data(c), reference.data(c) + 96000, check.data(c)));
+		}
+
+		BOOST_TEST_MESSAGE(
+			map.input_channels() << " to " << map.output_channels() << ": by pairs " <<
+			std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count() / repeats << "us, mixed " <<
+			std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count() / repeats << "us"
+			);
+	}
+}
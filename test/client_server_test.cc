@@ -25,6 +25,7 @@
  */
 
 
+#include "lib/config.h"
 #include "lib/content_factory.h"
 #include "lib/cross.h"
 #include "lib/dcp_video.h"
@@ -46,6 +47,8 @@
 using std::list;
 using std::make_shared;
 using std::shared_ptr;
+using std::string;
+using std::vector;
 using std::weak_ptr;
 using boost::thread;
 using boost::optional;
@@ -109,7 +112,8 @@ BOOST_AUTO_TEST_CASE (client_server_test_rgb)
 		false
 		);
 
-	pvf->set_text (PositionImage(sub_image, Position<int>(50, 60)));
+	/* Two texts, one of them partly off the edge of the frame */
+	pvf->set_texts({ PositionImage(sub_image, Position<int>(50, 60)), PositionImage(sub_image, Position<int>(1950, 1000)) }, Image::Alignment::PADDED);
 
 	auto frame = make_shared<DCPVideo> (
 		pvf,
@@ -147,18 +151,25 @@ BOOST_AUTO_TEST_CASE (client_server_test_rgb)
 }
 
 
-BOOST_AUTO_TEST_CASE (client_server_test_yuv)
+static void
+test_yuv(string name, bool compress)
 {
-	auto image = make_shared<Image>(AV_PIX_FMT_YUV420P, dcp::Size (1998, 1080), Image::Alignment::PADDED);
+	ConfigRestorer cr;
+	Config::instance()->set_compress_images_to_servers(compress);
+
+	auto image = make_shared<Image>(AV_PIX_FMT_YUV420P, dcp::Size(1998, 1080), Image::Alignment::PADDED);
 
 	for (int i = 0; i < image->planes(); ++i) {
 		uint8_t* p = image->data()[i];
-		for (int j = 0; j < image->line_size()[i]; ++j) {
-			*p++ = j % 256;
+		for (int y = 0; y < image->sample_size(i).height; ++y) {
+			for (int x = 0; x < image->line_size()[i]; ++x) {
+				p[x] = (x + y) % 256;
+			}
+			p += image->stride()[i];
 		}
 	}
 
-	auto sub_image = make_shared<Image>(AV_PIX_FMT_BGRA, dcp::Size (100, 200), Image::Alignment::PADDED);
+	auto sub_image = make_shared<Image>(AV_PIX_FMT_BGRA, dcp::Size(100, 200), Image::Alignment::PADDED);
 	uint8_t* p = sub_image->data()[0];
 	for (int y = 0; y < 200; ++y) {
 		uint8_t* q = p;
@@ -171,7 +182,7 @@ BOOST_AUTO_TEST_CASE (client_server_test_yuv)
 		p += sub_image->stride()[0];
 	}
 
-	LogSwitcher ls (make_shared<FileLog>("build/test/client_server_test_yuv.log"));
+	LogSwitcher ls(make_shared<FileLog>("build/test/" + name + ".log"));
 
 	auto pvf = std::make_shared<PlayerVideo>(
 		std::make_shared<RawImageProxy>(image),
@@ -188,27 +199,21 @@ BOOST_AUTO_TEST_CASE (client_server_test_yuv)
 		false
 		);
 
-	pvf->set_text (PositionImage(sub_image, Position<int>(50, 60)));
+	pvf->set_texts({ PositionImage(sub_image, Position<int>(50, 60)) }, Image::Alignment::PADDED);
 
-	auto frame = make_shared<DCPVideo>(
-		pvf,
-		0,
-		24,
-		200000000,
-		Resolution::TWO_K
-		);
+	auto frame = make_shared<DCPVideo>(pvf, 0, 24, 200000000, Resolution::TWO_K);
 
-	auto locally_encoded = frame->encode_locally ();
+	auto locally_encoded = frame->encode_locally();
 
 	auto server = make_shared<EncodeServer>(true, 2);
 
 	thread server_thread(boost::bind(&EncodeServer::run, server));
 
 	/* Let the server get itself ready */
-	dcpomatic_sleep_seconds (1);
+	dcpomatic_sleep_seconds(1);
 
-	/* "localhost" rather than "127.0.0.1" here fails on docker; go figure */
-	EncodeServerDescription description ("127.0.0.1", 2, SERVER_LINK_VERSION);
+	EncodeServerDescription description("127.0.0.1", 2, SERVER_LINK_VERSION);
+	description.set_image_compression(compress);
 
 	list<thread> threads;
 	for (int i = 0; i < 8; ++i) {
@@ -221,7 +226,91 @@ BOOST_AUTO_TEST_CASE (client_server_test_yuv)
 
 	threads.clear();
 
-	server->stop ();
+	server->stop();
+	server_thread.join();
+}
+
+
+BOOST_AUTO_TEST_CASE (client_server_test_yuv)
+{
+	test_yuv("client_server_test_yuv", false);
+}
+
+
+/** Check that images are correctly sent to a server when lossless compression is enabled */
+BOOST_AUTO_TEST_CASE(client_server_test_yuv_compressed)
+{
+	test_yuv("client_server_test_yuv_compressed", true);
+}
+
+
+/** Check that a batch of frames sent on one connection comes back correctly */
+BOOST_AUTO_TEST_CASE(client_server_test_batch)
+{
+	auto image = make_shared<Image>(AV_PIX_FMT_RGB24, dcp::Size(1998, 1080), Image::Alignment::PADDED);
+	uint8_t* p = image->data()[0];
+	for (int y = 0; y < 1080; ++y) {
+		for (int x = 0; x < image->line_size()[0]; ++x) {
+			p[x] = (x * y) % 256;
+		}
+		p += image->stride()[0];
+	}
+
+	auto pvf = std::make_shared<PlayerVideo>(
+		std::make_shared<RawImageProxy>(image),
+		Crop(),
+		optional<double>(),
+		dcp::Size(1998, 1080),
+		dcp::Size(1998, 1080),
+		Eyes::BOTH,
+		Part::WHOLE,
+		ColourConversion(),
+		VideoRange::FULL,
+		weak_ptr<Content>(),
+		optional<ContentTime>(),
+		false
+		);
+
+	/* Use different bit rates so that each frame is different */
+	vector<DCPVideo> frames;
+	vector<ArrayData> locally_encoded;
+	for (int i = 0; i < 4; ++i) {
+		frames.push_back(DCPVideo(pvf, i, 24, 50000000 * (i + 1), Resolution::TWO_K));
+		locally_encoded.push_back(frames.back().encode_locally());
+	}
+
+	auto server = make_shared<EncodeServer>(true, 2);
+	thread server_thread(boost::bind(&EncodeServer::run, server));
+
+	/* Let the server get itself ready */
+	dcpomatic_sleep_seconds(1);
+
+	EncodeServerDescription description("127.0.0.1", 2, SERVER_LINK_VERSION);
+	description.set_keep_alive(true);
+
+	auto socket = DCPVideo::connect_to_server(description);
+
+	/* Send two batches on the same connection */
+	for (int batch = 0; batch < 2; ++batch) {
+		for (int i = 0; i < 4; ++i) {
+			frames[i].send_to_server(description, socket, batch * 4 + i, i == 3);
+		}
+
+		vector<bool> received(4, false);
+		for (int i = 0; i < 4; ++i) {
+			auto response = DCPVideo::receive_from_server_with_id(socket);
+			auto const index = response.first - batch * 4;
+			BOOST_REQUIRE(index >= 0 && index < 4);
+			BOOST_CHECK(!received[index]);
+			received[index] = true;
+			BOOST_REQUIRE_EQUAL(response.second.size(), locally_encoded[index].size());
+			BOOST_CHECK_EQUAL(memcmp(response.second.data(), locally_encoded[index].data(), response.second.size()), 0);
+		}
+	}
+
+	socket.reset();
+
+	server->stop();
 	server_thread.join();
 }
 
@@ -341,3 +430,65 @@ BOOST_AUTO_TEST_CASE(real_encode_with_server)
 	cl.run();
 }
 
+
+
+/** Check that a DCP with some reels encoded by a server is the same as one made locally */
+BOOST_AUTO_TEST_CASE(encode_reels_with_server)
+{
+	ConfigRestorer cr;
+	Cleanup cl;
+
+	auto make = [&cl](std::string name) {
+		auto film = new_test_film(name, content_factory("test/data/count300bd24.m2ts"), &cl);
+		film->set_reel_type(ReelType::BY_LENGTH);
+		film->set_reel_length(1024 * 1024 * 100);
+		make_and_verify_dcp(film);
+		return film;
+	};
+
+	auto mxfs = [](boost::filesystem::path dir) {
+		int n = 0;
+		for (auto const& i: boost::filesystem::directory_iterator(dir)) {
+			if (i.path().extension() == ".mxf") {
+				++n;
+			}
+		}
+		return n;
+	};
+
+	auto const local = make("encode_reels_with_server_local");
+
+	Config::instance()->set_encode_reels_on_servers(true);
+
+	EncodeServer server(true, 4, true);
+	thread server_thread(boost::bind(&EncodeServer::run, &server));
+
+	/* Wait for the server to be found, as reels are only shared out when the encode starts */
+	for (int i = 0; i < 30 && EncodeServerFinder::instance()->servers().empty(); ++i) {
+		dcpomatic_sleep_seconds(1);
+	}
+	BOOST_REQUIRE(!EncodeServerFinder::instance()->servers().empty());
+	BOOST_CHECK(EncodeServerFinder::instance()->servers().front().reel_encoding());
+
+	auto const remote = make("encode_reels_with_server_remote");
+	auto const remote_frames = server.frames_encoded();
+	BOOST_CHECK(remote_frames > 0);
+	auto const remote_mxfs = mxfs(remote->dir(remote->dcp_name()));
+
+	/* Making the DCP again should re-use all the picture assets, rather than asking the server to make
+	 * them again and leaving the old ones lying around.
+	 */
+	make_and_verify_dcp(remote);
+	/* The server may still be sent the first frame of each reel to encode, as that is never faked */
+	BOOST_CHECK(server.frames_encoded() - remote_frames <= static_cast<int>(remote->reels().size()));
+	BOOST_CHECK_EQUAL(mxfs(remote->dir(remote->dcp_name())), remote_mxfs);
+
+	server.stop();
+	server_thread.join();
+
+	EncodeServerFinder::drop();
+
+	check_dcp(local->dir(local->dcp_name()), remote->dir(remote->dcp_name()));
+
+	cl.run();
+}
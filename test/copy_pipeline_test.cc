@@ -0,0 +1,123 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  test/copy_pipeline_test.cc
+ *  @brief Test CopyPipeline, as used when writing DCPs to drives.
+ *  @ingroup selfcontained
+ */
+
+
+#include "lib/copy_pipeline.h"
+#include "lib/digester.h"
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <stdexcept>
+
+
+using std::vector;
+
+
+static vector<uint8_t>
+test_data(size_t length)
+{
+	vector<uint8_t> data(length);
+	for (size_t i = 0; i < length; ++i) {
+		data[i] = (i * 7 + i / 251) & 0xff;
+	}
+	return data;
+}
+
+
+/** Copy data with a CopyPipeline and check that it arrives intact and in order, with the right digest */
+static void
+check_copy(size_t length, int buffers, uint64_t block_size)
+{
+	auto const source = test_data(length);
+	size_t read_position = 0;
+	vector<uint8_t> destination;
+	size_t largest_block = 0;
+
+	CopyPipeline pipeline(
+		length,
+		buffers,
+		block_size,
+		[&source, &read_position](uint8_t* data, size_t size) {
+			BOOST_REQUIRE(read_position + size <= source.size());
+			memcpy(data, source.data() + read_position, size);
+			read_position += size;
+		});
+
+	auto const digest = pipeline.run([&destination, &largest_block](uint8_t const* data, size_t size) {
+		destination.insert(destination.end(), data, data + size);
+		largest_block = std::max(largest_block, size);
+	});
+
+	BOOST_CHECK(destination == source);
+	BOOST_CHECK(largest_block <= block_size);
+
+	Digester digester;
+	digester.add(source.data(), source.size());
+	BOOST_CHECK_EQUAL(digest, digester.get());
+}
+
+
+BOOST_AUTO_TEST_CASE(copy_pipeline_test)
+{
+	/* Many blocks, with a partial block at the end */
+	check_copy(1000003, 4, 4096);
+	/* An exact number of blocks */
+	check_copy(4096 * 16, 2, 4096);
+	/* More buffers than there are blocks */
+	check_copy(4096 * 2 + 1, 16, 4096);
+	/* A file which fits into one block, which is copied directly */
+	check_copy(100, 4, 4096);
+	/* Nothing at all */
+	check_copy(0, 4, 4096);
+}
+
+
+BOOST_AUTO_TEST_CASE(copy_pipeline_read_error_test)
+{
+	int reads = 0;
+	CopyPipeline pipeline(1000000, 4, 4096, [&reads](uint8_t*, size_t) {
+		if (++reads == 10) {
+			throw std::runtime_error("read failed");
+		}
+	});
+
+	BOOST_CHECK_THROW(pipeline.run([](uint8_t const*, size_t) {}), std::runtime_error);
+}
+
+
+BOOST_AUTO_TEST_CASE(copy_pipeline_consume_error_test)
+{
+	int consumed = 0;
+	CopyPipeline pipeline(1000000, 4, 4096, [](uint8_t*, size_t) {});
+
+	BOOST_CHECK_THROW(
+		pipeline.run([&consumed](uint8_t const*, size_t) {
+			if (++consumed == 10) {
+				throw std::runtime_error("write failed");
+			}
+		}),
+		std::runtime_error
+		);
+}
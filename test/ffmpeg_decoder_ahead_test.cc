@@ -0,0 +1,117 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  test/ffmpeg_decoder_ahead_test.cc
+ *  @brief Check that FFmpegDecoder gives the same results when decoding ahead as when not.
+ *  @ingroup feature
+ */
+
+
+#include "lib/audio_buffers.h"
+#include "lib/config.h"
+#include "lib/content.h"
+#include "lib/content_factory.h"
+#include "lib/film.h"
+#include "lib/player.h"
+#include "lib/player_video.h"
+#include "test.h"
+#include <boost/test/unit_test.hpp>
+
+
+using std::make_pair;
+using std::pair;
+using std::shared_ptr;
+using std::vector;
+using namespace dcpomatic;
+
+
+struct Played
+{
+	vector<pair<shared_ptr<PlayerVideo>, DCPTime>> video;
+	vector<pair<shared_ptr<AudioBuffers>, DCPTime>> audio;
+};
+
+
+/** Play a film to the end, with or without decode-ahead, optionally seeking to some time first */
+static Played
+play(shared_ptr<Film> film, bool decode_ahead, DCPTime from)
+{
+	Config::instance()->set_decode_ahead(decode_ahead);
+
+	Played played;
+	Player player(film, Image::Alignment::PADDED);
+	player.Video.connect([&played](shared_ptr<PlayerVideo> video, DCPTime time) {
+		played.video.push_back(make_pair(video, time));
+	});
+	player.Audio.connect([&played](shared_ptr<AudioBuffers> audio, DCPTime time, int) {
+		played.audio.push_back(make_pair(audio, time));
+	});
+
+	if (from != DCPTime()) {
+		/* Get some way in first, so that any decode-ahead thread is running when we seek */
+		for (int i = 0; i < 50; ++i) {
+			player.pass();
+		}
+		played = {};
+		player.seek(from, true);
+	}
+	while (!player.pass()) {}
+
+	return played;
+}
+
+
+static void
+check(Played const& ref, Played const& check)
+{
+	BOOST_REQUIRE_EQUAL(ref.video.size(), check.video.size());
+	for (auto i = 0U; i < ref.video.size(); ++i) {
+		BOOST_CHECK(ref.video[i].second == check.video[i].second);
+		BOOST_CHECK(ref.video[i].first->same(check.video[i].first));
+	}
+
+	BOOST_REQUIRE_EQUAL(ref.audio.size(), check.audio.size());
+	for (auto i = 0U; i < ref.audio.size(); ++i) {
+		BOOST_CHECK(ref.audio[i].second == check.audio[i].second);
+		auto const& a = ref.audio[i].first;
+		auto const& b = check.audio[i].first;
+		BOOST_REQUIRE_EQUAL(a->channels(), b->channels());
+		BOOST_REQUIRE_EQUAL(a->frames(), b->frames());
+		for (int c = 0; c < a->channels(); ++c) {
+			for (int f = 0; f < a->frames(); ++f) {
+				BOOST_REQUIRE_EQUAL(a->data(c)[f], b->data(c)[f]);
+			}
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(ffmpeg_decoder_ahead_test)
+{
+	ConfigRestorer cr;
+
+	auto film = new_test_film("ffmpeg_decoder_ahead_test", content_factory("test/data/count300bd24.m2ts"));
+
+	check(play(film, false, {}), play(film, true, {}));
+
+	auto const from = DCPTime::from_frames(113, 24);
+	check(play(film, false, from), play(film, true, from));
+}
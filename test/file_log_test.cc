@@ -25,8 +25,13 @@
  */
 
 
+#include "lib/dcpomatic_log.h"
 #include "lib/file_log.h"
+#include "test.h"
 #include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <chrono>
+#include <fstream>
 
 
 BOOST_AUTO_TEST_CASE (file_log_test)
@@ -35,3 +40,54 @@ BOOST_AUTO_TEST_CASE (file_log_test)
 	BOOST_CHECK_EQUAL (log.head_and_tail(1024), "This is a short log.\nWith only two lines.\n");
 	BOOST_CHECK_EQUAL (log.head_and_tail(8), "This is \n .\n .\n .\no lines.\n");
 }
+
+
+/** Log from 64 threads at once, check that everything arrives, and time it.  We log more entries
+ *  than FileLog will queue, so the threads will sometimes have to wait for the log to catch up.
+ */
+BOOST_AUTO_TEST_CASE(file_log_threads_test)
+{
+	boost::filesystem::path const path = "build/test/file_log_threads_test.log";
+	boost::system::error_code ec;
+	boost::filesystem::remove(path, ec);
+
+	auto log = std::make_shared<FileLog>(path, LogEntry::TYPE_TIMING);
+	LogSwitcher ls(log);
+
+	int const threads = 64;
+	int const entries = 2000;
+
+	auto run = [](bool enabled) {
+		boost::thread_group group;
+		auto const start = std::chrono::steady_clock::now();
+		for (int i = 0; i < threads; ++i) {
+			group.create_thread([i, enabled]() {
+				for (int j = 0; j < entries; ++j) {
+					if (enabled) {
+						LOG_TIMING("thread=%1 entry=%2", i, j);
+					} else {
+						LOG_DEBUG_PLAYER("thread=%1 entry=%2", i, j);
+					}
+				}
+			});
+		}
+		group.join_all();
+		auto const time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		return static_cast<int64_t>(threads) * entries * 1000000 / std::max(static_cast<int64_t>(time), static_cast<int64_t>(1));
+	};
+
+	auto const enabled_rate = run(true);
+	auto const disabled_rate = run(false);
+
+	log->flush();
+
+	std::ifstream file(path.string());
+	int lines = 0;
+	std::string line;
+	while (std::getline(file, line)) {
+		++lines;
+	}
+	BOOST_CHECK_EQUAL(lines, threads * entries);
+
+	BOOST_TEST_MESSAGE(threads << " threads: " << enabled_rate << " enabled log calls/s, " << disabled_rate << " disabled log calls/s");
+}
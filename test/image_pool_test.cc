@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "lib/image.h"
+#include "lib/image_pool.h"
+#include <boost/test/unit_test.hpp>
+
+
+BOOST_AUTO_TEST_CASE(image_pool_test)
+{
+	ImagePool pool;
+	pool.set_maximum_size(4096);
+
+	auto a = pool.get(1024);
+	auto b = pool.get(2048);
+	BOOST_CHECK_EQUAL(pool.statistics().misses, 2);
+
+	pool.put(a, 1024);
+	pool.put(b, 2048);
+	BOOST_CHECK_EQUAL(pool.statistics().idle, 3072U);
+
+	/* Same size as a so we should get a back */
+	BOOST_CHECK(pool.get(1024) == a);
+	BOOST_CHECK_EQUAL(pool.statistics().hits, 1);
+	BOOST_CHECK_EQUAL(pool.statistics().idle, 2048U);
+
+	/* This pushes the pool over its limit so b (the least recently used) is freed */
+	pool.put(a, 1024);
+	auto c = pool.get(3072);
+	pool.put(c, 3072);
+	BOOST_CHECK_EQUAL(pool.statistics().idle, 4096U);
+
+	auto const misses = pool.statistics().misses;
+	b = pool.get(2048);
+	BOOST_CHECK_EQUAL(pool.statistics().misses, misses + 1);
+	pool.put(b, 2048);
+}
+
+
+/** Check that Images of the same format and size re-use each other's memory */
+BOOST_AUTO_TEST_CASE(image_pool_image_test)
+{
+	ImagePool::instance()->clear();
+
+	uint8_t* data = nullptr;
+	{
+		Image image(AV_PIX_FMT_RGB24, dcp::Size(1998, 1080), Image::Alignment::PADDED);
+		data = image.data()[0];
+	}
+
+	auto const hits = ImagePool::instance()->statistics().hits;
+	Image image(AV_PIX_FMT_RGB24, dcp::Size(1998, 1080), Image::Alignment::PADDED);
+	BOOST_CHECK(image.data()[0] == data);
+	BOOST_CHECK_EQUAL(ImagePool::instance()->statistics().hits, hits + 1);
+}
@@ -432,6 +432,73 @@ BOOST_AUTO_TEST_CASE (crop_scale_window_test)
 }
 
 
+/** Check that crop_scale_window() gives a black border around the scaled image and the same
+ *  scaled image as it does without a border, even when the memory that it gets for its output
+ *  has something else in it.
+ */
+BOOST_AUTO_TEST_CASE (crop_scale_window_border_test)
+{
+	auto proxy = make_shared<FFmpegImageProxy>("test/data/simple_testcard_640x480.png");
+	auto testcard = proxy->image(Image::Alignment::PADDED).image;
+
+	dcp::Size const out_size(640, 480);
+
+	for (auto in_format: { AV_PIX_FMT_RGB24, AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV444P10LE }) {
+		auto in = testcard->convert_pixel_format(dcp::YUVToRGB::REC709, in_format, Image::Alignment::PADDED, false);
+		for (auto out_format: { AV_PIX_FMT_RGB24, AV_PIX_FMT_RGBA, AV_PIX_FMT_RGB48LE, AV_PIX_FMT_XYZ12LE, AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P10LE, AV_PIX_FMT_YUV444P10LE }) {
+			/* Letterbox, pillarbox, both, neither, and odd borders which need rounding for subsampling */
+			for (auto inter_size: { dcp::Size(640, 360), dcp::Size(480, 480), dcp::Size(600, 400), dcp::Size(640, 480), dcp::Size(481, 361) }) {
+				/* Put some rubbish into memory that crop_scale_window() may re-use */
+				for (int i = 0; i < 4; ++i) {
+					Image rubbish(out_format, out_size, Image::Alignment::PADDED);
+					for (int c = 0; c < rubbish.planes(); ++c) {
+						memset(rubbish.data()[c], 0x5a, rubbish.stride()[c] * rubbish.sample_size(c).height);
+					}
+				}
+
+				auto scale = [in, inter_size, out_format](dcp::Size size) {
+					return in->crop_scale_window(
+						Crop(), inter_size, size, dcp::YUVToRGB::REC709, VideoRange::FULL, out_format, VideoRange::FULL, Image::Alignment::PADDED, false
+						);
+				};
+
+				auto out = scale(out_size);
+				auto window = scale(inter_size);
+				Image black(out_format, out_size, Image::Alignment::PADDED);
+				black.make_black();
+
+				/* The scaled image is centred, with its corner rounded down to a whole number of subsampled pixels */
+				auto const desc = av_pix_fmt_desc_get(out_format);
+				auto const corner_x = ((out_size.width - inter_size.width) / 2) & ~((1 << desc->log2_chroma_w) - 1);
+				auto const corner_y = ((out_size.height - inter_size.height) / 2) & ~((1 << desc->log2_chroma_h) - 1);
+
+				for (int c = 0; c < out->planes(); ++c) {
+					/* Work in whole samples, as a line of a subsampled plane may end part-way through one */
+					int const sample_bytes = lrintf(out->bytes_per_pixel(c) * out->horizontal_factor(c));
+					int const line = out->sample_size(c).width * sample_bytes;
+					int const window_x = corner_x / out->horizontal_factor(c) * sample_bytes;
+					int const window_width = window->sample_size(c).width * sample_bytes;
+					int const window_top = corner_y / out->vertical_factor(c);
+					int const window_bottom = window_top + window->sample_size(c).height;
+					for (int y = 0; y < out->sample_size(c).height; ++y) {
+						auto out_line = out->data()[c] + y * out->stride()[c];
+						auto black_line = black.data()[c] + y * black.stride()[c];
+						if (y >= window_top && y < window_bottom) {
+							auto window_line = window->data()[c] + (y - window_top) * window->stride()[c];
+							BOOST_REQUIRE_EQUAL(memcmp(out_line, black_line, window_x), 0);
+							BOOST_REQUIRE_EQUAL(memcmp(out_line + window_x, window_line, window_width), 0);
+							BOOST_REQUIRE_EQUAL(memcmp(out_line + window_x + window_width, black_line + window_x + window_width, line - window_x - window_width), 0);
+						} else {
+							BOOST_REQUIRE_EQUAL(memcmp(out_line, black_line, line), 0);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+
 /** Special cases of Image::crop_scale_window which triggered some valgrind warnings */
 BOOST_AUTO_TEST_CASE (crop_scale_window_test2)
 {
@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+
+/** @file  test/interleave_test.cc
+ *  @brief Check the optimised interleave_to_uint16() against the plain version, and time them.
+ *  @ingroup selfcontained
+ */
+
+
+#include "lib/interleave.h"
+#include <dcp/types.h>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <vector>
+
+
+using std::vector;
+
+
+BOOST_AUTO_TEST_CASE(interleave_test)
+{
+	/* Odd sizes to check the handling of whatever is left over after the SIMD loops */
+	for (auto size: { dcp::Size(1, 1), dcp::Size(17, 3), dcp::Size(2048, 858), dcp::Size(4096, 2160) }) {
+		for (auto precision: { 12, 16 }) {
+			int const samples = size.width * size.height;
+			vector<int> planes[3];
+			int n = 0;
+			for (auto& plane: planes) {
+				plane.resize(samples);
+				for (auto& sample: plane) {
+					sample = (n++ * 7919) % (1 << precision);
+				}
+			}
+
+			vector<uint16_t> reference(samples * 3);
+			vector<uint16_t> check(samples * 3);
+
+			auto const start = std::chrono::steady_clock::now();
+			dcpomatic::interleave_to_uint16_scalar(planes[0].data(), planes[1].data(), planes[2].data(), reference.data(), samples, 16 - precision);
+			auto const middle = std::chrono::steady_clock::now();
+			dcpomatic::interleave_to_uint16(planes[0].data(), planes[1].data(), planes[2].data(), check.data(), samples, 16 - precision);
+			auto const end = std::chrono::steady_clock::now();
+
+			BOOST_REQUIRE(reference == check);
+
+			BOOST_TEST_MESSAGE(
+				size.width << "x" << size.height << " " << precision << "-bit: scalar " <<
+				std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count() << "us, optimised " <<
+				std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count() << "us"
+				);
+		}
+	}
+}
@@ -0,0 +1,66 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "lib/image.h"
+#include "lib/j2k_decode_cache.h"
+#include <boost/test/unit_test.hpp>
+
+
+using std::make_shared;
+
+
+BOOST_AUTO_TEST_CASE(j2k_decode_cache_test)
+{
+	J2KDecodeCache cache;
+
+	auto image = make_shared<Image>(AV_PIX_FMT_XYZ12LE, dcp::Size(1998, 1080), Image::Alignment::PADDED);
+	auto const size = image->memory_used();
+
+	/* Room for two images */
+	cache.set_maximum_size(size * 2);
+
+	auto key = [](int frame, int reduce) {
+		return J2KDecodeCache::Key("foo", frame, boost::none, reduce, Image::Alignment::PADDED);
+	};
+
+	BOOST_CHECK(!cache.get(key(0, 0)));
+	cache.put(key(0, 0), image);
+	BOOST_CHECK(cache.get(key(0, 0)) == image);
+	/* A different reduction is a different image */
+	BOOST_CHECK(!cache.get(key(0, 1)));
+
+	cache.put(key(1, 0), image);
+	/* Use frame 0 so that frame 1 is now the least recently used */
+	BOOST_CHECK(cache.get(key(0, 0)));
+	cache.put(key(2, 0), image);
+
+	BOOST_CHECK_EQUAL(cache.size(), size * 2);
+	BOOST_CHECK(cache.get(key(0, 0)));
+	BOOST_CHECK(!cache.get(key(1, 0)));
+	BOOST_CHECK(cache.get(key(2, 0)));
+
+	BOOST_CHECK_EQUAL(cache.hits(), 4);
+	BOOST_CHECK_EQUAL(cache.misses(), 3);
+
+	cache.clear();
+	BOOST_CHECK_EQUAL(cache.size(), 0U);
+	BOOST_CHECK(!cache.get(key(0, 0)));
+}
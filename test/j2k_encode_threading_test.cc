@@ -28,20 +28,34 @@
 #ifdef DCPOMATIC_GROK
 #include "lib/grok/context.h"
 #endif
+#include "lib/image.h"
 #include "lib/j2k_encoder.h"
+#include "lib/j2k_encoder_thread.h"
 #include "lib/job_manager.h"
 #include "lib/make_dcp.h"
+#include "lib/player_video.h"
+#include "lib/raw_image_proxy.h"
 #include "lib/transcode_job.h"
 #include "test.h"
 #include <dcp/cpl.h>
 #include <dcp/dcp.h>
 #include <dcp/reel.h>
 #include <dcp/reel_picture_asset.h>
+extern "C" {
+#include <libavutil/pixfmt.h>
+}
 #include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
 
 
 using std::dynamic_pointer_cast;
 using std::list;
+using std::make_shared;
+using std::shared_ptr;
+using std::vector;
+using std::weak_ptr;
+using boost::optional;
 
 
 BOOST_AUTO_TEST_CASE(local_threads_created_and_destroyed)
@@ -119,6 +133,100 @@ BOOST_AUTO_TEST_CASE(frames_not_lost_when_threads_disappear)
 }
 
 
+/** Check that encoder threads can take a full batch of frames when the queue is as full as encode() allows */
+BOOST_AUTO_TEST_CASE(j2k_encoder_batch_test)
+{
+	for (auto threads: { 1, 2, 8, 32, 64 }) {
+		auto const limit = J2KEncoder::queue_limit(threads);
+		BOOST_CHECK_EQUAL(J2KEncoder::batch_size(limit - 1, threads, J2KEncoder::frames_per_pop), J2KEncoder::frames_per_pop);
+		/* A thread should not take more than one frame if that could leave another thread with nothing */
+		BOOST_CHECK_EQUAL(J2KEncoder::batch_size(threads * 2 - 1, threads, J2KEncoder::frames_per_pop), 1);
+		BOOST_CHECK_EQUAL(J2KEncoder::batch_size(1, threads, J2KEncoder::frames_per_pop), 1);
+	}
+
+	BOOST_CHECK_EQUAL(J2KEncoder::batch_size(100, 0, J2KEncoder::frames_per_pop), J2KEncoder::frames_per_pop);
+	BOOST_CHECK_EQUAL(J2KEncoder::batch_size(100, 1, 2), 2);
+}
+
+
+/** Encoder thread which takes frames from the queue in the same way as CPUJ2KEncoderThread, and throws them away */
+class NullJ2KEncoderThread : public J2KEncoderThread
+{
+public:
+	NullJ2KEncoderThread(J2KEncoder& encoder, std::atomic<int>& popped)
+		: J2KEncoderThread(encoder)
+		, _popped(popped)
+	{}
+
+	void run() override
+	{
+		try {
+			while (true) {
+				_popped += _encoder.pop(J2KEncoder::frames_per_pop).size();
+				boost::this_thread::interruption_point();
+			}
+		} catch (boost::thread_interrupted&) {}
+	}
+
+private:
+	std::atomic<int>& _popped;
+};
+
+
+/** Measure how quickly frames can go from J2KEncoder::encode to J2KEncoder::pop when there is no
+ *  compression to do, with varying numbers of threads, and check that none are lost on the way.
+ */
+BOOST_AUTO_TEST_CASE(j2k_encoder_queue_throughput_test)
+{
+	auto film = new_test_film("j2k_encoder_queue_throughput_test", {});
+
+	/* Alternate between two different images so that J2KEncoder does not repeat frames */
+	vector<shared_ptr<PlayerVideo>> videos;
+	for (auto value: { 0, 255 }) {
+		auto image = make_shared<Image>(AV_PIX_FMT_RGB24, dcp::Size(64, 64), Image::Alignment::PADDED);
+		memset(image->data()[0], value, image->stride()[0] * 64);
+		videos.push_back(
+			make_shared<PlayerVideo>(
+				make_shared<RawImageProxy>(image),
+				Crop(),
+				optional<double>(),
+				dcp::Size(64, 64),
+				dcp::Size(64, 64),
+				Eyes::BOTH,
+				Part::WHOLE,
+				optional<ColourConversion>(),
+				VideoRange::FULL,
+				weak_ptr<Content>(),
+				optional<dcpomatic::ContentTime>(),
+				false
+				)
+			);
+	}
+
+	int const frames = 20000;
+
+	for (auto threads: { 1, 8, 32, 64 }) {
+		Writer writer(film, {}, "foo");
+		J2KEncoder encoder(film, writer);
+		std::atomic<int> popped(0);
+
+		for (int i = 0; i < threads; ++i) {
+			encoder.add_thread(make_shared<NullJ2KEncoderThread>(encoder, popped));
+		}
+
+		auto const start = std::chrono::steady_clock::now();
+		for (int i = 0; i < frames; ++i) {
+			encoder.encode(videos[i % 2], dcpomatic::DCPTime::from_frames(i, film->video_frame_rate()));
+		}
+		encoder.end();
+		auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		BOOST_CHECK_EQUAL(popped, frames);
+		BOOST_TEST_MESSAGE(threads << " threads: " << (frames / seconds) << " frames/s");
+	}
+}
+
+
 #ifdef DCPOMATIC_GROK
 BOOST_AUTO_TEST_CASE(transcode_stops_when_gpu_enabled_with_no_gpu)
 {
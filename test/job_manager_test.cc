@@ -25,9 +25,11 @@
  */
 
 
+#include "lib/config.h"
 #include "lib/cross.h"
 #include "lib/job.h"
 #include "lib/job_manager.h"
+#include "test.h"
 #include <boost/test/unit_test.hpp>
 
 
@@ -40,8 +42,9 @@ using std::vector;
 class TestJob : public Job
 {
 public:
-	explicit TestJob (shared_ptr<Film> film)
+	explicit TestJob (shared_ptr<Film> film, ResourceClass resource_class = ResourceClass::CPU)
 		: Job (film)
+		, _resource_class(resource_class)
 	{
 
 	}
@@ -66,6 +69,7 @@ public:
 				return;
 			}
 			boost::this_thread::interruption_point();
+			dcpomatic_sleep_milliseconds(1);
 		}
 	}
 
@@ -76,6 +80,13 @@ public:
 	string json_name () const override {
 		return "";
 	}
+
+	ResourceClass resource_class () const override {
+		return _resource_class;
+	}
+
+private:
+	ResourceClass _resource_class;
 };
 
 
@@ -161,3 +172,56 @@ BOOST_AUTO_TEST_CASE(cancel_job_test)
 	BOOST_CHECK(jobs[1]->finished_cancelled());
 }
 
+
+
+BOOST_AUTO_TEST_CASE(job_manager_resource_class_test)
+{
+	ConfigRestorer cr;
+
+	Config::instance()->set_maximum_cpu_jobs(1);
+	Config::instance()->set_maximum_io_jobs(2);
+
+	shared_ptr<Film> no_film;
+	auto film = new_test_film("job_manager_resource_class_test");
+
+	vector<shared_ptr<TestJob>> jobs = {
+		make_shared<TestJob>(no_film, Job::ResourceClass::CPU),
+		make_shared<TestJob>(no_film, Job::ResourceClass::CPU),
+		make_shared<TestJob>(no_film, Job::ResourceClass::IO),
+		make_shared<TestJob>(film, Job::ResourceClass::IO),
+		make_shared<TestJob>(film, Job::ResourceClass::LIGHT),
+		make_shared<TestJob>(no_film, Job::ResourceClass::IO)
+	};
+
+	for (auto job: jobs) {
+		JobManager::instance()->add(job);
+	}
+
+	dcpomatic_sleep_seconds(1);
+	/* One CPU job */
+	BOOST_CHECK(jobs[0]->running());
+	BOOST_CHECK(!jobs[1]->running());
+	/* Two I/O jobs */
+	BOOST_CHECK(jobs[2]->running());
+	BOOST_CHECK(jobs[3]->running());
+	/* This light job must wait for the earlier job for the same film */
+	BOOST_CHECK(!jobs[4]->running());
+	BOOST_CHECK(!jobs[5]->running());
+
+	jobs[3]->set_finished_ok();
+	dcpomatic_sleep_seconds(1);
+	BOOST_CHECK(jobs[4]->running());
+	BOOST_CHECK(jobs[5]->running());
+
+	/* Finish jobs as they start, until they are all done */
+	while (std::find_if(jobs.begin(), jobs.end(), [](shared_ptr<Job> job) { return !job->finished_ok(); }) != jobs.end()) {
+		for (auto job: jobs) {
+			if (job->running()) {
+				job->set_finished_ok();
+			}
+		}
+		dcpomatic_sleep_milliseconds(10);
+	}
+
+	BOOST_REQUIRE(!wait_for_jobs());
+}
@@ -21,6 +21,7 @@
 
 #include "lib/cinema.h"
 #include "lib/cinema_list.h"
+#include "lib/compose.hpp"
 #include "lib/config.h"
 #include "lib/content_factory.h"
 #include "lib/cross.h"
@@ -33,6 +34,7 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
+#include <chrono>
 #include <iostream>
 
 
@@ -360,3 +362,52 @@ BOOST_AUTO_TEST_CASE(kdm_cli_add_dkdm)
 	BOOST_CHECK_EQUAL(dkdm->dkdm().as_xml(), dcp::file_to_string("test/data/dkdm.xml"));
 }
 
+
+
+/** Make KDMs for 1000 screens, checking that they come out in the right order, and time it */
+BOOST_AUTO_TEST_CASE(kdms_for_screens_test)
+{
+	ConfigRestorer cr;
+
+	auto const cert = dcp::Certificate(dcp::file_to_string("test/data/cert.pem"));
+	Cinema cinema("Multiplex", {}, "", dcp::UTCOffset());
+
+	vector<ScreenDetails> screens;
+	for (int i = 0; i < 1000; ++i) {
+		screens.push_back({CinemaID(0), cinema, dcpomatic::Screen(String::compose("Screen %1", i), "", cert, boost::none, {})});
+	}
+
+	dcp::DecryptedKDM dkdm(dcp::EncryptedKDM(dcp::file_to_string("test/data/dkdm.xml")), Config::instance()->decryption_chain()->key().get());
+	std::function<dcp::DecryptedKDM (dcp::LocalTime, dcp::LocalTime)> make_kdm = [dkdm](dcp::LocalTime begin, dcp::LocalTime end) {
+		dcp::DecryptedKDM kdm(begin, end, "", dkdm.content_title_text(), dcp::LocalTime().as_string());
+		for (auto const& key: dkdm.keys()) {
+			kdm.add_key(key);
+		}
+		return kdm;
+	};
+
+	dcp::LocalTime from;
+	auto until = from;
+	until.add_days(14);
+
+	vector<KDMCertificatePeriod> period_checks;
+
+	auto const start = std::chrono::steady_clock::now();
+	for (auto const& details: screens) {
+		kdm_for_screen(make_kdm, details.cinema_id, details.cinema, details.screen, from, until, dcp::Formulation::MODIFIED_TRANSITIONAL_1, false, {}, period_checks);
+	}
+	auto const middle = std::chrono::steady_clock::now();
+	auto const kdms = kdms_for_screens(make_kdm, screens, from, until, dcp::Formulation::MODIFIED_TRANSITIONAL_1, false, {}, period_checks);
+	auto const end = std::chrono::steady_clock::now();
+
+	BOOST_REQUIRE_EQUAL(kdms.size(), screens.size());
+	for (size_t i = 0; i < kdms.size(); ++i) {
+		BOOST_CHECK_EQUAL(kdms[i]->get('s').get_value_or(""), screens[i].screen.name);
+	}
+
+	BOOST_TEST_MESSAGE(
+		"1000 KDMs: one at a time " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(middle - start).count() << "ms, in parallel " <<
+		std::chrono::duration_cast<std::chrono::milliseconds>(end - middle).count() << "ms"
+		);
+}
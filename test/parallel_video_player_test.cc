@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  test/parallel_video_player_test.cc
+ *  @brief Test ParallelVideoPlayer and making DCPs with it.
+ *  @ingroup feature
+ */
+
+
+#include "lib/config.h"
+#include "lib/content.h"
+#include "lib/content_factory.h"
+#include "lib/film.h"
+#include "lib/parallel_video_player.h"
+#include "lib/player.h"
+#include "lib/player_video.h"
+#include "lib/text_content.h"
+#include "test.h"
+#include <boost/test/unit_test.hpp>
+
+
+using std::make_pair;
+using std::pair;
+using std::shared_ptr;
+using std::vector;
+using namespace dcpomatic;
+
+
+/** Check that ParallelVideoPlayer gives the same frames, in the same order, as a Player */
+BOOST_AUTO_TEST_CASE(parallel_video_player_test)
+{
+	auto content = content_factory("test/data/count300bd24.m2ts")[0];
+	auto film = new_test_film("parallel_video_player_test", { content });
+
+	vector<pair<shared_ptr<PlayerVideo>, DCPTime>> reference;
+	Player player(film, Image::Alignment::PADDED);
+	player.set_ignore_audio();
+	player.Video.connect([&reference](shared_ptr<PlayerVideo> video, DCPTime time) {
+		reference.push_back(make_pair(video, time));
+	});
+	while (!player.pass()) {}
+
+	auto check = [film, &reference](int frames_per_chunk) {
+		/* Use chunks which don't divide the film exactly, and more threads than chunks at the end */
+		ParallelVideoPlayer parallel(film, 4, DCPTime::from_frames(7, 24), frames_per_chunk);
+
+		size_t index = 0;
+		while (auto video = parallel.get(true)) {
+			BOOST_REQUIRE(index < reference.size());
+			BOOST_CHECK(video->second == reference[index].second);
+			BOOST_CHECK(video->first->same(reference[index].first));
+			++index;
+		}
+
+		BOOST_CHECK_EQUAL(index, reference.size());
+		BOOST_CHECK(parallel.finished());
+	};
+
+	/* Enough space for whole chunks */
+	check(24);
+	/* Threads must wait for get() to take frames before they can finish their chunks */
+	check(2);
+}
+
+
+/** Check that making a DCP using several decode threads gives the same result as with one */
+BOOST_AUTO_TEST_CASE(parallel_video_player_dcp_test)
+{
+	ConfigRestorer cr;
+
+	auto make = [](std::string name, int threads) {
+		Config::instance()->set_dcp_decode_threads(threads);
+		auto film = new_test_film(name, content_factory("test/data/count300bd24.m2ts"));
+		make_and_verify_dcp(film);
+		return film->dir(film->dcp_name());
+	};
+
+	auto const serial = make("parallel_video_player_dcp_test_serial", 1);
+	auto const parallel = make("parallel_video_player_dcp_test_parallel", 4);
+
+	check_dcp(serial, parallel);
+}
+
+
+BOOST_AUTO_TEST_CASE(parallel_video_player_suitable_test)
+{
+	auto video = content_factory("test/data/count300bd24.m2ts")[0];
+	auto subs = content_factory("test/data/subrip.srt")[0];
+	auto film = new_test_film("parallel_video_player_suitable_test", { video, subs });
+
+	subs->text[0]->set_use(true);
+	subs->text[0]->set_burn(false);
+	BOOST_CHECK(ParallelVideoPlayer::suitable(film));
+
+	subs->text[0]->set_burn(true);
+	BOOST_CHECK(!ParallelVideoPlayer::suitable(film));
+}
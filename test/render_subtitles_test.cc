@@ -177,6 +177,46 @@ BOOST_AUTO_TEST_CASE(render_text_with_newline_test)
 }
 
 
+/** Check that RenderedTextCache only renders a line once, and gives the same result as rendering from scratch */
+BOOST_AUTO_TEST_CASE(render_text_cache_test)
+{
+	dcp::TextString dcp_string(
+		{}, false, false, false, dcp::Colour(255, 255, 255), 42, 1.0,
+		dcp::Time(0, 0, 0, 0, 24), dcp::Time(0, 0, 1, 0, 24),
+		0.5, dcp::HAlign::CENTER,
+		0.5, dcp::VAlign::CENTER,
+		0.0,
+		dcp::Direction::LTR,
+		"Hello world",
+		dcp::Effect::NONE, dcp::Colour(0, 0, 0),
+		{}, {},
+		0,
+		std::vector<dcp::Ruby>()
+		);
+
+	std::vector<StringText> st = {{ dcp_string, 0, make_shared<dcpomatic::Font>("foo"), dcp::SubtitleStandard::SMPTE_2014 }};
+
+	RenderedTextCache cache;
+
+	for (int frame = 0; frame < 24; ++frame) {
+		auto const time = dcpomatic::DCPTime::from_frames(frame, 24);
+		auto cached = render_text(st, dcp::Size(1998, 1080), time, 24, &cache);
+		auto uncached = render_text(st, dcp::Size(1998, 1080), time, 24);
+		BOOST_REQUIRE_EQUAL(cached.size(), 1U);
+		BOOST_REQUIRE_EQUAL(uncached.size(), 1U);
+		BOOST_CHECK(cached[0].position == uncached[0].position);
+		BOOST_CHECK(*cached[0].image == *uncached[0].image);
+	}
+
+	BOOST_CHECK_EQUAL(cache.misses(), 1);
+	BOOST_CHECK_EQUAL(cache.hits(), 23);
+
+	/* A different target size needs a new rendering */
+	render_text(st, dcp::Size(3996, 2160), {}, 24, &cache);
+	BOOST_CHECK_EQUAL(cache.misses(), 2);
+}
+
+
 #if 0
 
 BOOST_AUTO_TEST_CASE (render_text_test)
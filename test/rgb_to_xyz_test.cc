@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  test/rgb_to_xyz_test.cc
+ *  @brief Check dcpomatic::rgb_to_xyz() against dcp::rgb_to_xyz(), and time them.
+ *  @ingroup selfcontained
+ */
+
+
+#include "lib/colour_conversion.h"
+#include "lib/image.h"
+#include "lib/rgb_to_xyz.h"
+#include <dcp/openjpeg_image.h>
+#include <dcp/rgb_xyz.h>
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+
+
+using std::make_shared;
+
+
+BOOST_AUTO_TEST_CASE(rgb_to_xyz_test)
+{
+	dcp::Size const size(4096, 2160);
+	auto rgb = make_shared<Image>(AV_PIX_FMT_RGB48LE, size, Image::Alignment::PADDED);
+
+	/* Every 16-bit value in each component, along with some out-of-gamut colours */
+	uint32_t n = 0;
+	for (int y = 0; y < size.height; ++y) {
+		auto p = reinterpret_cast<uint16_t*>(rgb->data()[0] + y * rgb->stride()[0]);
+		for (int x = 0; x < size.width * 3; ++x) {
+			*p++ = (n++ * 40503) & 0xffff;
+		}
+	}
+
+	for (auto const& preset: PresetColourConversion::all()) {
+		auto const start = std::chrono::steady_clock::now();
+		auto reference = dcp::rgb_to_xyz(rgb->data()[0], size, rgb->stride()[0], preset.conversion);
+		auto const middle = std::chrono::steady_clock::now();
+		auto check = dcpomatic::rgb_to_xyz(*rgb, preset.conversion);
+		auto const end = std::chrono::steady_clock::now();
+
+		for (int c = 0; c < 3; ++c) {
+			BOOST_REQUIRE(std::equal(reference->data(c), reference->data(c) + size.width * size.height, check->data(c)));
+		}
+
+		BOOST_TEST_MESSAGE(
+			preset.id << ": libdcp " <<
+			std::chrono::duration_cast<std::chrono::milliseconds>(middle - start).count() << "ms, ours " <<
+			std::chrono::duration_cast<std::chrono::milliseconds>(end - middle).count() << "ms"
+			);
+	}
+}
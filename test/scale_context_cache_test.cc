@@ -0,0 +1,80 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "lib/image.h"
+#include "lib/scale_context_cache.h"
+#include <boost/test/unit_test.hpp>
+
+
+using std::make_shared;
+
+
+BOOST_AUTO_TEST_CASE(scale_context_cache_test)
+{
+	ScaleContextCache cache;
+
+	auto key = [](int out_range) {
+		return ScaleContextCache::Key(
+			dcp::Size(1998, 1080), AV_PIX_FMT_YUV420P, dcp::Size(1998, 1080), AV_PIX_FMT_RGB24, 0, dcp::YUVToRGB::REC709, 0, out_range
+			);
+	};
+
+	{
+		auto a = cache.get(key(0));
+		/* a is still in use, so we must get a different context */
+		auto b = cache.get(key(0));
+		BOOST_CHECK(a->get() != b->get());
+		BOOST_CHECK_EQUAL(cache.misses(), 2);
+	}
+
+	{
+		auto a = cache.get(key(0));
+		BOOST_CHECK_EQUAL(cache.hits(), 1);
+		/* A different range needs a different context */
+		auto b = cache.get(key(1));
+		BOOST_CHECK_EQUAL(cache.misses(), 3);
+	}
+}
+
+
+/** Check that the cache is used by crop_scale_window and doesn't change its results */
+BOOST_AUTO_TEST_CASE(scale_context_cache_crop_scale_window_test)
+{
+	auto image = make_shared<Image>(AV_PIX_FMT_YUV420P, dcp::Size(1920, 1080), Image::Alignment::PADDED);
+	image->make_black();
+
+	auto scale = [image]() {
+		return image->crop_scale_window(
+			Crop(0, 0, 20, 20), dcp::Size(1998, 1040), dcp::Size(1998, 1080), dcp::YUVToRGB::REC709, VideoRange::VIDEO, AV_PIX_FMT_RGB48LE, VideoRange::FULL, Image::Alignment::COMPACT, false
+			);
+	};
+
+	auto cache = ScaleContextCache::instance();
+	cache->clear();
+
+	auto const hits = cache->hits();
+	auto first = scale();
+	auto second = scale();
+	BOOST_CHECK_EQUAL(cache->hits(), hits + 1);
+
+	for (int y = 0; y < first->size().height; ++y) {
+		BOOST_REQUIRE_EQUAL(memcmp(first->data()[0] + y * first->stride()[0], second->data()[0] + y * second->stride()[0], first->line_size()[0]), 0);
+	}
+}
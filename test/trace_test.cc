@@ -0,0 +1,98 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of DCP-o-matic.
+
+    DCP-o-matic is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    DCP-o-matic is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DCP-o-matic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/** @file  test/trace_test.cc
+ *  @brief Test Trace.
+ *  @ingroup selfcontained
+ */
+
+
+#include "lib/trace.h"
+#include "lib/util.h"
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+
+BOOST_AUTO_TEST_CASE(trace_test)
+{
+	auto trace = Trace::instance();
+
+	/* Nothing should be recorded when the trace is stopped */
+	trace->stop();
+	trace->start();
+	trace->stop();
+	{
+		TraceSpan span("ignored");
+		trace->counter("ignored", 1);
+	}
+	BOOST_CHECK_EQUAL(trace->events(), 0U);
+
+	trace->start();
+
+	int const threads = 4;
+	int const frames = 100;
+
+	boost::thread_group group;
+	for (int i = 0; i < threads; ++i) {
+		group.create_thread([]() {
+			start_of_thread("trace_test");
+			for (int j = 0; j < frames; ++j) {
+				TraceSpan span("encode", j);
+				Trace::instance()->counter("queue", j);
+			}
+		});
+	}
+	group.join_all();
+
+	trace->stop();
+	BOOST_CHECK_EQUAL(trace->events(), static_cast<size_t>(threads * frames * 2));
+
+	boost::filesystem::path const path = "build/test/trace_test.json";
+	trace->write(path);
+
+	boost::property_tree::ptree json;
+	boost::property_tree::read_json(path.string(), json);
+
+	int spans = 0;
+	int counters = 0;
+	int names = 0;
+	for (auto const& event: json.get_child("traceEvents")) {
+		auto const phase = event.second.get<std::string>("ph");
+		if (phase == "X") {
+			BOOST_CHECK_EQUAL(event.second.get<std::string>("name"), "encode");
+			BOOST_CHECK(event.second.get<int64_t>("dur") >= 0);
+			BOOST_CHECK(event.second.get<int>("args.frame") < frames);
+			++spans;
+		} else if (phase == "C") {
+			BOOST_CHECK_EQUAL(event.second.get<std::string>("name"), "queue");
+			++counters;
+		} else if (phase == "M" && event.second.get<std::string>("args.name") == "trace_test") {
+			++names;
+		}
+	}
+
+	BOOST_CHECK_EQUAL(spans, threads * frames);
+	BOOST_CHECK_EQUAL(counters, threads * frames);
+	/* Thread IDs may be re-used, so there could be fewer names than threads */
+	BOOST_CHECK(names >= 1);
+}